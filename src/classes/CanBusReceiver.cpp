@@ -0,0 +1,126 @@
+#include "CanBusReceiver.h"
+
+#if defined(ESP32)
+#include <driver/twai.h>
+#endif
+
+CanBusReceiver::CanBusReceiver(const CanSignalDefinition* table, int count)
+	: decoder(table, count),
+	  running(false),
+	  receivedFrames(0),
+	  busRecoveries(0) {
+}
+
+bool CanBusReceiver::begin(int txPin, int rxPin, uint32_t bitrate) {
+#if defined(ESP32)
+    twai_general_config_t generalConfig = TWAI_GENERAL_CONFIG_DEFAULT((gpio_num_t)txPin, (gpio_num_t)rxPin, TWAI_MODE_LISTEN_ONLY);
+    generalConfig.rx_queue_len = 32;
+
+    twai_timing_config_t timingConfig;
+    switch (bitrate) {
+        case 125000: { twai_timing_config_t t = TWAI_TIMING_CONFIG_125KBITS(); timingConfig = t; break; }
+        case 250000: { twai_timing_config_t t = TWAI_TIMING_CONFIG_250KBITS(); timingConfig = t; break; }
+        case 500000: { twai_timing_config_t t = TWAI_TIMING_CONFIG_500KBITS(); timingConfig = t; break; }
+        case 1000000: { twai_timing_config_t t = TWAI_TIMING_CONFIG_1MBITS(); timingConfig = t; break; }
+        default:
+            Serial.println("CanBusReceiver: Unsupported bitrate " + String(bitrate));
+            return false;
+    }
+
+    twai_filter_config_t filterConfig = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    uint32_t code;
+    uint32_t mask;
+    if (decoder.computeAcceptanceFilter(code, mask)) {
+        filterConfig.acceptance_code = code;
+        filterConfig.acceptance_mask = mask;
+        filterConfig.single_filter = true;
+    } else {
+        Serial.println("CanBusReceiver: Mixed standard/extended IDs - hardware filter disabled");
+    }
+
+    if (twai_driver_install(&generalConfig, &timingConfig, &filterConfig) != ESP_OK) {
+        Serial.println("CanBusReceiver: TWAI driver install failed");
+        return false;
+    }
+    if (twai_start() != ESP_OK) {
+        Serial.println("CanBusReceiver: TWAI start failed");
+        twai_driver_uninstall();
+        return false;
+    }
+
+    running = true;
+    xTaskCreatePinnedToCore(receiveTask, "can_rx", RECEIVE_TASK_STACK, this,
+                            RECEIVE_TASK_PRIORITY, NULL, RECEIVE_TASK_CORE);
+
+    Serial.println("CanBusReceiver: Listening on TX GPIO " + String(txPin) + ", RX GPIO " + String(rxPin) +
+                   " at " + String(bitrate / 1000) + " kbit/s");
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CanBusReceiver::receiveTask(void* parameter) {
+    static_cast<CanBusReceiver*>(parameter)->receiveLoop();
+}
+
+void CanBusReceiver::receiveLoop() {
+#if defined(ESP32)
+    for (;;) {
+        twai_message_t message;
+        esp_err_t result = twai_receive(&message, pdMS_TO_TICKS(RECEIVE_TIMEOUT_MS));
+
+        if (result == ESP_OK) {
+            if (message.rtr) {
+                continue;  // Remote requests carry no data
+            }
+            receivedFrames.fetch_add(1, std::memory_order_relaxed);
+
+            CanFrame frame;
+            frame.id = message.identifier;
+            frame.extendedId = message.extd;
+            frame.length = message.data_length_code > 8 ? 8 : message.data_length_code;
+            memcpy(frame.data, message.data, frame.length);
+            decoder.decode(frame, millis());
+        } else if (result != ESP_ERR_TIMEOUT) {
+            // Bus-off or stopped controller: recover and resume listening
+            twai_status_info_t status;
+            if (twai_get_status_info(&status) == ESP_OK) {
+                if (status.state == TWAI_STATE_BUS_OFF) {
+                    twai_initiate_recovery();
+                    busRecoveries.fetch_add(1, std::memory_order_relaxed);
+                } else if (status.state == TWAI_STATE_STOPPED) {
+                    twai_start();
+                }
+            }
+            vTaskDelay(pdMS_TO_TICKS(RECEIVE_TIMEOUT_MS));
+        }
+    }
+#endif
+}
+
+bool CanBusReceiver::getValue(CanSignalId signal, float& value) const {
+    return decoder.getValue(signal, millis(), SIGNAL_TIMEOUT_MS, value);
+}
+
+bool CanBusReceiver::isReceiving() const {
+    float value;
+    for (int signal = 0; signal < CAN_SIGNAL_COUNT; signal++) {
+        if (getValue((CanSignalId)signal, value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CanBusReceiver::printStatus() {
+    float engineRPM = 0.0f;
+    bool fresh = getEngineRPM(engineRPM);
+
+    Serial.println("=== CanBusReceiver Status ===");
+    Serial.println("Running: " + String(running ? "Yes" : "No"));
+    Serial.println("Engine RPM: " + (fresh ? String(engineRPM, 0) : String("stale")));
+    Serial.println("Frames received: " + String(getReceivedFrameCount()) +
+                   " (decoded " + String(getDecodedFrameCount()) + ")");
+    Serial.println("Bus-off recoveries: " + String(busRecoveries.load(std::memory_order_relaxed)));
+}
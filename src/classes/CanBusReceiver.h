@@ -0,0 +1,51 @@
+#ifndef CAN_BUS_RECEIVER_H
+#define CAN_BUS_RECEIVER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "CanSignalDecoder.h"
+
+// Engine data from the car's CAN bus via the ESP32 TWAI controller.
+//
+// The controller runs listen-only (the speedometer never transmits or ACKs),
+// with a hardware acceptance filter built from the decode table so unrelated
+// traffic never reaches the CPU. A dedicated FreeRTOS task blocks on the
+// receive queue and decodes frames into lock-free latest-value slots, which the
+// main loop reads without waiting on the bus.
+class CanBusReceiver {
+private:
+    CanSignalDecoder decoder;
+    bool running;
+    std::atomic<uint32_t> receivedFrames;   // Frames that passed the acceptance filter
+    std::atomic<uint32_t> busRecoveries;
+
+    // Receive task configuration
+    static const uint32_t RECEIVE_TASK_STACK = 3072;
+    static const int RECEIVE_TASK_PRIORITY = 5;
+    static const int RECEIVE_TASK_CORE = 0;          // Keep bus traffic off the loop() core
+    static const uint32_t RECEIVE_TIMEOUT_MS = 100;  // Wake periodically to check bus state
+    static const uint32_t SIGNAL_TIMEOUT_MS = 500;   // Older values are considered stale
+
+    static void receiveTask(void* parameter);
+    void receiveLoop();
+
+public:
+    CanBusReceiver(const CanSignalDefinition* table, int count);
+
+    // Install and start the TWAI driver; false if the driver could not be started
+    bool begin(int txPin = CAN_TX_PIN, int rxPin = CAN_RX_PIN, uint32_t bitrate = CAN_BITRATE);
+
+    // Latest value of a signal, if one arrived within SIGNAL_TIMEOUT_MS
+    bool getValue(CanSignalId signal, float& value) const;
+    bool getEngineRPM(float& rpm) const { return getValue(CAN_SIGNAL_ENGINE_RPM, rpm); }
+
+    bool isRunning() const { return running; }
+    bool isReceiving() const;  // Any decoded signal is fresh
+    uint32_t getReceivedFrameCount() const { return receivedFrames.load(std::memory_order_relaxed); }
+    uint32_t getDecodedFrameCount() const { return decoder.getDecodedFrameCount(); }
+
+    void printStatus();
+};
+
+#endif // CAN_BUS_RECEIVER_H
@@ -0,0 +1,181 @@
+#include "CanSignalDecoder.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+void LatestValue::store(float value, uint32_t nowMillis) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    valueBits.store(bits, std::memory_order_relaxed);
+    timestampMillis.store(nowMillis, std::memory_order_relaxed);
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool LatestValue::load(float& value, uint32_t& updatedMillis) const {
+    uint32_t before;
+    uint32_t bits;
+    uint32_t timestamp;
+    do {
+        before = sequence.load(std::memory_order_acquire);
+        bits = valueBits.load(std::memory_order_relaxed);
+        timestamp = timestampMillis.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((before & 1) || sequence.load(std::memory_order_relaxed) != before);
+
+    if (before == 0) {
+        return false;
+    }
+    memcpy(&value, &bits, sizeof(value));
+    updatedMillis = timestamp;
+    return true;
+}
+
+CanSignalDecoder::CanSignalDecoder(const CanSignalDefinition* table, int count)
+	: definitions(table),
+	  definitionCount(count),
+	  decodedFrames(0) {
+}
+
+bool CanSignalDecoder::extractRaw(const CanSignalDefinition& definition, const CanFrame& frame, float& raw) {
+    if (definition.length < 1 || definition.length > 4 ||
+        definition.byteOffset + definition.length > frame.length) {
+        return false;
+    }
+
+    uint32_t value = 0;
+    for (int i = 0; i < definition.length; i++) {
+        int index = definition.bigEndian ? definition.byteOffset + i
+                                         : definition.byteOffset + definition.length - 1 - i;
+        value = (value << 8) | frame.data[index];
+    }
+
+    if (definition.isSigned) {
+        int shift = 32 - definition.length * 8;
+        raw = (float)((int32_t)(value << shift) >> shift);  // Sign-extend from the top raw byte
+    } else {
+        raw = (float)value;
+    }
+    return true;
+}
+
+bool CanSignalDecoder::decode(const CanFrame& frame, uint32_t nowMillis) {
+    bool matched = false;
+    for (int i = 0; i < definitionCount; i++) {
+        const CanSignalDefinition& definition = definitions[i];
+        if (definition.canId != frame.id || definition.extendedId != frame.extendedId) {
+            continue;
+        }
+
+        float raw;
+        if (extractRaw(definition, frame, raw)) {
+            values[definition.signal].store(raw * definition.scale + definition.offset, nowMillis);
+            matched = true;
+        }
+    }
+
+    if (matched) {
+        decodedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    return matched;
+}
+
+bool CanSignalDecoder::getValue(CanSignalId signal, uint32_t nowMillis, uint32_t maxAgeMillis, float& value) const {
+    if (signal < 0 || signal >= CAN_SIGNAL_COUNT) {
+        return false;
+    }
+
+    float latest;
+    uint32_t updatedMillis;
+    if (!values[signal].load(latest, updatedMillis)) {
+        return false;
+    }
+
+    // The caller read its clock before the copy, so a frame stored in between
+    // is "newer than now": that is age zero, not a wrapped ~49 day age
+    int32_t ageMillis = (int32_t)(nowMillis - updatedMillis);
+    if (ageMillis < 0) {
+        ageMillis = 0;
+    }
+    if ((uint32_t)ageMillis > maxAgeMillis) {
+        return false;
+    }
+    value = latest;
+    return true;
+}
+
+bool CanSignalDecoder::computeAcceptanceFilter(uint32_t& code, uint32_t& mask) const {
+    // Accept-all unless every entry agrees on the identifier format
+    code = 0;
+    mask = 0xFFFFFFFF;
+    if (definitionCount == 0) {
+        return false;
+    }
+
+    bool extended = definitions[0].extendedId;
+    uint32_t idBits = extended ? 0x1FFFFFFF : 0x7FF;
+    uint32_t commonOnes = idBits;   // Bits set in every ID
+    uint32_t commonZeros = idBits;  // Bits clear in every ID
+    for (int i = 0; i < definitionCount; i++) {
+        if (definitions[i].extendedId != extended) {
+            return false;
+        }
+        commonOnes &= definitions[i].canId;
+        commonZeros &= ~definitions[i].canId;
+    }
+    uint32_t dontCare = idBits & ~(commonOnes | commonZeros);
+
+    // Single-filter layout: standard ID in bits 31..21 (RTR and data bytes below
+    // are don't-care), extended ID in bits 31..3. A set mask bit means don't care.
+    if (extended) {
+        code = commonOnes << 3;
+        mask = (dontCare << 3) | 0x7;
+    } else {
+        code = commonOnes << 21;
+        mask = (dontCare << 21) | 0x1FFFFF;
+    }
+    return true;
+}
+
+bool CanSignalDecoder::parseCandumpLine(const char* line, CanFrame& frame, uint32_t& timestampMillis) {
+    // "(seconds.micros) interface ID#DATA"
+    const char* cursor = strchr(line, '(');
+    if (cursor == NULL) {
+        return false;
+    }
+    char* end;
+    double seconds = strtod(cursor + 1, &end);
+    if (end == cursor + 1 || *end != ')') {
+        return false;
+    }
+    timestampMillis = (uint32_t)(uint64_t)(seconds * 1000.0);
+
+    const char* separator = strchr(end, '#');
+    if (separator == NULL) {
+        return false;
+    }
+    const char* idStart = separator;
+    while (idStart > end + 1 && idStart[-1] != ' ') {
+        idStart--;
+    }
+    frame.id = (uint32_t)strtoul(idStart, NULL, 16);
+    frame.extendedId = (separator - idStart) > 3;  // candump prints extended IDs as 8 hex digits
+
+    frame.length = 0;
+    const char* data = separator + 1;
+    while (frame.length < 8) {
+        char hex[3] = { data[0], data[0] ? data[1] : '\0', '\0' };
+        if (!isxdigit((unsigned char)hex[0]) || !isxdigit((unsigned char)hex[1])) {
+            break;
+        }
+        frame.data[frame.length++] = (uint8_t)strtoul(hex, NULL, 16);
+        data += 2;
+        if (*data == '.') {
+            data++;  // Optional byte separator
+        }
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef CAN_SIGNAL_DECODER_H
+#define CAN_SIGNAL_DECODER_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Signals the speedometer can consume from the CAN bus
+enum CanSignalId {
+    CAN_SIGNAL_ENGINE_RPM = 0,
+    CAN_SIGNAL_COUNT
+};
+
+// One row of the decode table: where a signal lives in which frame and how to scale it
+struct CanSignalDefinition {
+    uint32_t canId;
+    bool extendedId;     // 29-bit identifier
+    uint8_t byteOffset;  // First byte of the raw value
+    uint8_t length;      // Raw value size in bytes (1-4)
+    bool bigEndian;      // Motorola byte order
+    bool isSigned;
+    float scale;         // physical = raw * scale + offset
+    float offset;
+    CanSignalId signal;
+};
+
+// A raw CAN frame, independent of the TWAI driver types
+struct CanFrame {
+    uint32_t id;
+    bool extendedId;
+    uint8_t length;
+    uint8_t data[8];
+};
+
+// Latest value of one signal. Single writer (the receive task), any number of
+// readers; a sequence counter lets readers detect and retry a torn read, so
+// neither side ever blocks.
+class LatestValue {
+private:
+    std::atomic<uint32_t> sequence;   // Odd while a write is in progress
+    std::atomic<uint32_t> valueBits;
+    std::atomic<uint32_t> timestampMillis;
+
+public:
+    LatestValue() : sequence(0), valueBits(0), timestampMillis(0) {}
+
+    void store(float value, uint32_t nowMillis);
+    bool load(float& value, uint32_t& updatedMillis) const;  // False if never written
+};
+
+// Table-driven frame decoder. Pure logic with no Arduino dependencies, so
+// decoding and throughput can be exercised on the host from candump logs.
+class CanSignalDecoder {
+private:
+    const CanSignalDefinition* definitions;
+    int definitionCount;
+    LatestValue values[CAN_SIGNAL_COUNT];
+    std::atomic<uint32_t> decodedFrames;  // Written by the receive task, read anywhere
+
+    static bool extractRaw(const CanSignalDefinition& definition, const CanFrame& frame, float& raw);
+
+public:
+    CanSignalDecoder(const CanSignalDefinition* table, int count);
+
+    // Decode every signal carried by this frame; returns true if any matched
+    bool decode(const CanFrame& frame, uint32_t nowMillis);
+
+    // Latest value of a signal if it was updated within maxAgeMillis
+    bool getValue(CanSignalId signal, uint32_t nowMillis, uint32_t maxAgeMillis, float& value) const;
+
+    // Smallest single acceptance filter (code/mask in TWAI single-filter layout)
+    // that passes every frame in the table. Returns false if the table mixes
+    // standard and extended IDs, in which case everything must be accepted.
+    bool computeAcceptanceFilter(uint32_t& code, uint32_t& mask) const;
+
+    uint32_t getDecodedFrameCount() const { return decodedFrames.load(std::memory_order_relaxed); }
+
+    // Parse one line of candump log format: "(1436509052.249713) can0 5E8#00000000000005DC"
+    static bool parseCandumpLine(const char* line, CanFrame& frame, uint32_t& timestampMillis);
+};
+
+#endif // CAN_SIGNAL_DECODER_H
@@ -0,0 +1,78 @@
+#include "CandumpReplay.h"
+#include <string.h>
+
+CandumpReplay::CandumpReplay(CanSignalDecoder& target)
+	: decoder(target),
+	  lastTimestampMillis(0) {
+    reset();
+}
+
+void CandumpReplay::reset() {
+    memset(&stats, 0, sizeof(stats));
+    lastTimestampMillis = 0;
+}
+
+void CandumpReplay::replayLine(const char* line, size_t length) {
+    stats.lines++;
+    while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ')) {
+        length--;
+    }
+    if (length == 0) {
+        return;
+    }
+
+    // parseCandumpLine() reads a C string: copy the line out of the log
+    char text[MAX_LINE];
+    if (length >= MAX_LINE) {
+        stats.malformed++;
+        return;
+    }
+    memcpy(text, line, length);
+    text[length] = '\0';
+
+    CanFrame frame;
+    uint32_t timestampMillis;
+    if (!CanSignalDecoder::parseCandumpLine(text, frame, timestampMillis)) {
+        stats.malformed++;
+        return;
+    }
+    stats.frames++;
+    lastTimestampMillis = timestampMillis;
+    if (decoder.decode(frame, timestampMillis)) {
+        stats.decoded++;
+    }
+}
+
+void CandumpReplay::replay(const char* log, size_t length) {
+    const char* end = log + length;
+    while (log < end) {
+        const char* newline = (const char*)memchr(log, '\n', end - log);
+        const char* lineEnd = newline != NULL ? newline : end;
+        replayLine(log, lineEnd - log);
+        log = lineEnd + 1;
+    }
+}
+
+bool CandumpReplay::replayFile(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[MAX_LINE + 2];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        size_t length = strlen(line);
+        if (length > 0 && line[length - 1] == '\n') {
+            length--;
+        } else if (!feof(file)) {
+            // Longer than any frame: count it once and skip the rest of it
+            int c;
+            while ((c = fgetc(file)) != EOF && c != '\n') {
+            }
+            length = MAX_LINE;
+        }
+        replayLine(line, length);
+    }
+    fclose(file);
+    return true;
+}
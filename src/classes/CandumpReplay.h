@@ -0,0 +1,44 @@
+#ifndef CANDUMP_REPLAY_H
+#define CANDUMP_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "CanSignalDecoder.h"
+
+struct CandumpReplayStats {
+    uint32_t lines;
+    uint32_t frames;      // Lines that parsed as a frame
+    uint32_t decoded;     // Frames that carried a signal in the decoder's table
+    uint32_t malformed;   // Non-empty lines that did not parse
+};
+
+// Replays a candump log through a CanSignalDecoder: the host stand-in for the
+// TWAI receive task, so decoding and throughput can be checked against
+// recorded traffic. Every frame is stamped with its log time. No Arduino
+// dependencies.
+class CandumpReplay {
+private:
+    static const size_t MAX_LINE = 128;   // Longest candump line: timestamp, interface, 8-digit ID, 8 bytes
+
+    CanSignalDecoder& decoder;
+    CandumpReplayStats stats;
+    uint32_t lastTimestampMillis;
+
+    void replayLine(const char* line, size_t length);
+
+public:
+    explicit CandumpReplay(CanSignalDecoder& target);
+
+    // A whole log held in memory, lines separated by '\n' (or "\r\n")
+    void replay(const char* log, size_t length);
+
+    // A log file, read a line at a time; false if it can't be opened
+    bool replayFile(const char* path);
+
+    void reset();
+    const CandumpReplayStats& getStats() const { return stats; }
+    uint32_t getLastTimestampMillis() const { return lastTimestampMillis; }
+};
+
+#endif // CANDUMP_REPLAY_H
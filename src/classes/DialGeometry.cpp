@@ -0,0 +1,112 @@
+#include "DialGeometry.h"
+#include <math.h>
+
+const float DialGeometry::KNOT_SPACING_MPH = (float)SPEED_RANGE / (DIAL_CALIBRATION_POINTS - 1);
+const float DialGeometry::KNOTS_PER_MPH = (float)(DIAL_CALIBRATION_POINTS - 1) / SPEED_RANGE;
+
+DialGeometry::DialGeometry(int microstepsPerStep)
+	: stepsPerRevolution(STEPS_PER_REVOLUTION * microstepsPerStep),
+	  microsteps(microstepsPerStep),
+	  zeroOffsetSteps(ZERO_MPH_OFFSET * microstepsPerStep),
+	  stepsPerMph((float)(STEPS_PER_REVOLUTION * microstepsPerStep) / SPEED_RANGE) {
+    // Linear at full drive-step resolution until a measured table is set
+    for (int i = 0; i < CALIBRATION_POINTS; i++) {
+        long steps = lroundf(i * KNOT_SPACING_MPH * stepsPerMph);
+        knotSteps[i] = steps > stepsPerRevolution - 1 ? stepsPerRevolution - 1 : steps;
+    }
+    updateSegments();
+}
+
+void DialGeometry::updateSegments() {
+    for (int i = 0; i < CALIBRATION_POINTS - 1; i++) {
+        float span = (float)(knotSteps[i + 1] - knotSteps[i]);
+        segmentStepsPerMph[i] = span / KNOT_SPACING_MPH;
+        segmentMphPerStep[i] = KNOT_SPACING_MPH / span;
+    }
+}
+
+bool DialGeometry::isValidCalibration(const uint16_t fullStepsAtKnot[CALIBRATION_POINTS]) {
+    if (fullStepsAtKnot[0] != 0 || fullStepsAtKnot[CALIBRATION_POINTS - 1] >= STEPS_PER_REVOLUTION) {
+        return false;
+    }
+    for (int i = 1; i < CALIBRATION_POINTS; i++) {
+        if (fullStepsAtKnot[i] <= fullStepsAtKnot[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DialGeometry::linearCalibration(uint16_t fullStepsAtKnot[CALIBRATION_POINTS]) {
+    const float fullStepsPerMph = (float)STEPS_PER_REVOLUTION / SPEED_RANGE;
+    for (int i = 0; i < CALIBRATION_POINTS; i++) {
+        long steps = lroundf(i * KNOT_SPACING_MPH * fullStepsPerMph);
+        fullStepsAtKnot[i] = (uint16_t)(steps > STEPS_PER_REVOLUTION - 1 ? STEPS_PER_REVOLUTION - 1 : steps);
+    }
+}
+
+bool DialGeometry::setCalibration(const uint16_t fullStepsAtKnot[CALIBRATION_POINTS]) {
+    if (!isValidCalibration(fullStepsAtKnot)) {
+        return false;
+    }
+    for (int i = 0; i < CALIBRATION_POINTS; i++) {
+        knotSteps[i] = (int32_t)fullStepsAtKnot[i] * microsteps;
+    }
+    updateSegments();
+    return true;
+}
+
+int DialGeometry::wrap(int position) const {
+    int wrapped = position % stepsPerRevolution;
+    return wrapped < 0 ? wrapped + stepsPerRevolution : wrapped;
+}
+
+int DialGeometry::shortestPath(int from, int to) const {
+    int diff = wrap(to - from);
+    if (diff > stepsPerRevolution / 2) {
+        diff -= stepsPerRevolution;
+    }
+    return diff;
+}
+
+int DialGeometry::stepsFromHome(float mph) const {
+    if (mph < MIN_SPEED_MPH) {
+        mph = MIN_SPEED_MPH;
+    } else if (mph > MAX_SPEED_MPH) {
+        mph = MAX_SPEED_MPH;
+    }
+
+    // Knots are evenly spaced, so the segment is a multiply away
+    float fromZero = mph - MIN_SPEED_MPH;
+    int segment = (int)(fromZero * KNOTS_PER_MPH);
+    if (segment > CALIBRATION_POINTS - 2) {
+        segment = CALIBRATION_POINTS - 2;
+    }
+    float intoSegment = fromZero - segment * KNOT_SPACING_MPH;
+    int stepsFromZero = knotSteps[segment] + (int)lroundf(intoSegment * segmentStepsPerMph[segment]);
+    if (stepsFromZero > stepsPerRevolution - 1) {
+        stepsFromZero = stepsPerRevolution - 1;
+    }
+    return zeroOffsetSteps + stepsFromZero;
+}
+
+float DialGeometry::mphAtPosition(int position, int homeCenter) const {
+    // Steps past the 0 MPH mark, wrapped into one revolution
+    int stepsFromZero = wrap(position - homeCenter - zeroOffsetSteps);
+    if (stepsFromZero >= knotSteps[CALIBRATION_POINTS - 1]) {
+        return MAX_SPEED_MPH;  // Top of the scale, or the unused arc before 0 MPH
+    }
+
+    // Last knot at or below the position
+    int low = 0;
+    int high = CALIBRATION_POINTS - 1;
+    while (high - low > 1) {
+        int middle = (low + high) / 2;
+        if (knotSteps[middle] <= stepsFromZero) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return MIN_SPEED_MPH + low * KNOT_SPACING_MPH + (stepsFromZero - knotSteps[low]) * segmentMphPerStep[low];
+}
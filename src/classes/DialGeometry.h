@@ -0,0 +1,67 @@
+#ifndef DIAL_GEOMETRY_H
+#define DIAL_GEOMETRY_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Step <-> MPH math for the speedometer wheel, in drive steps (full, half or
+// micro-steps). Positions are measured from the home marker centre; the 0-90
+// MPH scale spans one revolution, starting ZERO_MPH_OFFSET full steps past home.
+// No Arduino dependencies, so every drive mode's wrap math can be checked on the host.
+//
+// Printed dial faces aren't linear, so the scale is a piecewise-linear table:
+// the step position of every DIAL_CALIBRATION_POINTS knot, evenly spaced in
+// MPH. Slopes and their inverses are precomputed, so MPH -> steps is one
+// multiply to find the segment and steps -> MPH a binary search over the knots,
+// neither with a division.
+class DialGeometry {
+public:
+    static const int ZERO_MPH_OFFSET = 256;  // Full steps from home to the 0 MPH position (1/8 revolution)
+    static const int CALIBRATION_POINTS = DIAL_CALIBRATION_POINTS;
+    static const float KNOT_SPACING_MPH;
+
+private:
+    int stepsPerRevolution;
+    int microsteps;
+    int zeroOffsetSteps;
+    float stepsPerMph;      // Average over the scale, for converting MPH rates
+    int32_t knotSteps[CALIBRATION_POINTS];              // Drive steps past 0 MPH at each knot
+    float segmentStepsPerMph[CALIBRATION_POINTS - 1];
+    float segmentMphPerStep[CALIBRATION_POINTS - 1];
+
+    static const float KNOTS_PER_MPH;
+
+    void updateSegments();
+
+public:
+    DialGeometry(int microstepsPerStep);
+
+    int getStepsPerRevolution() const { return stepsPerRevolution; }
+    int getZeroOffsetSteps() const { return zeroOffsetSteps; }
+    float getStepsPerMph() const { return stepsPerMph; }
+
+    // Replace the scale with measured knot positions, in full steps past the
+    // 0 MPH mark. Rejected (scale unchanged) unless isValidCalibration().
+    bool setCalibration(const uint16_t fullStepsAtKnot[CALIBRATION_POINTS]);
+
+    // Starts at 0, rises strictly, stays short of a full revolution
+    static bool isValidCalibration(const uint16_t fullStepsAtKnot[CALIBRATION_POINTS]);
+
+    // The evenly spread scale, for parameter defaults
+    static void linearCalibration(uint16_t fullStepsAtKnot[CALIBRATION_POINTS]);
+
+    // Position into [0, stepsPerRevolution)
+    int wrap(int position) const;
+
+    // Signed shortest move from one position to another, at most half a revolution
+    int shortestPath(int from, int to) const;
+
+    // Steps from the home centre to a speed, rounded to the nearest step. The top of
+    // the range stops one step short of a full turn so it can't alias 0 MPH.
+    int stepsFromHome(float mph) const;
+
+    // Speed shown at a position, given where the home centre is
+    float mphAtPosition(int position, int homeCenter) const;
+};
+
+#endif // DIAL_GEOMETRY_H
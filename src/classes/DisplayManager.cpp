@@ -20,7 +20,7 @@ DisplayManager::~DisplayManager() {
     }
 }
 
-bool DisplayManager::begin() {
+bool DisplayManager::begin(bool showSplash) {
     Serial.println("Initializing OLED display with Adafruit library...");
     Serial.println("Using default I2C pins (SDA=21, SCL=22)");
 
@@ -45,7 +45,9 @@ bool DisplayManager::begin() {
     isInitialized = true;
 
     // Show boot screen
-    showBootScreen();
+    if (showSplash) {
+        showBootScreen();
+    }
 
     return true;
 }
@@ -121,7 +123,7 @@ void DisplayManager::drawStatusPage() {
     // Speed information
     display->setCursor(0, 38);
     display->print("Speed: ");
-    display->print(currentSpeed);
+    display->print(currentSpeed, 0);
     display->println(" MPH");
 
     // Status indicators
@@ -286,7 +288,7 @@ void DisplayManager::showErrorScreen(const char* error) {
     display->display();
 }
 
-void DisplayManager::updateStatus(int gear, int speed, const char* gearName) {
+void DisplayManager::updateStatus(int gear, float speed, const char* gearName) {
     this->currentGear = gear;
     this->currentSpeed = speed;
     this->gearName = String(gearName);
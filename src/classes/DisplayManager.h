@@ -26,7 +26,7 @@ private:
 
     // Display content state
     int currentGear;
-    int currentSpeed;
+    float currentSpeed;
     String gearName;
     bool servoMoving;
     bool stepperMoving;
@@ -44,7 +44,7 @@ public:
     ~DisplayManager();
 
     // Initialization
-    bool begin();
+    bool begin(bool showSplash = true);  // Warm boots skip the 2 s splash
 
     // Update method - call this regularly in main loop
     void update();
@@ -59,7 +59,7 @@ public:
     void showErrorScreen(const char* error);
 
     // Content updates
-    void updateStatus(int gear, int speed, const char* gearName);
+    void updateStatus(int gear, float speed, const char* gearName);
     void updateDiagnostics(bool servoMoving, bool stepperMoving, bool calibrated);
 
     // Getters
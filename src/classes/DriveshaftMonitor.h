@@ -2,41 +2,22 @@
 #define DRIVESHAFT_MONITOR_H
 
 #include "config.h"
-
-class DriveshaftMonitor {
-private:
-    static volatile unsigned long pulseCount;
-    static volatile unsigned long lastPulseTime;
-    static DriveshaftMonitor* instance;
-
-    unsigned long lastCalculationTime;
-    float currentRPM;
-    unsigned long lastPulseCountSnapshot;
-    bool enabled;
-
-    static const unsigned long RPM_CALCULATION_INTERVAL_MS = 1000;
-    static const unsigned long RPM_TIMEOUT_MS = 3000;
-    static constexpr float MIN_RPM_THRESHOLD = 1.0f;
-    static constexpr float MAX_RPM_THRESHOLD = 10000.0f;  // Sanity check for unrealistic RPM
-    static constexpr float MIN_STABLE_RPM = 50.0f;        // Minimum RPM to consider signal stable
-
-    static void handleInterrupt();
-
-public:
-    DriveshaftMonitor();
-
-    void begin();
-    void update();
-
-    float getRPM() const { return currentRPM; }
-    unsigned long getPulseCount() const { return pulseCount; }
-    bool isReceivingSignal() const;        // Basic pulse detection (for debug)
-    bool isValidSignal() const;            // Filtered signal validation (for control)
-
-    void reset();
-    void printStatus();
-    void setEnabled(bool enable);
-    bool isEnabled() const { return enabled; }
+#include "PulseMonitor.h"
+
+// Driveshaft optical sensor configuration for PulseMonitor
+struct DriveshaftPulseConfig {
+    static const PulseBackendType BACKEND = DRIVESHAFT_PULSE_BACKEND;
+    static const int PIN_B = DRIVESHAFT_SENSOR_B_PIN;
+    static const int PULSES_PER_REV = DRIVESHAFT_PULSES_PER_REV;
+    static const size_t QUEUE_SIZE = 128;
+    static const uint32_t MIN_EDGE_SPACING_US = 50;  // Drops sensor ringing before it reaches the queue
+    static const int PCNT_UNIT = 0;                  // PCNT backend only
+    static const int PCNT_FILTER_TICKS = 1023;       // PCNT backend only: 12.8us glitch filter
+    static const int MCPWM_UNIT = 0;                 // MCPWM capture backend only
+    static const int MCPWM_CAPTURE = 0;              // MCPWM capture backend only
+    static const char* name() { return "DriveshaftMonitor"; }
 };
 
-#endif // DRIVESHAFT_MONITOR_H
\ No newline at end of file
+typedef PulseMonitor<DRIVESHAFT_SENSOR_PIN, DriveshaftPulseConfig> DriveshaftMonitor;
+
+#endif // DRIVESHAFT_MONITOR_H
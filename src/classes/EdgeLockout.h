@@ -0,0 +1,34 @@
+#ifndef EDGE_LOCKOUT_H
+#define EDGE_LOCKOUT_H
+
+#include <stdint.h>
+
+// IRAM_ATTR comes from the ESP32 core; define it away so this header also builds on the host
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// Ringing rejection where an edge is queued: an edge no more than
+// LockoutMicros after the last accepted one is dropped. Used by every backend
+// that sees single edges (GPIO interrupt, MCPWM capture, simulated); PCNT only
+// has its glitch filter. No Arduino dependencies.
+template <uint32_t LockoutMicros>
+class EdgeLockout {
+private:
+    volatile uint32_t lastEdgeMicros;
+    volatile bool seenEdge;
+
+public:
+    EdgeLockout() : lastEdgeMicros(0), seenEdge(false) {}
+
+    bool IRAM_ATTR accept(uint32_t timestampMicros) {
+        if (seenEdge && timestampMicros - lastEdgeMicros <= LockoutMicros) {
+            return false;
+        }
+        lastEdgeMicros = timestampMicros;
+        seenEdge = true;
+        return true;
+    }
+};
+
+#endif // EDGE_LOCKOUT_H
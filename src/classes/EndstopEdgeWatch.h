@@ -0,0 +1,47 @@
+#ifndef ENDSTOP_EDGE_WATCH_H
+#define ENDSTOP_EDGE_WATCH_H
+
+#include <stdint.h>
+#include "PulseRingBuffer.h"
+
+// An endstop change, at the first generator position that read the new state
+struct EndstopEdge {
+    int32_t position;
+    bool triggered;
+};
+
+// Queues every endstop change the step interrupt sees, so a homing search can
+// step a whole sweep at the motor's rate and still place each edge on the exact
+// step. sample() runs in the step timer interrupt with the generator position
+// the rotor is sitting at, before the next step is emitted (alongside
+// MarkerCrossingDetector::sample()). The main loop takes the edges, and knows
+// the end of a move has been read once hasSampled() says so.
+// No Arduino dependencies.
+class EndstopEdgeWatch {
+private:
+    PulseRingBuffer<EndstopEdge, 16> edges;
+    volatile int32_t lastPosition;
+    volatile bool lastTriggered;
+    volatile bool primed;         // lastTriggered holds a real sample
+
+public:
+    EndstopEdgeWatch() : lastPosition(0), lastTriggered(false), primed(false) {}
+
+    inline IRAM_ATTR void sample(int32_t position, bool triggered) {
+        if (primed && triggered != lastTriggered) {
+            EndstopEdge edge = { position, triggered };
+            edges.push(edge);
+        }
+        lastTriggered = triggered;
+        lastPosition = position;
+        primed = true;
+    }
+
+    // Main loop side
+    bool take(EndstopEdge& edge) { return edges.pop(edge); }
+    void clear() { edges.clear(); }   // Drop edges from before the next move
+    bool hasSampled(int32_t position) const { return primed && lastPosition == position; }
+    uint32_t getOverflowCount() const { return edges.getOverflowCount(); }
+};
+
+#endif // ENDSTOP_EDGE_WATCH_H
@@ -0,0 +1,55 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// Q16.16 fixed-point helpers for the speed, gear-ratio and easing math.
+// Integer only, so everything here is also safe to call from an ISR (the
+// ESP32 does not save FPU state on interrupt entry). Selected with
+// USE_FIXED_POINT_MATH in config.h; the float code stays the reference.
+namespace Q16 {
+    typedef int32_t fixed;                 // 16 integer bits (signed), 16 fraction bits
+
+    static const int FRACTION_BITS = 16;
+    static const fixed ONE = (fixed)1 << FRACTION_BITS;
+    static const fixed HALF = ONE >> 1;
+
+    // Conversions - the float ones are for setup time, not the hot path
+    inline fixed fromFloat(float value) {
+        return (fixed)(value * (float)ONE + (value >= 0.0f ? 0.5f : -0.5f));
+    }
+    inline float toFloat(fixed value) { return (float)value / (float)ONE; }
+    inline fixed fromInt(int32_t value) { return (fixed)(value * ONE); }
+
+    // Round to nearest integer (halves away from zero)
+    inline int32_t roundToInt(int64_t value) {
+        return value >= 0 ? (int32_t)((value + HALF) >> FRACTION_BITS)
+                          : -(int32_t)((-value + HALF) >> FRACTION_BITS);
+    }
+
+    // Full-precision product. Kept at 64 bits: RPM * ratio factors exceed the
+    // Q16.16 integer range, and callers usually only compare or round the result.
+    inline int64_t mulWide(fixed a, fixed b) {
+        return ((int64_t)a * (int64_t)b) >> FRACTION_BITS;
+    }
+    inline fixed mul(fixed a, fixed b) { return (fixed)mulWide(a, b); }
+
+    // numerator / denominator as a Q16 fraction, clamped to [0, ONE]
+    inline fixed fromRatio(uint32_t numerator, uint32_t denominator) {
+        if (denominator == 0 || numerator >= denominator) {
+            return ONE;
+        }
+        return (fixed)(((uint64_t)numerator << FRACTION_BITS) / denominator);
+    }
+
+    // Same curve as the float easeInOutCubic(): slow start, fast middle, slow end
+    inline fixed easeInOutCubic(fixed t) {
+        if (t < HALF) {
+            return 4 * mul(mul(t, t), t);
+        }
+        fixed f = 2 * t - 2 * ONE;
+        return ONE + mul(mul(f, f), f) / 2;
+    }
+}
+
+#endif // FIXED_POINT_H
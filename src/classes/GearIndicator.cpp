@@ -6,6 +6,7 @@ GearIndicator::GearIndicator()
 	  targetGear(NEUTRAL),
 	  isInitialized(false),
 	  isMoving(false),
+	  gearTransitionTimeMs(800),
 	  transitionStartTime(0),
 	  currentAngle(GEAR_ANGLES[NEUTRAL]),
 	  startAngle(GEAR_ANGLES[NEUTRAL]),
@@ -55,7 +56,7 @@ void GearIndicator::setGear(Gear gear) {
     }
 
     // Validate gear selection
-    if (gear < REVERSE || gear > GEAR_3) {
+    if (gear < REVERSE || gear >= GEAR_COUNT) {
         Serial.print("Error: Invalid gear selection: ");
         Serial.println(gear);
         return;
@@ -82,7 +83,7 @@ void GearIndicator::setGear(Gear gear) {
 
 void GearIndicator::setGear(int gearIndex) {
     // Convert integer index to Gear enum
-    if (gearIndex >= REVERSE && gearIndex <= GEAR_3) {
+    if (gearIndex >= REVERSE && gearIndex < GEAR_COUNT) {
         setGear(static_cast<Gear>(gearIndex));
     } else {
         Serial.print("Error: Invalid gear index: ");
@@ -98,7 +99,7 @@ void GearIndicator::update() {
     unsigned long currentTime = millis();
     unsigned long elapsed = currentTime - transitionStartTime;
 
-    if (elapsed >= GEAR_TRANSITION_TIME_MS) {
+    if (elapsed >= gearTransitionTimeMs) {
         // Transition complete
         currentAngle = targetAngle;
         currentGear = targetGear;
@@ -108,8 +109,12 @@ void GearIndicator::update() {
         Serial.println(GEAR_NAMES[currentGear]);
     } else {
         // Calculate interpolated position
-        float progress = (float)elapsed / (float)GEAR_TRANSITION_TIME_MS;
+#if USE_FIXED_POINT_MATH
+        float easedProgress = Q16::toFloat(Q16::easeInOutCubic(Q16::fromRatio(elapsed, gearTransitionTimeMs)));
+#else
+        float progress = (float)elapsed / (float)gearTransitionTimeMs;
         float easedProgress = easeInOutCubic(progress);
+#endif
         currentAngle = startAngle + (targetAngle - startAngle) * easedProgress;
     }
 
@@ -156,7 +161,7 @@ void GearIndicator::testSequence() {
     Serial.println("Note: Call update() regularly in your main loop to see smooth transitions");
 
     // Cycle through all gears (transitions will be handled by update() method)
-    for (int i = REVERSE; i <= GEAR_3; i++) {
+    for (int i = REVERSE; i < GEAR_COUNT; i++) {
         setGear(static_cast<Gear>(i));
 
         // Wait for transition to complete
@@ -3,6 +3,7 @@
 
 #include <ESP32Servo.h>
 #include "config.h"
+#include "FixedPoint.h"
 
 class GearIndicator {
 private:
@@ -17,7 +18,7 @@ private:
     static const int SERVO_MAX_PULSE = 2500;  // Maximum pulse width in microseconds
 
     // Easing configuration
-    static const unsigned long GEAR_TRANSITION_TIME_MS = 800;  // Time to complete gear change
+    unsigned long gearTransitionTimeMs;  // Time to complete gear change
     unsigned long transitionStartTime;
     float currentAngle;
     float startAngle;
@@ -39,6 +40,7 @@ public:
     // Gear control methods
     void setGear(Gear gear);
     void setGear(int gearIndex);
+    void setTransitionTime(unsigned long ms) { gearTransitionTimeMs = ms > 0 ? ms : 1; }
 
     // Getters
     Gear getCurrentGear() const { return currentGear; }
@@ -0,0 +1,91 @@
+#include "GearRatioLearner.h"
+#include <math.h>
+
+GearRatioLearner::GearRatioLearner()
+	: lastCluster(-1),
+	  steadyCount(0) {
+    for (int gear = 0; gear < GEAR_COUNT; gear++) {
+        nominalRatios[gear] = 0.0f;
+        learnedRatios[gear] = 0.0f;
+        publishedRatios[gear] = 0.0f;
+        sampleCounts[gear] = 0;
+    }
+}
+
+void GearRatioLearner::reset(const float* nominal) {
+    for (int gear = 0; gear < GEAR_COUNT; gear++) {
+        nominalRatios[gear] = gear == NEUTRAL ? 0.0f : nominal[gear];
+        learnedRatios[gear] = nominalRatios[gear];
+        publishedRatios[gear] = nominalRatios[gear];
+        sampleCounts[gear] = 0;
+    }
+    lastCluster = -1;
+    steadyCount = 0;
+}
+
+int GearRatioLearner::findCluster(float ratio, bool reversing) const {
+    int best = -1;
+    float bestError = CAPTURE_TOLERANCE;
+    for (int gear = 0; gear < GEAR_COUNT; gear++) {
+        // The shaft direction decides between reverse and the forward gears
+        if (learnedRatios[gear] <= 0.0f || (gear == REVERSE) != reversing) {
+            continue;
+        }
+        float error = fabsf(ratio - learnedRatios[gear]) / learnedRatios[gear];
+        if (error < bestError) {
+            bestError = error;
+            best = gear;
+        }
+    }
+    return best;
+}
+
+bool GearRatioLearner::observe(float engineRPM, float driveshaftRPM) {
+    float shaftRPM = fabsf(driveshaftRPM);
+    if (engineRPM < MIN_ENGINE_RPM || shaftRPM < MIN_DRIVESHAFT_RPM) {
+        lastCluster = -1;
+        steadyCount = 0;
+        return false;
+    }
+
+    float ratio = engineRPM / shaftRPM;
+    int cluster = findCluster(ratio, driveshaftRPM < 0.0f);
+
+    // Only learn once the ratio has sat in one cluster for a while - a slipping
+    // clutch sweeps through every cluster without settling
+    if (cluster < 0 || cluster != lastCluster) {
+        lastCluster = cluster;
+        steadyCount = 0;
+        return false;
+    }
+    if (steadyCount < STEADY_SAMPLES) {
+        steadyCount++;
+        return false;
+    }
+
+    sampleCounts[cluster]++;
+    float rate = 1.0f / (float)sampleCounts[cluster];
+    if (rate < MIN_LEARNING_RATE) {
+        rate = MIN_LEARNING_RATE;
+    }
+    float learned = learnedRatios[cluster] + rate * (ratio - learnedRatios[cluster]);
+
+    // A cluster never wanders off to become a different gear
+    float nominal = nominalRatios[cluster];
+    float lowest = nominal * (1.0f - MAX_DRIFT);
+    float highest = nominal * (1.0f + MAX_DRIFT);
+    learnedRatios[cluster] = learned < lowest ? lowest : (learned > highest ? highest : learned);
+
+    if (fabsf(learnedRatios[cluster] - publishedRatios[cluster]) > PUBLISH_THRESHOLD * nominal) {
+        publishedRatios[cluster] = learnedRatios[cluster];
+        return true;
+    }
+    return false;
+}
+
+float GearRatioLearner::getDeviation(Gear gear) const {
+    if (nominalRatios[gear] <= 0.0f) {
+        return 0.0f;
+    }
+    return learnedRatios[gear] / nominalRatios[gear] - 1.0f;
+}
@@ -0,0 +1,50 @@
+#ifndef GEAR_RATIO_LEARNER_H
+#define GEAR_RATIO_LEARNER_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Online clustering of observed engine/driveshaft ratios, one cluster per
+// fitted gear, seeded from the nominal ratio table. Each steady sample is
+// assigned to the nearest cluster and pulls its centre towards it (running
+// mean, then a slow moving average). Fixed memory and a constant amount of
+// work per sample. Pure logic with no Arduino dependencies.
+class GearRatioLearner {
+private:
+    static constexpr float CAPTURE_TOLERANCE = 0.06f;     // Sample must be within 6% of a centre
+    static constexpr float MAX_DRIFT = 0.15f;             // Centres stay within 15% of nominal
+    static constexpr float MIN_LEARNING_RATE = 0.002f;    // Floor once the running mean has settled
+    static constexpr float PUBLISH_THRESHOLD = 0.002f;    // Report a change once a centre moves 0.2%
+    static constexpr float MIN_ENGINE_RPM = 600.0f;       // Below this the engine is idling or lugging
+    static constexpr float MIN_DRIVESHAFT_RPM = 100.0f;   // Low shaft speeds are too coarse to learn from
+    static const int STEADY_SAMPLES = 10;                 // Same cluster this many times in a row
+
+    float nominalRatios[GEAR_COUNT];
+    float learnedRatios[GEAR_COUNT];
+    float publishedRatios[GEAR_COUNT];
+    uint32_t sampleCounts[GEAR_COUNT];
+    int lastCluster;              // -1 = none
+    int steadyCount;
+
+    int findCluster(float ratio, bool reversing) const;
+
+public:
+    GearRatioLearner();
+
+    // Start over from a nominal table (indexed by Gear, 0 = not fitted)
+    void reset(const float* nominal);
+
+    // Feed one sample. True when a learned ratio has moved enough that the
+    // caller should pick up the new table.
+    bool observe(float engineRPM, float driveshaftRPM);
+
+    const float* getLearnedRatios() const { return learnedRatios; }
+    float getNominalRatio(Gear gear) const { return nominalRatios[gear]; }
+    float getLearnedRatio(Gear gear) const { return learnedRatios[gear]; }
+    uint32_t getSampleCount(Gear gear) const { return sampleCounts[gear]; }
+
+    // Learned relative to nominal, e.g. +0.021 = 2.1% numerically higher
+    float getDeviation(Gear gear) const;
+};
+
+#endif // GEAR_RATIO_LEARNER_H
@@ -0,0 +1,116 @@
+#include "HardwareStepTimer.h"
+#include <Arduino.h>
+
+#if defined(ESP32)
+#include "driver/timer.h"
+#endif
+
+HardwareStepTimer::HardwareStepTimer(int timerGroup, int timerIndex)
+	: group(timerGroup),
+	  index(timerIndex),
+	  callback(0),
+	  context(0),
+	  interval(0),
+	  rearm(false) {
+}
+
+bool IRAM_ATTR HardwareStepTimer::onAlarm(void* timer) {
+    HardwareStepTimer* self = static_cast<HardwareStepTimer*>(timer);
+#if defined(ESP32)
+    if (self->rearm) {
+        self->rearm = false;
+        timer_group_set_alarm_value_in_isr((timer_group_t)self->group, (timer_idx_t)self->index, self->interval);
+    }
+#endif
+    return self->callback(self->context);
+}
+
+bool HardwareStepTimer::begin(StepTickCallback tickCallback, void* tickContext, uint32_t intervalMicros) {
+#if defined(ESP32)
+    timer_group_t timerGroup = (timer_group_t)group;
+    timer_idx_t timerIndex = (timer_idx_t)index;
+
+    timer_config_t config = {};
+    config.alarm_en = TIMER_ALARM_EN;
+    config.counter_en = TIMER_PAUSE;
+    config.intr_type = TIMER_INTR_LEVEL;
+    config.counter_dir = TIMER_COUNT_UP;
+    config.auto_reload = TIMER_AUTORELOAD_EN;
+    config.divider = 80;  // 80 MHz APB clock -> 1 us ticks
+
+    callback = tickCallback;
+    context = tickContext;
+    interval = intervalMicros;
+    rearm = false;
+    if (timer_init(timerGroup, timerIndex, &config) != ESP_OK ||
+        timer_set_counter_value(timerGroup, timerIndex, 0) != ESP_OK ||
+        timer_set_alarm_value(timerGroup, timerIndex, intervalMicros) != ESP_OK ||
+        timer_enable_intr(timerGroup, timerIndex) != ESP_OK ||
+        timer_isr_callback_add(timerGroup, timerIndex, onAlarm, this, ESP_INTR_FLAG_IRAM) != ESP_OK ||
+        timer_start(timerGroup, timerIndex) != ESP_OK) {
+        Serial.println("HardwareStepTimer: Failed to start timer " + String(group) + "." + String(index));
+        callback = 0;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HardwareStepTimer::setInterval(uint32_t intervalMicros) {
+    if (!isRunning() || (intervalMicros == interval && !rearm)) {
+        return;
+    }
+#if defined(ESP32)
+    timer_group_t timerGroup = (timer_group_t)group;
+    timer_idx_t timerIndex = (timer_idx_t)index;
+
+    // The alarm fires when the counter reaches it, and the counter reloads to 0
+    // when it does. A counter already past a shorter interval would first run
+    // through the whole 64-bit range, so the alarm is pulled in to just ahead of
+    // the counter instead, and the interrupt restores the interval. Should the
+    // counter get past the new alarm while it is being written (another
+    // interrupt), it is written again; a counter found below the alarm has
+    // either not reached it yet or already reloaded, so a tick is only ever late.
+    uint64_t counter = 0;
+    uint64_t alarm = 0;
+    do {
+        timer_get_counter_value(timerGroup, timerIndex, &counter);
+        alarm = counter + REARM_MARGIN_US > intervalMicros ? counter + REARM_MARGIN_US : intervalMicros;
+        interval = intervalMicros;
+        rearm = alarm != intervalMicros;
+        timer_set_alarm_value(timerGroup, timerIndex, alarm);
+        timer_get_counter_value(timerGroup, timerIndex, &counter);
+    } while (counter >= alarm);
+#else
+    interval = intervalMicros;
+#endif
+}
+
+float HardwareStepTimer::getPeriodFraction() const {
+#if defined(ESP32)
+    uint32_t period = interval;
+    if (!isRunning() || period == 0) {
+        return 0.0f;
+    }
+    // The counter reloads to 0 at every tick; past the interval, the alarm was
+    // pulled in and the tick is due
+    uint64_t counter = 0;
+    timer_get_counter_value((timer_group_t)group, (timer_idx_t)index, &counter);
+    return counter >= period ? 1.0f : (float)counter / (float)period;
+#else
+    return 0.0f;
+#endif
+}
+
+void HardwareStepTimer::stop() {
+#if defined(ESP32)
+    if (isRunning()) {
+        timer_pause((timer_group_t)group, (timer_idx_t)index);
+        timer_isr_callback_remove((timer_group_t)group, (timer_idx_t)index);
+        timer_deinit((timer_group_t)group, (timer_idx_t)index);
+    }
+#endif
+    callback = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef HARDWARE_STEP_TIMER_H
+#define HARDWARE_STEP_TIMER_H
+
+#include <stdint.h>
+
+// IRAM_ATTR comes from the ESP32 core; define it away so this header also builds on the host
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+typedef bool (*StepTickCallback)(void* context);  // Returns true if a higher-priority task was woken
+
+// Periodic ESP32 general-purpose timer (1 us resolution) that calls a step
+// callback from its interrupt. The interrupt is allocated in IRAM so the needle
+// keeps stepping while flash is written; the callback and everything it calls
+// must be IRAM_ATTR. SimulatedStepTimer is the host counterpart.
+class HardwareStepTimer {
+private:
+    int group;
+    int index;
+    StepTickCallback callback;
+    void* context;
+    volatile uint32_t interval;
+    volatile bool rearm;          // Alarm was pulled in for one tick; restore interval on the next
+
+    static bool IRAM_ATTR onAlarm(void* timer);
+
+public:
+    // A shorter interval the current period has already outlasted fires this
+    // long after setInterval(), however long it took to program the alarm
+    static const uint32_t REARM_MARGIN_US = 20;
+
+    HardwareStepTimer(int timerGroup, int timerIndex);
+
+    bool begin(StepTickCallback tickCallback, void* tickContext, uint32_t intervalMicros);
+
+    // Applies to the period in progress, so the loop can change the step rate
+    // every update. The time since the last tick never comes out shorter than
+    // the new interval: the motor's top rate holds across changes.
+    void setInterval(uint32_t intervalMicros);
+    void stop();
+
+    // Share of the period in progress already gone, 0 to 1: the step it ends
+    // in is that far on its way
+    float getPeriodFraction() const;
+    bool isRunning() const { return callback != 0; }
+};
+
+#endif // HARDWARE_STEP_TIMER_H
@@ -0,0 +1,151 @@
+#include "HmmGearClassifier.h"
+#include <math.h>
+
+HmmGearClassifier::HmmGearClassifier(const float* ratios)
+	: gearRatios(ratios),
+	  confirmThreshold(DEFAULT_CONFIRM_THRESHOLD),
+	  confirmedGear(NEUTRAL),
+	  hasUpdated(false),
+	  lastUpdateMillis(0) {
+    setRatios(ratios);
+    reset();
+}
+
+void HmmGearClassifier::setRatios(const float* ratios) {
+    gearRatios = ratios;
+    for (int state = 0; state < STATE_COUNT; state++) {
+        logRatios[state] = isGearState(state) ? logf(gearRatios[state]) : 0.0f;
+    }
+}
+
+void HmmGearClassifier::reset() {
+    for (int state = 0; state < STATE_COUNT; state++) {
+        posterior[state] = 0.0f;
+    }
+    posterior[NEUTRAL] = 1.0f;
+    confirmedGear = NEUTRAL;
+    hasUpdated = false;
+}
+
+Gear HmmGearClassifier::update(float engineRPM, float driveshaftRPM, uint32_t nowMillis) {
+    uint32_t stepMillis = hasUpdated ? nowMillis - lastUpdateMillis : NOMINAL_STEP_MS;
+    if (stepMillis > MAX_STEP_MS) {
+        stepMillis = MAX_STEP_MS;
+    }
+    hasUpdated = true;
+    lastUpdateMillis = nowMillis;
+
+    float dtSeconds = (float)stepMillis * 0.001f;
+    predict(dtSeconds);
+    observe(engineRPM, driveshaftRPM, dtSeconds);
+
+    // Switch only when another state is confidently more likely - the current
+    // gear is kept through ambiguous samples instead of flickering
+    Gear mostLikely = getMostLikelyGear();
+    if (mostLikely != confirmedGear && posterior[mostLikely] >= confirmThreshold) {
+        confirmedGear = mostLikely;
+    }
+    return confirmedGear;
+}
+
+void HmmGearClassifier::predict(float dtSeconds) {
+    int gearCount = 0;
+    for (int state = 0; state < STATE_COUNT; state++) {
+        if (isGearState(state)) {
+            gearCount++;
+        }
+    }
+    if (gearCount == 0) {
+        return;
+    }
+
+    float gearExit = 1.0f - expf(-GEAR_EXIT_RATE * dtSeconds);
+    float clutchExit = 1.0f - expf(-CLUTCH_EXIT_RATE * dtSeconds);
+    float directShift = gearCount > 1 ? gearExit * DIRECT_SHIFT_FRACTION / (float)(gearCount - 1) : 0.0f;
+
+    // Mass leaving each state, redistributed below; what is not leaving stays put
+    float predicted[STATE_COUNT];
+    float toEachGear = posterior[NEUTRAL] * clutchExit / (float)gearCount;
+    float toNeutral = 0.0f;
+    float leavingGears = 0.0f;
+    for (int state = 0; state < STATE_COUNT; state++) {
+        if (isGearState(state)) {
+            toNeutral += posterior[state] * gearExit * (1.0f - DIRECT_SHIFT_FRACTION);
+            leavingGears += posterior[state] * directShift;
+        }
+    }
+
+    for (int state = 0; state < STATE_COUNT; state++) {
+        if (state == NEUTRAL) {
+            predicted[state] = posterior[state] * (1.0f - clutchExit) + toNeutral;
+        } else if (isGearState(state)) {
+            // Direct shifts arrive from every other gear, not from this one
+            float directIn = leavingGears - posterior[state] * directShift;
+            predicted[state] = posterior[state] * (1.0f - gearExit) + toEachGear + directIn;
+        } else {
+            predicted[state] = 0.0f;
+        }
+    }
+
+    for (int state = 0; state < STATE_COUNT; state++) {
+        posterior[state] = predicted[state];
+    }
+}
+
+void HmmGearClassifier::observe(float engineRPM, float driveshaftRPM, float dtSeconds) {
+    static const float LOG_RANGE = logf(MAX_RATIO / MIN_RATIO);
+    static const float GAUSS_NORM = 1.0f / (RATIO_LOG_SIGMA * sqrtf(2.0f * (float)M_PI));
+    float uniform = 1.0f / LOG_RANGE;
+
+    float likelihood[STATE_COUNT];
+    if (engineRPM < MIN_ENGINE_RPM || fabsf(driveshaftRPM) < MIN_DRIVESHAFT_RPM) {
+        // No usable ratio: stopped (engine running means clutch in) or engine off
+        for (int state = 0; state < STATE_COUNT; state++) {
+            likelihood[state] = isGearState(state) ? STOPPED_GEAR_LIKELIHOOD : 1.0f;
+        }
+    } else {
+        float logRatio = logf(engineRPM / fabsf(driveshaftRPM));  // The gearbox sits between engine and driveshaft
+        bool reversing = driveshaftRPM < 0.0f;
+
+        for (int state = 0; state < STATE_COUNT; state++) {
+            if (state == NEUTRAL) {
+                likelihood[state] = uniform;
+            } else if (!isGearState(state) || (state == REVERSE) != reversing) {
+                // The shaft direction rules out this gear (forward gears can't turn it backwards)
+                likelihood[state] = OUTLIER_PROBABILITY * uniform * 0.01f;
+            } else {
+                float z = (logRatio - logRatios[state]) / RATIO_LOG_SIGMA;
+                likelihood[state] = (1.0f - OUTLIER_PROBABILITY) * GAUSS_NORM * expf(-0.5f * z * z) +
+                                    OUTLIER_PROBABILITY * uniform;
+            }
+        }
+    }
+
+    // Back-to-back samples come from the same filtered estimates and are not
+    // independent; temper each one so a full EVIDENCE_TIME counts as one observation
+    float weight = dtSeconds < EVIDENCE_TIME_SECONDS ? dtSeconds / EVIDENCE_TIME_SECONDS : 1.0f;
+
+    float total = 0.0f;
+    for (int state = 0; state < STATE_COUNT; state++) {
+        posterior[state] *= powf(likelihood[state], weight);
+        total += posterior[state];
+    }
+
+    if (total <= 0.0f || !isfinite(total)) {
+        reset();  // Numerical collapse - start over from decoupled
+        return;
+    }
+    for (int state = 0; state < STATE_COUNT; state++) {
+        posterior[state] /= total;
+    }
+}
+
+Gear HmmGearClassifier::getMostLikelyGear() const {
+    int best = NEUTRAL;
+    for (int state = 0; state < STATE_COUNT; state++) {
+        if (posterior[state] > posterior[best]) {
+            best = state;
+        }
+    }
+    return static_cast<Gear>(best);
+}
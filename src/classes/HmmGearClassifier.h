@@ -0,0 +1,66 @@
+#ifndef HMM_GEAR_CLASSIFIER_H
+#define HMM_GEAR_CLASSIFIER_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Probabilistic gear classifier: a hidden Markov model over the gears plus a
+// "decoupled" state (neutral or clutch in, reported as NEUTRAL).
+//
+// Each sample's engine/driveshaft ratio is scored against every gear's ratio
+// (Gaussian in log ratio, so the tolerance scales with the ratio), the belief is
+// propagated with the forward algorithm, and a gear is confirmed as soon as its
+// posterior crosses the confirmation threshold - no fixed waiting period.
+// Transition probabilities and the weight of each sample's evidence are derived
+// from the time between samples, so the loop rate does not change the behaviour
+// and a ratio that is only swept through (clutch slipping, revs falling) does
+// not get confirmed. Pure logic with no Arduino dependencies.
+class HmmGearClassifier {
+public:
+    static const int STATE_COUNT = GEAR_COUNT;  // One per Gear value
+
+private:
+    static constexpr float RATIO_LOG_SIGMA = 0.05f;         // ~5% ratio measurement noise
+    static constexpr float OUTLIER_PROBABILITY = 0.02f;     // Samples that match no model at all
+    static constexpr float MIN_RATIO = 0.25f;               // Decoupled ratios are spread uniformly (in log)
+    static constexpr float MAX_RATIO = 16.0f;               //   over this range
+    static constexpr float GEAR_EXIT_RATE = 1.0f;           // Gear -> clutch in (per second)
+    static constexpr float CLUTCH_EXIT_RATE = 3.0f;         // Clutch in -> some gear (per second)
+    static constexpr float DIRECT_SHIFT_FRACTION = 0.05f;   // Gear changes that skip the decoupled state
+    static constexpr float STOPPED_GEAR_LIKELIHOOD = 0.01f; // Stopped or engine off: almost surely decoupled
+    static constexpr float EVIDENCE_TIME_SECONDS = 0.05f;   // Samples closer than this are correlated
+    static constexpr float DEFAULT_CONFIRM_THRESHOLD = 0.95f;
+    static constexpr float MIN_ENGINE_RPM = 100.0f;
+    static constexpr float MIN_DRIVESHAFT_RPM = 10.0f;
+    static const uint32_t NOMINAL_STEP_MS = 10;             // Assumed interval for the first sample
+    static const uint32_t MAX_STEP_MS = 500;                // Cap after a pause in updates
+
+    const float* gearRatios;   // Transmission ratios indexed by Gear
+    float logRatios[STATE_COUNT];
+    float posterior[STATE_COUNT];
+    float confirmThreshold;
+    Gear confirmedGear;
+    bool hasUpdated;
+    uint32_t lastUpdateMillis;
+
+    bool isGearState(int state) const { return state != NEUTRAL && gearRatios[state] > 0.0f; }
+    void predict(float dtSeconds);
+    void observe(float engineRPM, float driveshaftRPM, float dtSeconds);
+
+public:
+    HmmGearClassifier(const float* ratios);
+
+    // Feed one sample; returns the confirmed gear
+    Gear update(float engineRPM, float driveshaftRPM, uint32_t nowMillis);
+    void reset();
+
+    // Ratio table changed (new parameters or learned ratios); the belief is kept
+    void setRatios(const float* ratios);
+    void setConfirmThreshold(float threshold) { confirmThreshold = threshold; }
+
+    Gear getConfirmedGear() const { return confirmedGear; }
+    Gear getMostLikelyGear() const;
+    float getProbability(Gear gear) const { return posterior[gear]; }
+};
+
+#endif // HMM_GEAR_CLASSIFIER_H
@@ -0,0 +1,207 @@
+#include "HomingSequencer.h"
+
+HomingSequencer::HomingSequencer(const DialGeometry& dial)
+	: dial(dial),
+	  status(HOMING_IDLE),
+	  position(0),
+	  stepSize(dial.getStepsPerRevolution() / STEPS_PER_REVOLUTION),
+	  searchLimit(STEPS_PER_REVOLUTION * 3 / 2),
+	  totalMoves(0),
+	  moveIssued(false),
+	  searchClockwise(true),
+	  markerStart(0),
+	  markerEnd(0),
+	  moveStart(0),
+	  moveEnd(0),
+	  verifying(false),
+	  expectedStart(0),
+	  expectedWidth(0),
+	  tolerance(HOME_VERIFY_TOLERANCE_STEPS * stepSize) {
+}
+
+bool HomingSequencer::isActive() const {
+    return status == HOMING_VERIFY_APPROACH || status == HOMING_SEEK_START_CW || status == HOMING_SEEK_START_CCW ||
+           status == HOMING_SEEK_END || status == HOMING_CENTERING;
+}
+
+void HomingSequencer::start(int startPosition) {
+    position = dial.wrap(startPosition);
+    searchLimit = STEPS_PER_REVOLUTION * 3 / 2;
+    totalMoves = 0;
+    moveIssued = false;
+    searchClockwise = true;
+    markerStart = 0;
+    markerEnd = 0;
+    moveStart = position;
+    moveEnd = 0;
+    verifying = false;
+    status = HOMING_SEEK_START_CW;
+}
+
+void HomingSequencer::startVerify(int startPosition, int savedMarkerStart, int savedMarkerWidth) {
+    start(startPosition);
+    verifying = true;
+    expectedStart = dial.wrap(savedMarkerStart);
+    expectedWidth = savedMarkerWidth;
+
+    // Approach from whichever side of the marker is nearer
+    int expectedCenter = dial.wrap(expectedStart + expectedWidth / 2);
+    searchClockwise = dial.shortestPath(position, expectedCenter) >= 0;
+    status = HOMING_VERIFY_APPROACH;
+}
+
+int HomingSequencer::verifyStartPosition(int savedMarkerStart, int savedMarkerWidth, bool clockwise) const {
+    int margin = tolerance + stepSize;
+    return clockwise ? dial.wrap(savedMarkerStart - margin) : dial.wrap(savedMarkerStart + savedMarkerWidth + margin);
+}
+
+void HomingSequencer::resume(int savedPosition, int savedMarkerStart, int savedMarkerWidth) {
+    position = dial.wrap(savedPosition);
+    markerStart = dial.wrap(savedMarkerStart);
+    markerEnd = dial.wrap(savedMarkerStart + savedMarkerWidth);
+    totalMoves = 0;
+    verifying = false;
+    status = HOMING_COMPLETE;
+}
+
+bool HomingSequencer::matchesExpected() const {
+    int startError = dial.shortestPath(expectedStart, markerStart);
+    int widthError = getMarkerWidth() - expectedWidth;
+    return startError <= tolerance && startError >= -tolerance &&
+           widthError <= MARKER_WIDTH_TOLERANCE * stepSize && widthError >= -MARKER_WIDTH_TOLERANCE * stepSize;
+}
+
+int HomingSequencer::startMove(int steps) {
+    moveStart = position;
+    moveEnd = steps;
+    position = dial.wrap(moveStart + moveEnd);
+    moveIssued = true;
+    totalMoves++;
+    return steps;
+}
+
+int HomingSequencer::sweep(int fromTravel, int fullSteps) {
+    moveEnd = fromTravel + (searchClockwise ? fullSteps : -fullSteps) * stepSize;
+    position = dial.wrap(moveStart + moveEnd);
+    return moveEnd;
+}
+
+int HomingSequencer::advance(bool endstop) {
+    switch (status) {
+    case HOMING_VERIFY_APPROACH: {
+        if (!moveIssued) {
+            int approach = verifyStartPosition(expectedStart, expectedWidth, searchClockwise);
+            int move = dial.shortestPath(position, approach);
+            if (move != 0) {
+                return startMove(move);
+            }
+        }
+        if (endstop) {
+            status = HOMING_FAILED_VERIFY;  // Already on the marker - off by more than the tolerance
+            return 0;
+        }
+        status = searchClockwise ? HOMING_SEEK_START_CW : HOMING_SEEK_START_CCW;
+        searchLimit = 2 * tolerance / stepSize + 2;
+        startMove(0);
+        return sweep(0, searchLimit);
+    }
+
+    case HOMING_SEEK_START_CW:
+    case HOMING_SEEK_START_CCW:
+        if (!moveIssued) {
+            startMove(0);
+            return sweep(0, searchLimit);
+        }
+        // The sweep ran out without a rising edge
+        if (verifying) {
+            status = HOMING_FAILED_VERIFY;
+            return 0;
+        }
+        if (status == HOMING_SEEK_START_CW) {
+            status = HOMING_SEEK_START_CCW;
+            searchClockwise = false;
+            startMove(0);
+            return sweep(0, searchLimit);
+        }
+        status = HOMING_FAILED_NO_MARKER;
+        return 0;
+
+    case HOMING_SEEK_END:
+        status = verifying ? HOMING_FAILED_VERIFY : HOMING_FAILED_NO_MARKER_END;
+        return 0;
+
+    case HOMING_CENTERING: {
+        if (verifying && !matchesExpected()) {
+            status = HOMING_FAILED_VERIFY;
+            return 0;
+        }
+        int move = dial.shortestPath(position, getMarkerCenter());
+        if (!moveIssued && move != 0) {
+            return startMove(move);
+        }
+        status = HOMING_COMPLETE;
+        return 0;
+    }
+
+    default:
+        return 0;
+    }
+}
+
+int HomingSequencer::edge(int travel, bool triggered) {
+    int at = dial.wrap(moveStart + travel);
+
+    switch (status) {
+    case HOMING_SEEK_START_CW:
+    case HOMING_SEEK_START_CCW:
+        if (!triggered) {
+            return moveEnd;  // Leaving a marker the search started on
+        }
+        // Going clockwise this is the marker start; going counterclockwise it
+        // is the last triggered position, one step before the end
+        if (searchClockwise) {
+            markerStart = at;
+        } else {
+            markerEnd = dial.wrap(at + 1);
+        }
+        status = HOMING_SEEK_END;
+        searchLimit = verifying ? (expectedWidth + tolerance) / stepSize + MARKER_WIDTH_TOLERANCE
+                                : STEPS_PER_REVOLUTION * 3 / 2;
+        return sweep(travel, searchLimit);
+
+    case HOMING_SEEK_END:
+        if (triggered) {
+            return moveEnd;
+        }
+        if (searchClockwise) {
+            markerEnd = at;
+        } else {
+            markerStart = dial.wrap(at + 1);
+        }
+        // Back to the edge itself; centering starts from there
+        status = HOMING_CENTERING;
+        moveIssued = false;
+        moveEnd = travel;
+        position = at;
+        return moveEnd;
+
+    default:
+        return moveEnd;  // Chatter at an edge already found, or on the way back to it
+    }
+}
+
+const char* HomingSequencer::statusName(HomingStatus status) {
+    switch (status) {
+    case HOMING_IDLE:                 return "idle";
+    case HOMING_VERIFY_APPROACH:      return "approaching saved marker";
+    case HOMING_SEEK_START_CW:        return "seeking marker (CW)";
+    case HOMING_SEEK_START_CCW:       return "seeking marker (CCW)";
+    case HOMING_SEEK_END:             return "crossing marker";
+    case HOMING_CENTERING:            return "centering";
+    case HOMING_COMPLETE:             return "complete";
+    case HOMING_FAILED_NO_MARKER:     return "marker not found";
+    case HOMING_FAILED_NO_MARKER_END: return "marker end not found";
+    case HOMING_FAILED_VERIFY:        return "saved position not confirmed";
+    }
+    return "unknown";
+}
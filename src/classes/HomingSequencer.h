@@ -0,0 +1,104 @@
+#ifndef HOMING_SEQUENCER_H
+#define HOMING_SEQUENCER_H
+
+#include "DialGeometry.h"
+
+enum HomingStatus {
+    HOMING_IDLE = 0,             // Never started
+    HOMING_VERIFY_APPROACH,      // Warm boot: moving to just outside the saved marker position
+    HOMING_SEEK_START_CW,        // Stepping clockwise for the marker's rising edge
+    HOMING_SEEK_START_CCW,       // Clockwise search failed - same search counterclockwise
+    HOMING_SEEK_END,             // Crossing the marker for its falling edge
+    HOMING_CENTERING,            // Moving to the marker centre
+    HOMING_COMPLETE,
+    HOMING_FAILED_NO_MARKER,     // No rising edge within 1.5 revolutions either way
+    HOMING_FAILED_NO_MARKER_END, // Entered the marker but never left it (too wide or sensor stuck)
+    HOMING_FAILED_VERIFY         // Warm boot marker pass didn't match the saved one
+};
+
+// Home marker search as an incremental state machine. Each edge search is one
+// long move (a sweep) that the caller steps out at the motor's rate while the
+// step interrupt records every endstop change (EndstopEdgeWatch). The caller
+// passes each change to edge() as the loop finds it, and retargets the move to
+// whatever it returns: a search ends exactly on the edge it was looking for,
+// however far the rotor ran on before the loop noticed. Once a move has
+// finished and its end been sampled, advance() returns the next one. Nothing
+// here waits, so the search runs from a main loop alongside everything else.
+// Positions are wrapped drive steps; search limits count motor full steps.
+//
+// A warm boot runs the same edge searches over a short window instead: move
+// to just outside where the saved marker should be, cross it, and accept only
+// if both edges land within HOME_VERIFY_TOLERANCE_STEPS of the saved ones.
+// A wheel left resting at verifyStartPosition() skips the approach, so the
+// pass is only the tolerance, the marker and half of it back.
+// No Arduino dependencies.
+class HomingSequencer {
+private:
+    const DialGeometry& dial;
+    HomingStatus status;
+    int position;            // Where the current move ends
+    int stepSize;            // Drive steps per full step
+    int searchLimit;         // Full steps per edge search (1.5 revolutions)
+    int totalMoves;          // Moves issued since start()
+    bool moveIssued;         // The current phase's move has been handed out
+    bool searchClockwise;    // Direction the marker start was found in
+    int markerStart;         // First triggered position, clockwise sense
+    int markerEnd;           // First open position past the marker, clockwise sense
+
+    // Current move
+    int moveStart;           // Where it started
+    int moveEnd;             // Signed drive steps from moveStart to its end
+
+    // Warm boot verification
+    bool verifying;
+    int expectedStart;
+    int expectedWidth;
+    int tolerance;           // Drive steps
+
+    static const int MARKER_WIDTH_TOLERANCE = 4;  // Full steps
+
+    bool matchesExpected() const;
+
+    int startMove(int steps);              // A move from the current position
+    int sweep(int fromTravel, int fullSteps);  // Search on from fromTravel into the current move
+
+public:
+    HomingSequencer(const DialGeometry& dial);
+
+    // Begin a search from a known step position
+    void start(int position);
+
+    // Warm boot: confirm a saved marker position with one pass across it
+    void startVerify(int position, int savedMarkerStart, int savedMarkerWidth);
+
+    // Where a verify pass starts: just beyond the tolerance outside the edge it
+    // approaches (the marker start going clockwise, its end counterclockwise)
+    int verifyStartPosition(int markerStart, int markerWidth, bool clockwise) const;
+
+    // Warm boot with nothing to confirm: take the saved state as complete
+    void resume(int position, int savedMarkerStart, int savedMarkerWidth);
+
+    // Once the previous move has finished, with the endstop state at its end:
+    // the signed drive steps to move next, or 0 once the search has ended
+    int advance(bool endstop);
+
+    // An endstop change travel drive steps into the current move (signed, like
+    // the move). Returns the signed drive steps from the start of the move to
+    // where it should now end.
+    int edge(int travel, bool triggered);
+
+    HomingStatus getStatus() const { return status; }
+    bool isActive() const;
+    bool isVerifying() const { return verifying; }
+    bool isFailed() const { return status == HOMING_FAILED_NO_MARKER || status == HOMING_FAILED_NO_MARKER_END; }
+    int getPosition() const { return position; }
+    int getMarkerStart() const { return markerStart; }
+    int getMarkerEnd() const { return markerEnd; }
+    int getMarkerWidth() const { return dial.wrap(markerEnd - markerStart); }
+    int getMarkerCenter() const { return dial.wrap(markerStart + getMarkerWidth() / 2); }
+    int getTotalMoves() const { return totalMoves; }
+
+    static const char* statusName(HomingStatus status);
+};
+
+#endif // HOMING_SEQUENCER_H
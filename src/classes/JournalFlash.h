@@ -0,0 +1,94 @@
+#ifndef JOURNAL_FLASH_H
+#define JOURNAL_FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Raw NOR flash region for an append-only journal. Writes can only clear bits
+// and a sector erase sets every byte back to 0xFF - the journal relies on both.
+class JournalFlash {
+public:
+    virtual ~JournalFlash() {}
+
+    virtual size_t getSectorSize() const = 0;
+    virtual int getSectorCount() const = 0;  // 0 if the region is unavailable
+
+    virtual bool read(size_t offset, void* data, size_t length) = 0;
+    virtual bool write(size_t offset, const void* data, size_t length) = 0;
+    virtual bool eraseSector(int sector) = 0;
+};
+
+// RAM-backed flash emulator for host builds and bench testing. Keeps NOR
+// semantics (write ANDs into the cell) and can cut power after a given number
+// of programmed bytes or part way through an erase. Fixed capacity, no heap.
+template <size_t SectorSize, int SectorCount>
+class MemoryJournalFlash : public JournalFlash {
+private:
+    uint8_t cells[SectorSize * SectorCount];
+    uint32_t bytesWritten;
+    uint32_t eraseCounts[SectorCount];
+    long bytesUntilPowerCut;   // -1 = no cut armed
+    bool powerLost;
+
+public:
+    MemoryJournalFlash() : bytesWritten(0), bytesUntilPowerCut(-1), powerLost(false) {
+        memset(cells, 0xFF, sizeof(cells));
+        memset(eraseCounts, 0, sizeof(eraseCounts));
+    }
+
+    size_t getSectorSize() const { return SectorSize; }
+    int getSectorCount() const { return SectorCount; }
+
+    bool read(size_t offset, void* data, size_t length) {
+        if (offset + length > sizeof(cells)) {
+            return false;
+        }
+        memcpy(data, cells + offset, length);
+        return true;
+    }
+
+    bool write(size_t offset, const void* data, size_t length) {
+        if (powerLost || offset + length > sizeof(cells)) {
+            return false;
+        }
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            if (bytesUntilPowerCut == 0) {
+                powerLost = true;
+                return false;
+            }
+            if (bytesUntilPowerCut > 0) {
+                bytesUntilPowerCut--;
+            }
+            cells[offset + i] &= bytes[i];
+            bytesWritten++;
+        }
+        return true;
+    }
+
+    bool eraseSector(int sector) {
+        if (powerLost || sector < 0 || sector >= SectorCount) {
+            return false;
+        }
+        uint8_t* start = cells + (size_t)sector * SectorSize;
+        if (bytesUntilPowerCut >= 0) {
+            // An interrupted erase leaves the front of the sector erased and the rest untouched
+            memset(start, 0xFF, SectorSize / 2);
+            powerLost = true;
+            return false;
+        }
+        memset(start, 0xFF, SectorSize);
+        eraseCounts[sector]++;
+        return true;
+    }
+
+    // Test hooks
+    void cutPowerAfter(long bytes) { bytesUntilPowerCut = bytes; }  // An erase while armed is cut too
+    void restorePower() { bytesUntilPowerCut = -1; powerLost = false; }
+    bool isPowerLost() const { return powerLost; }
+    uint32_t getBytesWritten() const { return bytesWritten; }
+    uint32_t getEraseCount(int sector) const { return eraseCounts[sector]; }
+};
+
+#endif // JOURNAL_FLASH_H
@@ -0,0 +1,51 @@
+#include "MarkerCrossingDetector.h"
+
+MarkerCrossingDetector::MarkerCrossingDetector(const DialGeometry& dial)
+	: dial(dial),
+	  stepSize(dial.getStepsPerRevolution() / STEPS_PER_REVOLUTION),
+	  lastPosition(0),
+	  direction(0),
+	  lastTriggered(false),
+	  entryPosition(0),
+	  entryDirection(0),
+	  crossingEntry(0),
+	  crossingExit(0),
+	  crossingDirection(0),
+	  crossingCount(0),
+	  crossingsTaken(0) {
+}
+
+bool MarkerCrossingDetector::takeCrossing(MarkerCrossing& crossing) {
+    uint32_t count;
+    do {
+        count = crossingCount;
+        if (count == crossingsTaken) {
+            return false;
+        }
+        crossing.entry = crossingEntry;
+        crossing.exit = crossingExit;
+        crossing.direction = crossingDirection;
+    } while (count != crossingCount);  // Published again mid-copy
+
+    crossingsTaken = count;
+    return true;
+}
+
+bool MarkerCrossingDetector::measureDrift(const MarkerCrossing& crossing, int32_t generatorOffset,
+                                          int homeStartPosition, int homeMarkerWidth, int& drift) const {
+    int entry = dial.wrap(crossing.entry + generatorOffset);
+    int exit = dial.wrap(crossing.exit + generatorOffset);
+
+    // Clockwise the entry is the marker start; counterclockwise the exit is
+    // one step before it
+    int observedStart = crossing.direction > 0 ? entry : dial.wrap(exit + 1);
+    int observedWidth = crossing.direction > 0 ? dial.wrap(exit - entry) : dial.wrap(entry + 1 - observedStart);
+
+    int widthError = observedWidth - homeMarkerWidth;
+    if (widthError > MARKER_WIDTH_TOLERANCE * stepSize || widthError < -MARKER_WIDTH_TOLERANCE * stepSize) {
+        return false;
+    }
+
+    drift = dial.shortestPath(homeStartPosition, observedStart);
+    return drift > DRIFT_DEADBAND * stepSize || drift < -DRIFT_DEADBAND * stepSize;
+}
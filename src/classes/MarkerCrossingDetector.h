@@ -0,0 +1,94 @@
+#ifndef MARKER_CROSSING_DETECTOR_H
+#define MARKER_CROSSING_DETECTOR_H
+
+#include <stdint.h>
+#include "DialGeometry.h"
+
+// IRAM_ATTR comes from the ESP32 core; define it away so this header also builds on the host
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// One clean pass over the home marker, in step generator positions
+struct MarkerCrossing {
+    int32_t entry;       // First position the endstop read triggered
+    int32_t exit;        // First position it read open again
+    int8_t direction;    // +1 clockwise, -1 counterclockwise
+};
+
+// Watches the endstop during normal motion. sample() runs in the step timer
+// interrupt with the generator position the rotor is sitting at, before the
+// next step is emitted; a crossing is published only when the needle leaves
+// the marker in the direction it entered. The main loop then compares the
+// crossing with the calibrated marker, so steps lost to vibration or a stall
+// are found on the next pass instead of persisting until reboot.
+// No Arduino dependencies.
+class MarkerCrossingDetector {
+private:
+    const DialGeometry& dial;
+    int stepSize;                 // Drive steps per full step
+
+    // Interrupt side
+    int32_t lastPosition;
+    int8_t direction;             // Of the most recent step
+    bool lastTriggered;
+    int32_t entryPosition;
+    int8_t entryDirection;        // 0 = not on the marker (or reversed on it)
+
+    // Published by the interrupt, taken by the main loop
+    volatile int32_t crossingEntry;
+    volatile int32_t crossingExit;
+    volatile int8_t crossingDirection;
+    volatile uint32_t crossingCount;
+    uint32_t crossingsTaken;
+
+public:
+    static const int DRIFT_DEADBAND = 2;           // Full steps; sensor hysteresis and micro-step quantization
+    static const int MARKER_WIDTH_TOLERANCE = 4;   // Full steps; wider or narrower isn't a clean pass
+    static const int MIN_CROSSING_SPAN = 4;        // Full steps; anything shorter is edge chatter
+
+    MarkerCrossingDetector(const DialGeometry& dial);
+
+    inline IRAM_ATTR void sample(int32_t position, bool triggered) {
+        if (position != lastPosition) {
+            direction = position > lastPosition ? 1 : -1;
+            lastPosition = position;
+        }
+        if (triggered == lastTriggered) {
+            return;
+        }
+        lastTriggered = triggered;
+
+        if (triggered) {
+            entryPosition = position;
+            entryDirection = direction;
+        } else if (entryDirection != 0 && direction == entryDirection) {
+            // A flicker at an edge must not overwrite a real pass before the loop takes it
+            int32_t span = direction > 0 ? position - entryPosition : entryPosition - position;
+            if (span >= MIN_CROSSING_SPAN * stepSize) {
+                crossingEntry = entryPosition;
+                crossingExit = position;
+                crossingDirection = direction;
+                crossingCount = crossingCount + 1;
+            }
+            entryDirection = 0;
+        } else {
+            entryDirection = 0;
+        }
+    }
+
+    // Main loop: the newest crossing since the last call, if any
+    bool takeCrossing(MarkerCrossing& crossing);
+
+    // Signed steps the wheel's idea of position is ahead of the rotor, measured
+    // as where the marker start appeared against where calibration put it.
+    // generatorOffset maps generator positions to wheel positions. False if the
+    // crossing doesn't look like the calibrated marker or the drift is inside
+    // the deadband.
+    bool measureDrift(const MarkerCrossing& crossing, int32_t generatorOffset,
+                      int homeStartPosition, int homeMarkerWidth, int& drift) const;
+
+    uint32_t getCrossingCount() const { return crossingCount; }
+};
+
+#endif // MARKER_CROSSING_DETECTOR_H
@@ -0,0 +1,79 @@
+#include "MotionPlanner.h"
+#include <math.h>
+
+const float MotionPlanner::MAX_SUBSTEP_SECONDS = 0.002f;
+const float MotionPlanner::SETTLE_DISTANCE = 0.05f;
+
+MotionPlanner::MotionPlanner(float maxVelocity, float maxAcceleration)
+	: position(0.0f),
+	  velocity(0.0f),
+	  target(0.0f),
+	  maxVelocity(maxVelocity),
+	  maxAcceleration(maxAcceleration) {
+}
+
+void MotionPlanner::setLimits(float newMaxVelocity, float newMaxAcceleration) {
+    if (newMaxVelocity > 0.0f) {
+        maxVelocity = newMaxVelocity;
+    }
+    if (newMaxAcceleration > 0.0f) {
+        maxAcceleration = newMaxAcceleration;
+    }
+}
+
+void MotionPlanner::reset(float newPosition) {
+    position = newPosition;
+    target = newPosition;
+    velocity = 0.0f;
+}
+
+void MotionPlanner::shift(float offset) {
+    position += offset;
+    target += offset;
+}
+
+void MotionPlanner::update(float dtSeconds) {
+    if (dtSeconds <= 0.0f || isSettled()) {
+        return;
+    }
+
+    int substeps = (int)ceilf(dtSeconds / MAX_SUBSTEP_SECONDS);
+    float dt = dtSeconds / substeps;
+    for (int i = 0; i < substeps && !isSettled(); i++) {
+        integrate(dt);
+    }
+}
+
+void MotionPlanner::integrate(float dt) {
+    float distance = target - position;
+    float maxDeltaV = maxAcceleration * dt;
+
+    if (fabsf(distance) <= SETTLE_DISTANCE && fabsf(velocity) <= maxDeltaV) {
+        position = target;
+        velocity = 0.0f;
+        return;
+    }
+
+    // Fastest velocity from which the target can still be reached without
+    // overshoot. The distance is what remains after this substep, which moves on
+    // the average of the old and new velocity; with the plain sqrt(2 * a * d) the
+    // needle arrives a little fast and overshoots by a fraction of a step.
+    float direction = distance < 0.0f ? -1.0f : 1.0f;
+    float remaining = fabsf(distance) - 0.5f * velocity * direction * dt;
+    float halfStep = 0.5f * maxDeltaV;
+    float reachable = remaining > 0.0f ? sqrtf(halfStep * halfStep + 2.0f * maxAcceleration * remaining) - halfStep : 0.0f;
+    float desired = direction * (reachable < maxVelocity ? reachable : maxVelocity);
+
+    // Velocity changes by at most a * dt - continuous through any retarget
+    float newVelocity = velocity;
+    if (desired > velocity + maxDeltaV) {
+        newVelocity = velocity + maxDeltaV;
+    } else if (desired < velocity - maxDeltaV) {
+        newVelocity = velocity - maxDeltaV;
+    } else {
+        newVelocity = desired;
+    }
+
+    position += 0.5f * (velocity + newVelocity) * dt;
+    velocity = newVelocity;
+}
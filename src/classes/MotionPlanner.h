@@ -0,0 +1,41 @@
+#ifndef MOTION_PLANNER_H
+#define MOTION_PLANNER_H
+
+// Acceleration-limited, retargetable 1-D trajectory (trapezoidal velocity).
+// Each update steers the velocity towards the fastest speed that can still
+// stop on the target - min(maxVelocity, sqrt(2 * maxAcceleration * distance))
+// - changing it by at most maxAcceleration * dt. A new target therefore never
+// resets the velocity: the needle bends smoothly into the new move, and move
+// time grows with distance instead of being fixed. Units are the caller's
+// (drive steps here). No Arduino dependencies.
+class MotionPlanner {
+private:
+    float position;
+    float velocity;
+    float target;
+    float maxVelocity;
+    float maxAcceleration;
+
+    static const float MAX_SUBSTEP_SECONDS;   // Integration step, so a slow loop can't overshoot
+    static const float SETTLE_DISTANCE;       // Snap to the target once this close and slow
+
+    void integrate(float dt);
+
+public:
+    MotionPlanner(float maxVelocity, float maxAcceleration);
+
+    void setLimits(float maxVelocity, float maxAcceleration);
+    void reset(float position);              // At rest at position, target = position
+    void setTarget(float target) { this->target = target; }
+    void shift(float offset);                // Move the whole frame, e.g. to re-wrap positions
+
+    void update(float dtSeconds);
+
+    float getPosition() const { return position; }
+    float getVelocity() const { return velocity; }
+    float getTarget() const { return target; }
+    float getStoppingDistance() const { return velocity * velocity / (2.0f * maxAcceleration); }
+    bool isSettled() const { return position == target && velocity == 0.0f; }
+};
+
+#endif // MOTION_PLANNER_H
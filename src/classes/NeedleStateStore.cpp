@@ -0,0 +1,78 @@
+#include "NeedleStateStore.h"
+#include "Crc32.h"
+
+NeedleStateStore::NeedleStateStore(ParameterStorage& rtcStorage, ParameterStorage& flashStorage)
+	: rtc(rtcStorage),
+	  flash(flashStorage),
+	  flashStateValid(false),
+	  flashWrites(0) {
+    memset(&flashState, 0, sizeof(flashState));
+}
+
+bool NeedleStateStore::readRecord(ParameterStorage& storage, NeedleState& state) {
+    Record record;
+    if (!storage.read(&record, sizeof(record)) || record.magic != RECORD_MAGIC ||
+        record.crc != computeCrc32(&record, offsetof(Record, crc))) {
+        return false;
+    }
+    state = record.state;
+    return true;
+}
+
+bool NeedleStateStore::writeRecord(ParameterStorage& storage, const NeedleState& state) {
+    Record record;
+    memset(&record, 0, sizeof(record));
+    record.magic = RECORD_MAGIC;
+    record.state = state;
+    record.crc = computeCrc32(&record, offsetof(Record, crc));
+    return storage.write(&record, sizeof(record));
+}
+
+WarmBootDecision NeedleStateStore::load(int32_t stepsPerRevolution, NeedleState& state) {
+    flashStateValid = readRecord(flash, flashState);
+
+    NeedleState rtcState;
+    if (readRecord(rtc, rtcState) && rtcState.stepsPerRevolution == stepsPerRevolution) {
+        state = rtcState;
+        return rtcState.moving ? WARM_BOOT_VERIFY : WARM_BOOT_TRUST;
+    }
+
+    // Flash is only as fresh as the last orderly shutdown, so always check it
+    if (flashStateValid && flashState.stepsPerRevolution == stepsPerRevolution) {
+        state = flashState;
+        return WARM_BOOT_VERIFY;
+    }
+    return WARM_BOOT_NONE;
+}
+
+void NeedleStateStore::saveRtc(const NeedleState& state) {
+    writeRecord(rtc, state);
+}
+
+bool NeedleStateStore::saveFlash(const NeedleState& state) {
+    if (flashStateValid && memcmp(&flashState, &state, sizeof(state)) == 0) {
+        return false;  // Unchanged - don't wear the flash
+    }
+    if (!writeRecord(flash, state)) {
+        return false;
+    }
+    flashState = state;
+    flashStateValid = true;
+    flashWrites++;
+    return true;
+}
+
+void NeedleStateStore::invalidateRtc() {
+    Record record;
+    memset(&record, 0, sizeof(record));
+    rtc.write(&record, sizeof(record));
+}
+
+const char* NeedleStateStore::decisionName(WarmBootDecision decision) {
+    switch (decision) {
+    case WARM_BOOT_NONE:   return "none";
+    case WARM_BOOT_VERIFY: return "verify";
+    case WARM_BOOT_TRUST:  return "trust";
+    }
+    return "unknown";
+}
@@ -0,0 +1,64 @@
+#ifndef NEEDLE_STATE_STORE_H
+#define NEEDLE_STATE_STORE_H
+
+#include <stdint.h>
+#include "ParameterStorage.h"
+
+// What the speedometer wheel needs to skip the home marker search
+struct NeedleState {
+    int32_t stepsPerRevolution;   // Drive steps - a record from another drive mode is useless
+    int32_t homeStartPosition;
+    int32_t homeMarkerWidth;
+    int32_t position;             // Commanded step position, wrapped
+    uint16_t coilPhase;           // Step generator phase at that position
+    uint8_t moving;               // Saved mid-move: steps may have been lost since
+    uint8_t reserved;
+};
+
+enum WarmBootDecision {
+    WARM_BOOT_NONE = 0,   // No usable record - full homing
+    WARM_BOOT_VERIFY,     // Position probably right - confirm with one pass over the marker
+    WARM_BOOT_TRUST       // Reset while at rest with RTC memory intact - the rotor can't have moved
+};
+
+// Needle state kept in two places: RTC memory, rewritten whenever the
+// commanded position changes, and flash, written only once the car has been
+// parked a while (SpeedometerWheel::saveState() and park()) and only when the
+// record changed.
+// Both copies carry a magic and CRC. No Arduino dependencies.
+class NeedleStateStore {
+private:
+    struct Record {
+        uint32_t magic;
+        NeedleState state;
+        uint32_t crc;
+    };
+
+    static const uint32_t RECORD_MAGIC = 0x4E45444CUL;  // "NEDL"
+
+    ParameterStorage& rtc;
+    ParameterStorage& flash;
+    NeedleState flashState;      // Last record read from or written to flash
+    bool flashStateValid;
+    uint32_t flashWrites;
+
+    static bool readRecord(ParameterStorage& storage, NeedleState& state);
+    static bool writeRecord(ParameterStorage& storage, const NeedleState& state);
+
+public:
+    NeedleStateStore(ParameterStorage& rtcStorage, ParameterStorage& flashStorage);
+
+    // Pick the best saved record for a wheel with this many drive steps per
+    // revolution. RTC wins over flash: it is newer whenever it is valid.
+    WarmBootDecision load(int32_t stepsPerRevolution, NeedleState& state);
+
+    void saveRtc(const NeedleState& state);
+    bool saveFlash(const NeedleState& state);  // True if a write was needed and succeeded
+    void invalidateRtc();                      // Position about to become unknown (homing)
+
+    uint32_t getFlashWrites() const { return flashWrites; }
+
+    static const char* decisionName(WarmBootDecision decision);
+};
+
+#endif // NEEDLE_STATE_STORE_H
@@ -0,0 +1,28 @@
+#include "NvsParameterStorage.h"
+
+NvsParameterStorage::NvsParameterStorage(const char* ns, const char* blobKey)
+	: nvsNamespace(ns),
+	  key(blobKey),
+	  opened(false) {
+}
+
+bool NvsParameterStorage::open() {
+    if (!opened) {
+        opened = preferences.begin(nvsNamespace, false);
+    }
+    return opened;
+}
+
+bool NvsParameterStorage::read(void* data, size_t length) {
+    if (!open() || preferences.getBytesLength(key) != length) {
+        return false;
+    }
+    return preferences.getBytes(key, data, length) == length;
+}
+
+bool NvsParameterStorage::write(const void* data, size_t length) {
+    if (!open()) {
+        return false;
+    }
+    return preferences.putBytes(key, data, length) == length;
+}
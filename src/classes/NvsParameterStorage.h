@@ -0,0 +1,24 @@
+#ifndef NVS_PARAMETER_STORAGE_H
+#define NVS_PARAMETER_STORAGE_H
+
+#include <Preferences.h>
+#include "ParameterStorage.h"
+
+// Parameter blob in the ESP32 NVS partition, as a single binary key
+class NvsParameterStorage : public ParameterStorage {
+private:
+    Preferences preferences;
+    const char* nvsNamespace;
+    const char* key;
+    bool opened;
+
+    bool open();
+
+public:
+    NvsParameterStorage(const char* ns, const char* blobKey);
+
+    bool read(void* data, size_t length);
+    bool write(const void* data, size_t length);
+};
+
+#endif // NVS_PARAMETER_STORAGE_H
@@ -0,0 +1,92 @@
+#include "Odometer.h"
+
+Odometer::Odometer(JournalFlash& flash)
+	: journal(flash),
+	  odometerMilliMiles(0),
+	  tripMilliMiles(0),
+	  fractionalMilliMiles(0.0f),
+	  milliMilesPerRevolution(0.0f),
+	  lastPulseCount(0),
+	  hasPulseCount(false),
+	  committedOdometerMilliMiles(0),
+	  committedTripMilliMiles(0),
+	  lastCommitMillis(0),
+	  lastMovementMillis(0),
+	  hasCommitted(false),
+	  commitCount(0),
+	  failedCommitCount(0) {
+}
+
+bool Odometer::begin() {
+    if (!journal.recover()) {
+        return false;
+    }
+
+    OdometerRecord record;
+    if (journal.getLatest(record)) {
+        odometerMilliMiles = record.odometerMilliMiles;
+        tripMilliMiles = record.tripMilliMiles;
+    }
+    committedOdometerMilliMiles = odometerMilliMiles;
+    committedTripMilliMiles = tripMilliMiles;
+    return true;
+}
+
+void Odometer::update(unsigned long pulseCount, int pulsesPerRevolution, unsigned long nowMillis) {
+    if (!hasPulseCount) {
+        // First reading is only a baseline
+        lastPulseCount = pulseCount;
+        lastMovementMillis = nowMillis;
+        hasPulseCount = true;
+        return;
+    }
+
+    // A count below the last one means the monitor was reset and restarted from zero
+    unsigned long pulses = pulseCount >= lastPulseCount ? pulseCount - lastPulseCount : pulseCount;
+    lastPulseCount = pulseCount;
+
+    if (pulses > 0 && pulsesPerRevolution > 0) {
+        lastMovementMillis = nowMillis;
+        fractionalMilliMiles += pulses * (milliMilesPerRevolution / pulsesPerRevolution);
+        if (fractionalMilliMiles >= 1.0f) {
+            uint32_t whole = (uint32_t)fractionalMilliMiles;
+            fractionalMilliMiles -= whole;
+            odometerMilliMiles += whole;
+            tripMilliMiles += whole;
+        }
+    }
+
+    uint32_t uncommitted = odometerMilliMiles - committedOdometerMilliMiles;
+    if (uncommitted == 0 || (hasCommitted && nowMillis - lastCommitMillis < MIN_COMMIT_INTERVAL_MS)) {
+        return;
+    }
+    if (uncommitted >= COMMIT_DISTANCE_MILLI_MILES || nowMillis - lastMovementMillis >= IDLE_COMMIT_MS) {
+        commit(nowMillis);
+    }
+}
+
+bool Odometer::commit(unsigned long nowMillis) {
+    // A failed write is retried after the next interval rather than every loop
+    lastCommitMillis = nowMillis;
+    hasCommitted = true;
+    if (!journal.append(odometerMilliMiles, tripMilliMiles)) {
+        failedCommitCount++;
+        return false;
+    }
+    committedOdometerMilliMiles = odometerMilliMiles;
+    committedTripMilliMiles = tripMilliMiles;
+    commitCount++;
+    return true;
+}
+
+bool Odometer::flush(unsigned long nowMillis) {
+    if (odometerMilliMiles == committedOdometerMilliMiles && tripMilliMiles == committedTripMilliMiles) {
+        return true;
+    }
+    return commit(nowMillis);
+}
+
+bool Odometer::resetTrip(unsigned long nowMillis) {
+    tripMilliMiles = 0;
+    return flush(nowMillis);
+}
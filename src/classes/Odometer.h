@@ -0,0 +1,64 @@
+#ifndef ODOMETER_H
+#define ODOMETER_H
+
+#include <stdint.h>
+#include "OdometerJournal.h"
+
+// Odometer and trip meter. Distance is integrated from driveshaft pulse
+// counts - never from the displayed speed - and buffered in RAM; the journal
+// is only written once enough distance has built up (or the car stops), and
+// never more often than MIN_COMMIT_INTERVAL_MS, so flash wear has a hard bound.
+class Odometer {
+private:
+    OdometerJournal journal;
+
+    uint32_t odometerMilliMiles;     // Whole thousandths of a mile, committed or not
+    uint32_t tripMilliMiles;
+    float fractionalMilliMiles;      // Sub-unit remainder carried between updates
+    float milliMilesPerRevolution;
+
+    unsigned long lastPulseCount;
+    bool hasPulseCount;
+    uint32_t committedOdometerMilliMiles;
+    uint32_t committedTripMilliMiles;
+    unsigned long lastCommitMillis;
+    unsigned long lastMovementMillis;
+    bool hasCommitted;
+    uint32_t commitCount;
+    uint32_t failedCommitCount;
+
+    bool commit(unsigned long nowMillis);
+
+public:
+    static const uint32_t COMMIT_DISTANCE_MILLI_MILES = 100;   // Journal every 0.1 mile while driving...
+    static const unsigned long IDLE_COMMIT_MS = 3000;         // ...or once stopped this long
+    static const unsigned long MIN_COMMIT_INTERVAL_MS = 10000; // Hard write-rate bound
+
+    Odometer(JournalFlash& flash);
+
+    // Restore the last journalled values. False if the flash region is unusable
+    // (the odometer then counts from zero in RAM only).
+    bool begin();
+
+    // Distance per driveshaft revolution, e.g. VehicleFactors::mphPerDriveshaftRPM / 60
+    void setMilesPerRevolution(float miles) { milliMilesPerRevolution = miles * 1000.0f; }
+
+    // Feed the driveshaft monitor's running pulse count; both directions add distance
+    void update(unsigned long pulseCount, int pulsesPerRevolution, unsigned long nowMillis);
+
+    // Journal any uncommitted distance now, bypassing the triggers and the
+    // rate bound - for rare events such as a trip reset or a planned shutdown
+    bool flush(unsigned long nowMillis);
+    bool resetTrip(unsigned long nowMillis);
+
+    float getOdometerMiles() const { return odometerMilliMiles / 1000.0f; }
+    float getTripMiles() const { return tripMilliMiles / 1000.0f; }
+    uint32_t getOdometerMilliMiles() const { return odometerMilliMiles; }
+    uint32_t getTripMilliMiles() const { return tripMilliMiles; }
+    uint32_t getUncommittedMilliMiles() const { return odometerMilliMiles - committedOdometerMilliMiles; }
+    uint32_t getCommitCount() const { return commitCount; }
+    uint32_t getFailedCommitCount() const { return failedCommitCount; }
+    const OdometerJournal& getJournal() const { return journal; }
+};
+
+#endif // ODOMETER_H
@@ -0,0 +1,149 @@
+#include "OdometerJournal.h"
+#include "Crc32.h"
+#include <stddef.h>
+
+OdometerJournal::OdometerJournal(JournalFlash& region)
+	: flash(region),
+	  sectorCount(0),
+	  recordsPerSector(0),
+	  writeSector(0),
+	  writeSlot(0),
+	  nextSequence(1),
+	  hasLatest(false),
+	  recoveryReads(0) {
+    memset(&latest, 0, sizeof(latest));
+}
+
+uint32_t OdometerJournal::computeRecordCrc(const OdometerRecord& record) {
+    return computeCrc32(&record, offsetof(OdometerRecord, crc));
+}
+
+OdometerJournal::SlotState OdometerJournal::readSlot(int sector, int slot, OdometerRecord& record) {
+    recoveryReads++;
+    size_t offset = (size_t)sector * flash.getSectorSize() + (size_t)slot * sizeof(OdometerRecord);
+    if (!flash.read(offset, &record, sizeof(record))) {
+        return SLOT_CORRUPT;
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    bool erased = true;
+    for (size_t i = 0; i < sizeof(record); i++) {
+        if (bytes[i] != 0xFF) {
+            erased = false;
+            break;
+        }
+    }
+    if (erased) {
+        return SLOT_ERASED;
+    }
+    return record.crc == computeRecordCrc(record) ? SLOT_VALID : SLOT_CORRUPT;
+}
+
+bool OdometerJournal::recover() {
+    sectorCount = flash.getSectorCount();
+    recordsPerSector = (int)(flash.getSectorSize() / sizeof(OdometerRecord));
+    recoveryReads = 0;
+    hasLatest = false;
+    if (!isAvailable()) {
+        return false;
+    }
+
+    // Newest sector = the one whose first valid record has the highest sequence.
+    // Torn slots at the front of a sector are skipped, erased ones end the search.
+    int newestSector = -1;
+    int newestHeadSlot = 0;
+    uint32_t newestSequence = 0;
+    for (int sector = 0; sector < sectorCount; sector++) {
+        OdometerRecord record;
+        for (int slot = 0; slot < recordsPerSector; slot++) {
+            SlotState state = readSlot(sector, slot, record);
+            if (state == SLOT_ERASED) {
+                break;
+            }
+            if (state == SLOT_VALID) {
+                if (newestSector < 0 || record.sequence > newestSequence) {
+                    newestSector = sector;
+                    newestHeadSlot = slot;
+                    newestSequence = record.sequence;
+                }
+                break;
+            }
+        }
+    }
+
+    if (newestSector < 0) {
+        // Empty (or foreign) region: the first append erases sector 0
+        writeSector = sectorCount - 1;
+        writeSlot = recordsPerSector;
+        nextSequence = 1;
+        return true;
+    }
+
+    // Slots are programmed in order after an erase, so the programmed ones form
+    // a prefix of the sector - binary search for the first erased slot
+    OdometerRecord record;
+    int low = newestHeadSlot + 1;
+    int high = recordsPerSector;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (readSlot(newestSector, middle, record) == SLOT_ERASED) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    writeSector = newestSector;
+    writeSlot = low;
+
+    // The newest valid record sits just before it unless the last write was torn
+    for (int slot = low - 1; slot >= newestHeadSlot; slot--) {
+        if (readSlot(newestSector, slot, record) == SLOT_VALID) {
+            latest = record;
+            hasLatest = true;
+            break;
+        }
+    }
+    nextSequence = latest.sequence + 1;
+    return true;
+}
+
+bool OdometerJournal::append(uint32_t odometerMilliMiles, uint32_t tripMilliMiles) {
+    if (!isAvailable()) {
+        return false;
+    }
+
+    if (writeSlot >= recordsPerSector) {
+        // Move into the next sector, which holds the oldest records
+        int sector = (writeSector + 1) % sectorCount;
+        if (!flash.eraseSector(sector)) {
+            return false;
+        }
+        writeSector = sector;
+        writeSlot = 0;
+    }
+
+    OdometerRecord record;
+    record.sequence = nextSequence++;
+    record.odometerMilliMiles = odometerMilliMiles;
+    record.tripMilliMiles = tripMilliMiles;
+    record.crc = computeRecordCrc(record);
+
+    // The slot is used up even if programming fails - it may be partly written
+    size_t offset = (size_t)writeSector * flash.getSectorSize() + (size_t)writeSlot * sizeof(OdometerRecord);
+    writeSlot++;
+    if (!flash.write(offset, &record, sizeof(record))) {
+        return false;
+    }
+
+    latest = record;
+    hasLatest = true;
+    return true;
+}
+
+bool OdometerJournal::getLatest(OdometerRecord& record) const {
+    if (!hasLatest) {
+        return false;
+    }
+    record = latest;
+    return true;
+}
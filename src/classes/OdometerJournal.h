@@ -0,0 +1,62 @@
+#ifndef ODOMETER_JOURNAL_H
+#define ODOMETER_JOURNAL_H
+
+#include <stdint.h>
+#include "JournalFlash.h"
+
+// One journal entry. Distances are whole thousandths of a mile.
+struct OdometerRecord {
+    uint32_t sequence;            // One higher than the previous record, across the whole region
+    uint32_t odometerMilliMiles;
+    uint32_t tripMilliMiles;
+    uint32_t crc;                 // CRC-32 of the fields above
+};
+
+// Append-only, wear-levelled odometer log on a JournalFlash region.
+//
+// Records are appended slot by slot and sector by sector around the region,
+// so every sector is erased exactly once per lap. A sector is erased only when
+// the write position enters it, and it always holds the oldest records, so the
+// newest valid record survives a power cut at any point. A torn record fails
+// its CRC and the previous one is used instead.
+//
+// recover() reads the first valid record of each sector to find the newest
+// sector, then binary searches that sector for its first erased slot: about
+// sectors + log2(records per sector) reads instead of a scan of the region.
+class OdometerJournal {
+private:
+    enum SlotState {
+        SLOT_ERASED,
+        SLOT_VALID,
+        SLOT_CORRUPT   // Torn write or stale bits
+    };
+
+    JournalFlash& flash;
+    int sectorCount;
+    int recordsPerSector;
+    int writeSector;
+    int writeSlot;                // Next slot to program; recordsPerSector = sector full
+    uint32_t nextSequence;
+    OdometerRecord latest;
+    bool hasLatest;
+    uint32_t recoveryReads;       // Slot reads done by the last recover()
+
+    SlotState readSlot(int sector, int slot, OdometerRecord& record);
+    static uint32_t computeRecordCrc(const OdometerRecord& record);
+
+public:
+    OdometerJournal(JournalFlash& region);
+
+    // Locate the newest record and the write position. False if the region is
+    // unusable; an empty journal is not an error (getLatest() then fails).
+    bool recover();
+
+    bool append(uint32_t odometerMilliMiles, uint32_t tripMilliMiles);
+
+    bool getLatest(OdometerRecord& record) const;
+    bool isAvailable() const { return sectorCount >= 2 && recordsPerSector > 0; }
+    uint32_t getRecoveryReads() const { return recoveryReads; }
+    int getCapacity() const { return sectorCount * recordsPerSector; }  // Records per wear-levelling lap
+};
+
+#endif // ODOMETER_JOURNAL_H
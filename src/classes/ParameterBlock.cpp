@@ -0,0 +1,42 @@
+#include "ParameterBlock.h"
+
+ParameterBlock::ParameterBlock(ParameterStorage& store, const VehicleParameters& defaultParameters)
+	: storage(store),
+	  parameters(defaultParameters),
+	  defaults(defaultParameters) {
+    defaults.crc = computeParameterCrc(defaults);
+    parameters = defaults;
+}
+
+ParameterLoadResult ParameterBlock::load() {
+    VehicleParameters stored;
+    if (!storage.read(&stored, sizeof(stored))) {
+        parameters = defaults;
+        return PARAMETERS_DEFAULTED;
+    }
+
+    if (!isValidVehicleParameters(stored)) {
+        parameters = defaults;
+        return PARAMETERS_INVALID;
+    }
+
+    parameters = stored;
+    return PARAMETERS_LOADED;
+}
+
+bool ParameterBlock::save(const VehicleParameters& updated) {
+    VehicleParameters candidate = updated;
+    candidate.magic = PARAMETER_MAGIC;
+    candidate.version = PARAMETER_VERSION;
+    candidate.size = sizeof(VehicleParameters);
+    candidate.crc = computeParameterCrc(candidate);
+
+    if (!isValidVehicleParameters(candidate)) {
+        return false;
+    }
+    if (!storage.write(&candidate, sizeof(candidate))) {
+        return false;
+    }
+    parameters = candidate;
+    return true;
+}
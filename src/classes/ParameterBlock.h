@@ -0,0 +1,37 @@
+#ifndef PARAMETER_BLOCK_H
+#define PARAMETER_BLOCK_H
+
+#include "VehicleParameters.h"
+#include "ParameterStorage.h"
+
+enum ParameterLoadResult {
+    PARAMETERS_LOADED,        // Stored block was valid
+    PARAMETERS_DEFAULTED,     // Nothing stored - defaults in use
+    PARAMETERS_INVALID        // Stored block failed version/CRC/range checks - defaults in use
+};
+
+// Versioned, CRC-checked vehicle parameter block on top of a ParameterStorage.
+// load() is a single blob read plus a CRC over ~60 bytes; after that the
+// parameters are a plain struct.
+class ParameterBlock {
+private:
+    ParameterStorage& storage;
+    VehicleParameters parameters;
+    VehicleParameters defaults;
+
+public:
+    ParameterBlock(ParameterStorage& store, const VehicleParameters& defaultParameters);
+
+    ParameterLoadResult load();
+
+    // Replace the parameters (validated after the CRC is refreshed) and persist them
+    bool save(const VehicleParameters& updated);
+    bool save() { return save(parameters); }
+
+    // Forget stored values and persist the defaults
+    bool restoreDefaults() { return save(defaults); }
+
+    const VehicleParameters& get() const { return parameters; }
+};
+
+#endif // PARAMETER_BLOCK_H
@@ -0,0 +1,54 @@
+#ifndef PARAMETER_STORAGE_H
+#define PARAMETER_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Where a parameter block blob lives. Only touched at boot and on save, never
+// in the update loop, so a virtual interface costs nothing that matters.
+class ParameterStorage {
+public:
+    virtual ~ParameterStorage() {}
+
+    // Read exactly length bytes; false if nothing (or a different size) is stored
+    virtual bool read(void* data, size_t length) = 0;
+    virtual bool write(const void* data, size_t length) = 0;
+};
+
+// RAM-backed storage for host builds and bench testing. Fixed capacity, no heap.
+template <size_t Capacity>
+class MemoryParameterStorage : public ParameterStorage {
+private:
+    uint8_t buffer[Capacity];
+    size_t storedLength;     // 0 = empty
+    uint32_t writeCount;
+
+public:
+    MemoryParameterStorage() : storedLength(0), writeCount(0) {}
+
+    bool read(void* data, size_t length) {
+        if (storedLength == 0 || length != storedLength) {
+            return false;
+        }
+        memcpy(data, buffer, length);
+        return true;
+    }
+
+    bool write(const void* data, size_t length) {
+        if (length == 0 || length > Capacity) {
+            return false;
+        }
+        memcpy(buffer, data, length);
+        storedLength = length;
+        writeCount++;
+        return true;
+    }
+
+    // Test hooks
+    void erase() { storedLength = 0; }
+    void corruptByte(size_t index) { if (index < storedLength) buffer[index] ^= 0xFF; }
+    uint32_t getWriteCount() const { return writeCount; }
+};
+
+#endif // PARAMETER_STORAGE_H
@@ -0,0 +1,35 @@
+#include "PartitionJournalFlash.h"
+
+PartitionJournalFlash::PartitionJournalFlash(const char* partitionLabel)
+	: label(partitionLabel),
+	  partition(NULL),
+	  searched(false) {
+}
+
+const esp_partition_t* PartitionJournalFlash::find() const {
+    if (!searched) {
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+        searched = true;
+    }
+    return partition;
+}
+
+int PartitionJournalFlash::getSectorCount() const {
+    const esp_partition_t* region = find();
+    return region ? (int)(region->size / SECTOR_SIZE) : 0;
+}
+
+bool PartitionJournalFlash::read(size_t offset, void* data, size_t length) {
+    const esp_partition_t* region = find();
+    return region && esp_partition_read(region, offset, data, length) == ESP_OK;
+}
+
+bool PartitionJournalFlash::write(size_t offset, const void* data, size_t length) {
+    const esp_partition_t* region = find();
+    return region && esp_partition_write(region, offset, data, length) == ESP_OK;
+}
+
+bool PartitionJournalFlash::eraseSector(int sector) {
+    const esp_partition_t* region = find();
+    return region && esp_partition_erase_range(region, (size_t)sector * SECTOR_SIZE, SECTOR_SIZE) == ESP_OK;
+}
@@ -0,0 +1,31 @@
+#ifndef PARTITION_JOURNAL_FLASH_H
+#define PARTITION_JOURNAL_FLASH_H
+
+#include <esp_partition.h>
+#include "JournalFlash.h"
+
+// Journal region in a dedicated data partition (see partitions.csv), accessed
+// raw through the partition API - no NVS or filesystem layer, so the journal
+// does all of the wear levelling itself.
+class PartitionJournalFlash : public JournalFlash {
+private:
+    const char* label;
+    mutable const esp_partition_t* partition;   // Looked up on first use, after the flash driver is up
+    mutable bool searched;
+
+    const esp_partition_t* find() const;
+
+public:
+    static const size_t SECTOR_SIZE = 4096;   // ESP32 flash erase unit
+
+    PartitionJournalFlash(const char* partitionLabel);
+
+    size_t getSectorSize() const { return SECTOR_SIZE; }
+    int getSectorCount() const;
+
+    bool read(size_t offset, void* data, size_t length);
+    bool write(size_t offset, const void* data, size_t length);
+    bool eraseSector(int sector);
+};
+
+#endif // PARTITION_JOURNAL_FLASH_H
@@ -0,0 +1,333 @@
+#ifndef PULSE_BACKENDS_H
+#define PULSE_BACKENDS_H
+
+#include "EdgeLockout.h"
+#include "PulseRingBuffer.h"
+#include "PulseEstimator.h"
+#include "QuadratureDecoder.h"
+#include "SimulatedPulseBackend.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+#if defined(ESP32)
+#include "driver/pcnt.h"
+#include "driver/mcpwm.h"
+#endif
+
+// Pulse acquisition backends for PulseMonitor.
+//
+// Every backend is a class template over <Pin, Config> with only static members,
+// so each sensor instantiation gets its own hardware state and no virtual
+// dispatch is involved. The hardware backends need the Arduino core (PCNT and
+// MCPWM capture the ESP32 one); the simulated backend builds anywhere. A
+// backend provides:
+//   static const char* name();
+//   static void begin();                  // Sets up the pins too
+//   static uint32_t now();                // Microseconds, in the time base of its timestamps
+//   static void drain(PulseEstimator& estimator, uint32_t nowMicros);  // nowMicros stamps hardware counts
+//   static void clear();
+//   static void setEnabled(bool enable);  static bool isEnabled();
+//   static uint32_t getOverflowCount();   static uint32_t getIllegalTransitionCount();
+enum PulseBackendType {
+    PULSE_BACKEND_GPIO_ISR = 0,       // One GPIO interrupt per edge, timestamped with micros()
+    PULSE_BACKEND_PCNT = 1,           // Hardware pulse counter with glitch filter - no per-edge interrupts
+    PULSE_BACKEND_MCPWM_CAPTURE = 2,  // MCPWM input capture - hardware edge timestamps
+    PULSE_BACKEND_SIMULATED = 3       // No hardware; pulses injected by code
+};
+
+#if defined(ARDUINO)
+
+// GPIO interrupt on every edge (the original acquisition path).
+// Config: MIN_EDGE_SPACING_US, optional PIN_B for quadrature decoding.
+template <int Pin, typename Config>
+class GpioIsrBackend {
+private:
+    struct State {
+        PulseRingBuffer<PulseEvent, Config::QUEUE_SIZE> queue;
+        EdgeLockout<Config::MIN_EDGE_SPACING_US> lockout;
+        QuadratureDecoder decoder;
+        volatile bool enabled;
+    };
+    static State state;
+
+    static void IRAM_ATTR handleInterrupt() {
+        if (!state.enabled) {
+            return;
+        }
+
+        uint32_t nowMicros = micros();
+
+        // Glitch filtering happens in update(); here we only drop ringing
+        if (state.lockout.accept(nowMicros)) {
+            PulseEvent event = { nowMicros, 1 };
+            state.queue.push(event);  // Overflow is counted by the queue
+        }
+    }
+
+    static void IRAM_ATTR handleQuadratureInterrupt() {
+        // The decoder must see every edge to stay in phase, even while disabled
+        int8_t step = state.decoder.update(digitalRead(Pin) == HIGH, digitalRead(Config::PIN_B) == HIGH);
+
+        if (step == 0 || !state.enabled) {
+            return;
+        }
+
+        // Bounce is absorbed by the decoder, so no spacing check is needed here
+        PulseEvent event = { (uint32_t)micros(), step };
+        state.queue.push(event);
+    }
+
+public:
+    static const char* name() { return "GPIO interrupt"; }
+    static uint32_t now() { return micros(); }
+
+    static void begin() {
+        pinMode(Pin, INPUT_PULLUP);
+        if (Config::PIN_B >= 0) {
+            pinMode(Config::PIN_B, INPUT_PULLUP);
+            state.decoder.reset(digitalRead(Pin) == HIGH, digitalRead(Config::PIN_B) == HIGH);
+
+            // Every edge on either channel steps the decoder
+            attachInterrupt(digitalPinToInterrupt(Pin), handleQuadratureInterrupt, CHANGE);
+            attachInterrupt(digitalPinToInterrupt(Config::PIN_B), handleQuadratureInterrupt, CHANGE);
+        } else {
+            attachInterrupt(digitalPinToInterrupt(Pin), handleInterrupt, FALLING);
+        }
+    }
+
+    static void drain(PulseEstimator& estimator, uint32_t /* nowMicros */) {
+        static const size_t DRAIN_BATCH = 16;  // Events copied out of the queue per pass
+        PulseEvent events[DRAIN_BATCH];
+        size_t count;
+
+        while ((count = state.queue.popBatch(events, DRAIN_BATCH)) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                estimator.recordPulse(events[i]);
+            }
+        }
+    }
+
+    static void clear() { state.queue.clear(); }
+    static void setEnabled(bool enable) { state.enabled = enable; }
+    static bool isEnabled() { return state.enabled; }
+    static uint32_t getOverflowCount() { return state.queue.getOverflowCount(); }
+    static uint32_t getIllegalTransitionCount() { return state.decoder.getIllegalCount(); }
+};
+
+template <int Pin, typename Config>
+typename GpioIsrBackend<Pin, Config>::State GpioIsrBackend<Pin, Config>::state;
+
+#endif // ARDUINO
+
+#if defined(ESP32)
+
+// ESP32 PCNT hardware counter. Edges are counted (and glitch filtered) in
+// hardware with no interrupts at all; update() reads the count delta. With no
+// single edges to look at, MIN_EDGE_SPACING_US can't be applied: only ringing
+// shorter than the glitch filter is dropped.
+// With PIN_B the counter runs in x1 quadrature mode (B low counts down).
+// Config: PCNT_UNIT (0-7), PCNT_FILTER_TICKS (APB cycles, max 1023 = 12.8us).
+template <int Pin, typename Config>
+class PcntBackend {
+private:
+    static const int16_t COUNTER_LIMIT = 32767;  // Counter wraps to 0 at +/- this value
+
+    struct State {
+        int16_t lastCount;
+        bool enabled;
+    };
+    static State state;
+
+    static pcnt_unit_t unit() { return (pcnt_unit_t)Config::PCNT_UNIT; }
+
+public:
+    static const char* name() { return "PCNT counter"; }
+    static uint32_t now() { return micros(); }
+
+    static void begin() {
+        pinMode(Pin, INPUT_PULLUP);
+        pcnt_config_t config = {};
+        config.pulse_gpio_num = Pin;
+        config.ctrl_gpio_num = Config::PIN_B >= 0 ? Config::PIN_B : PCNT_PIN_NOT_USED;
+        config.channel = PCNT_CHANNEL_0;
+        config.unit = unit();
+        config.pos_mode = PCNT_COUNT_DIS;   // Falling edges only, same as the GPIO ISR
+        config.neg_mode = PCNT_COUNT_INC;
+        config.lctrl_mode = Config::PIN_B >= 0 ? PCNT_MODE_REVERSE : PCNT_MODE_KEEP;
+        config.hctrl_mode = PCNT_MODE_KEEP;
+        config.counter_h_lim = COUNTER_LIMIT;
+        config.counter_l_lim = -COUNTER_LIMIT;
+        pcnt_unit_config(&config);
+
+        pcnt_set_filter_value(unit(), Config::PCNT_FILTER_TICKS);
+        pcnt_filter_enable(unit());
+
+        pcnt_counter_pause(unit());
+        pcnt_counter_clear(unit());
+        pcnt_counter_resume(unit());
+        state.lastCount = 0;
+    }
+
+    static void drain(PulseEstimator& estimator, uint32_t nowMicros) {
+        int16_t count = 0;
+        pcnt_get_counter_value(unit(), &count);
+
+        // The counter snaps back to zero at either limit; assume fewer than
+        // half a range of pulses between reads
+        int32_t pulses = (int32_t)count - (int32_t)state.lastCount;
+        if (pulses > COUNTER_LIMIT / 2) {
+            pulses -= COUNTER_LIMIT;
+        } else if (pulses < -COUNTER_LIMIT / 2) {
+            pulses += COUNTER_LIMIT;
+        }
+        state.lastCount = count;
+
+        if (state.enabled) {
+            estimator.recordPulseCount(pulses, nowMicros);
+        }
+    }
+
+    static void clear() {
+        pcnt_counter_clear(unit());
+        state.lastCount = 0;
+    }
+
+    static void setEnabled(bool enable) { state.enabled = enable; }
+    static bool isEnabled() { return state.enabled; }
+    static uint32_t getOverflowCount() { return 0; }           // Hardware counting cannot drop pulses
+    static uint32_t getIllegalTransitionCount() { return 0; }
+};
+
+template <int Pin, typename Config>
+typename PcntBackend<Pin, Config>::State PcntBackend<Pin, Config>::state;
+
+// ESP32 MCPWM input capture. The capture unit latches the APB timer on each
+// falling edge, so timestamps are free of interrupt latency jitter. Capture
+// ticks are converted to the micros() time base by accumulating tick deltas
+// from an anchor, re-anchoring if the two drift apart (e.g. after the 53 s
+// capture timer wrap). With PIN_B, direction is taken from B at the edge.
+// Config: MCPWM_UNIT (0-1), MCPWM_CAPTURE (0-2), MIN_EDGE_SPACING_US.
+template <int Pin, typename Config>
+class McpwmCaptureBackend {
+private:
+    static const uint32_t TICKS_PER_MICROSECOND = 80;  // Capture timer runs from the 80 MHz APB clock
+    static const uint32_t MAX_ANCHOR_ERROR_US = 1000;
+
+    struct State {
+        PulseRingBuffer<PulseEvent, Config::QUEUE_SIZE> queue;
+        EdgeLockout<Config::MIN_EDGE_SPACING_US> lockout;   // On capture time, so interrupt latency doesn't count
+        volatile bool enabled;
+        bool anchored;
+        uint32_t lastCaptureTicks;
+        uint32_t lastEventMicros;
+        uint32_t remainderTicks;   // Sub-microsecond ticks carried between events
+    };
+    static State state;
+
+    static mcpwm_unit_t mcpwmUnit() { return (mcpwm_unit_t)Config::MCPWM_UNIT; }
+
+    static bool IRAM_ATTR onCapture(mcpwm_unit_t captureUnit, mcpwm_capture_channel_id_t channel,
+                                    const cap_event_data_t* edata, void* userData) {
+        uint32_t nowMicros = micros();
+        uint32_t ticks = edata->cap_value;
+        uint32_t timestamp = nowMicros;
+
+        if (state.anchored) {
+            uint32_t deltaTicks = ticks - state.lastCaptureTicks + state.remainderTicks;
+            timestamp = state.lastEventMicros + deltaTicks / TICKS_PER_MICROSECOND;
+            state.remainderTicks = deltaTicks % TICKS_PER_MICROSECOND;
+
+            // The edge cannot be in the future or long before this callback
+            int32_t error = (int32_t)(nowMicros - timestamp);
+            if (error < 0 || error > (int32_t)MAX_ANCHOR_ERROR_US) {
+                timestamp = nowMicros;
+                state.remainderTicks = 0;
+            }
+        } else {
+            state.anchored = true;
+            state.remainderTicks = 0;
+        }
+
+        state.lastCaptureTicks = ticks;
+        state.lastEventMicros = timestamp;
+
+        if (state.enabled && state.lockout.accept(timestamp)) {
+            int8_t direction = 1;
+            if (Config::PIN_B >= 0) {
+                direction = digitalRead(Config::PIN_B) == HIGH ? 1 : -1;
+            }
+            PulseEvent event = { timestamp, direction };
+            state.queue.push(event);
+        }
+        return false;  // No task woken
+    }
+
+public:
+    static const char* name() { return "MCPWM capture"; }
+    static uint32_t now() { return micros(); }
+
+    static void begin() {
+        pinMode(Pin, INPUT_PULLUP);
+        if (Config::PIN_B >= 0) {
+            pinMode(Config::PIN_B, INPUT_PULLUP);
+        }
+
+        mcpwm_gpio_init(mcpwmUnit(), (mcpwm_io_signals_t)(MCPWM_CAP_0 + Config::MCPWM_CAPTURE), Pin);
+
+        mcpwm_capture_config_t config = {};
+        config.cap_edge = MCPWM_NEG_EDGE;
+        config.cap_prescale = 1;
+        config.capture_cb = onCapture;
+        config.user_data = nullptr;
+        mcpwm_capture_enable_channel(mcpwmUnit(), (mcpwm_capture_channel_id_t)Config::MCPWM_CAPTURE, &config);
+    }
+
+    static void drain(PulseEstimator& estimator, uint32_t /* nowMicros */) {
+        PulseEvent event;
+        while (state.queue.pop(event)) {
+            estimator.recordPulse(event);
+        }
+    }
+
+    static void clear() { state.queue.clear(); }
+    static void setEnabled(bool enable) { state.enabled = enable; }
+    static bool isEnabled() { return state.enabled; }
+    static uint32_t getOverflowCount() { return state.queue.getOverflowCount(); }
+    static uint32_t getIllegalTransitionCount() { return 0; }
+};
+
+template <int Pin, typename Config>
+typename McpwmCaptureBackend<Pin, Config>::State McpwmCaptureBackend<Pin, Config>::state;
+
+#endif // ESP32
+
+// Maps a PulseBackendType to its implementation
+template <PulseBackendType Type, int Pin, typename Config>
+struct PulseBackendSelector;
+
+#if defined(ARDUINO)
+template <int Pin, typename Config>
+struct PulseBackendSelector<PULSE_BACKEND_GPIO_ISR, Pin, Config> {
+    typedef GpioIsrBackend<Pin, Config> type;
+};
+#endif
+
+#if defined(ESP32)
+template <int Pin, typename Config>
+struct PulseBackendSelector<PULSE_BACKEND_PCNT, Pin, Config> {
+    typedef PcntBackend<Pin, Config> type;
+};
+
+template <int Pin, typename Config>
+struct PulseBackendSelector<PULSE_BACKEND_MCPWM_CAPTURE, Pin, Config> {
+    typedef McpwmCaptureBackend<Pin, Config> type;
+};
+#endif
+
+template <int Pin, typename Config>
+struct PulseBackendSelector<PULSE_BACKEND_SIMULATED, Pin, Config> {
+    typedef SimulatedPulseBackend<Pin, Config> type;
+};
+
+#endif // PULSE_BACKENDS_H
@@ -0,0 +1,266 @@
+#include "PulseEstimator.h"
+
+PulseEstimator::PulseEstimator(int pulsesPerRev)
+	: pulseCount(0),
+	  signedPulseCount(0),
+	  direction(1),
+	  lastPulseMicros(0),
+	  lastUpdateMicros(0),
+	  countWindowStartMicros(0),
+	  pulsePeriods{0.0f},
+	  periodIndex(0),
+	  periodCount(0),
+	  pulsesPerRevolution(1),
+	  lastCalculationMicros(0),
+	  currentRPM(0.0f),
+	  filteredRPM(0.0f),
+	  lastPulseCountSnapshot(0),
+	  countedRPM(0.0f),
+	  estimationMode(RPM_MODE_PULSE_PERIOD),
+	  signalTimedOut(true) {
+    setPulsesPerRevolution(pulsesPerRev);
+}
+
+void PulseEstimator::recordPulse(const PulseEvent& event) {
+    uint32_t timestampMicros = event.timestampMicros;
+
+    // A reversal passes through zero speed: periods from the old direction say
+    // nothing about the new one, so start over and take the new sign immediately
+    if (event.direction != direction) {
+        direction = event.direction;
+        restartEstimation();
+    }
+
+    PulseFilterResult result = pulseFilter.accept(timestampMicros);
+    if (result == PULSE_REJECTED) {
+        return;
+    }
+    signedPulseCount += direction;
+
+    // Only trustworthy periods feed the average; outliers still count as pulses
+    if (result == PULSE_ACCEPTED) {
+        float correctedPeriod = toothCorrection.correct(pulseFilter.getLastPeriod());
+        speedTracker.update(60000000.0f / (correctedPeriod * (float)pulsesPerRevolution), timestampMicros);
+
+        pulsePeriods[periodIndex] = correctedPeriod;
+        periodIndex = (periodIndex + 1) % PERIOD_HISTORY_SIZE;
+        if (periodCount < PERIOD_HISTORY_SIZE) {
+            periodCount++;
+        }
+    } else if (pulseCount > 0) {
+        // Keep the tooth phase aligned: a gap spanning several expected periods means missed teeth
+        int teeth = 1;
+        uint32_t expectedPeriod = pulseFilter.getExpectedPeriod();
+        if (expectedPeriod > 0) {
+            uint32_t gap = timestampMicros - lastPulseMicros;
+            teeth = (int)((gap + expectedPeriod / 2) / expectedPeriod);
+            if (teeth < 1) {
+                teeth = 1;
+            }
+        }
+        toothCorrection.skip(teeth);
+    }
+    pulseCount++;
+    lastPulseMicros = timestampMicros;
+}
+
+void PulseEstimator::recordPulseCount(int32_t pulses, uint32_t nowMicros) {
+    if (pulses == 0) {
+        return;  // Overdue bound in update() handles slowing down
+    }
+
+    int8_t countDirection = pulses > 0 ? 1 : -1;
+    uint32_t magnitude = pulses > 0 ? pulses : -pulses;
+
+    if (countDirection != direction) {
+        direction = countDirection;
+        restartEstimation();
+    }
+
+    // Hardware counting has no individual timestamps: every pulse in the window
+    // gets the window's mean period. The first window after a reset is unanchored.
+    if (pulseCount > 0) {
+        float averagePeriod = (float)(nowMicros - countWindowStartMicros) / (float)magnitude;
+        speedTracker.update(60000000.0f / (averagePeriod * (float)pulsesPerRevolution), nowMicros);
+
+        pulsePeriods[periodIndex] = averagePeriod;
+        periodIndex = (periodIndex + 1) % PERIOD_HISTORY_SIZE;
+        if (periodCount < PERIOD_HISTORY_SIZE) {
+            periodCount++;
+        }
+    }
+
+    pulseCount += magnitude;
+    signedPulseCount += pulses;
+    lastPulseMicros = nowMicros;
+    countWindowStartMicros = nowMicros;
+}
+
+void PulseEstimator::update(uint32_t nowMicros) {
+    lastUpdateMicros = nowMicros;
+
+    // After a timeout the filter window and tracker describe a speed the shaft
+    // no longer has, so the first pulses after a stop would be judged against
+    // it. Tooth phase survives: the next edge is still the next tooth.
+    if (!isReceivingSignal()) {
+        if (!signalTimedOut) {
+            restartPeriods();
+            signalTimedOut = true;
+        }
+    } else {
+        signalTimedOut = false;
+    }
+
+    // The counting path always runs - period mode falls back to it at very low speed
+    updatePulseCount(nowMicros);
+
+    if (estimationMode == RPM_MODE_PULSE_PERIOD) {
+        updatePulsePeriod(nowMicros);
+    } else {
+        currentRPM = countedRPM;
+    }
+
+    updateFilteredRPM(nowMicros);
+}
+
+void PulseEstimator::updatePulseCount(uint32_t nowMicros) {
+    if (nowMicros - lastCalculationMicros >= RPM_CALCULATION_INTERVAL_US) {
+        unsigned long currentPulseCount = pulseCount;
+        uint32_t actualInterval = nowMicros - lastCalculationMicros;
+
+        // Handle potential counter overflow/underflow
+        unsigned long pulsesInInterval = 0;
+        if (currentPulseCount >= lastPulseCountSnapshot) {
+            // Normal case: counter incremented
+            pulsesInInterval = currentPulseCount - lastPulseCountSnapshot;
+        } else {
+            // Counter reset or overflow - assume small number of pulses
+            pulsesInInterval = currentPulseCount;
+        }
+
+        if (pulsesInInterval > 0 && actualInterval > 0) {
+            float pulsesPerMinute = (float)pulsesInInterval * (60000000.0f / (float)actualInterval);
+            float revolutionsPerMinute = pulsesPerMinute / (float)pulsesPerRevolution;
+
+            // Glitches were already rejected by pulseFilter, so only the low bound applies
+            if (revolutionsPerMinute < MIN_RPM_THRESHOLD) {
+                countedRPM = 0.0f;
+            } else {
+                countedRPM = revolutionsPerMinute;
+            }
+        } else if (!isReceivingSignal()) {
+            countedRPM = 0.0f;
+        }
+
+        lastPulseCountSnapshot = currentPulseCount;
+        lastCalculationMicros = nowMicros;
+    }
+}
+
+void PulseEstimator::updatePulsePeriod(uint32_t nowMicros) {
+    if (!isReceivingSignal()) {
+        currentRPM = 0.0f;
+        return;
+    }
+
+    if (periodCount == 0) {
+        // Not enough edges for a period yet - counting is all we have
+        currentRPM = countedRPM;
+        return;
+    }
+
+    float periodSum = 0.0f;
+    for (int i = 0; i < periodCount; i++) {
+        periodSum += pulsePeriods[i];
+    }
+    float averagePeriod = periodSum / (float)periodCount;
+
+    // If the shaft is overdue for its next pulse it must be slowing down;
+    // bound the estimate by the time elapsed so far instead of waiting for the edge
+    float sinceLastPulse = (float)(nowMicros - lastPulseMicros);
+    if (sinceLastPulse > averagePeriod) {
+        averagePeriod = sinceLastPulse;
+    }
+
+    float periodRPM = 60000000.0f / (averagePeriod * (float)pulsesPerRevolution);
+
+    if (periodRPM < PERIOD_MODE_MIN_RPM) {
+        // Very low speed - periods are too long to be timely, use counting instead
+        currentRPM = countedRPM;
+    } else {
+        currentRPM = periodRPM;
+    }
+}
+
+void PulseEstimator::updateFilteredRPM(uint32_t nowMicros) {
+    // The tracker only sees period measurements; outside period mode, or at
+    // counting-fallback speeds, pass the raw estimate straight through
+    if (estimationMode != RPM_MODE_PULSE_PERIOD || !speedTracker.isInitialized() ||
+        currentRPM < PERIOD_MODE_MIN_RPM) {
+        filteredRPM = currentRPM;
+        return;
+    }
+
+    float trackedRPM = speedTracker.getRPMAt(nowMicros);
+
+    // Same overdue bound as the raw estimate: if the next pulse is later than the
+    // tracked speed predicts, the shaft cannot be turning faster than that
+    float sinceLastPulse = (float)(nowMicros - lastPulseMicros);
+    float boundRPM = 60000000.0f / (sinceLastPulse * (float)pulsesPerRevolution);
+    filteredRPM = trackedRPM < boundRPM ? trackedRPM : boundRPM;
+}
+
+void PulseEstimator::restartPeriods() {
+    periodIndex = 0;
+    periodCount = 0;
+    pulseFilter.reset();
+    speedTracker.reset();
+}
+
+void PulseEstimator::restartEstimation() {
+    restartPeriods();
+    toothCorrection.reset();  // Tooth order runs backwards in reverse - relearn
+}
+
+bool PulseEstimator::isReceivingSignal() const {
+    // Basic pulse detection - shows any recent pulse activity as of the last update()
+    return (lastUpdateMicros - lastPulseMicros) < RPM_TIMEOUT_US;
+}
+
+bool PulseEstimator::isValidSignal() const {
+    // Filtered signal validation - requires stable RPM to be considered real
+    // This filters out electrical noise that creates sporadic low-rate pulses
+    return isReceivingSignal() && currentRPM >= MIN_STABLE_RPM;
+}
+
+void PulseEstimator::reset(uint32_t nowMicros) {
+    pulseCount = 0;
+    signedPulseCount = 0;
+    direction = 1;
+    lastPulseMicros = nowMicros - RPM_TIMEOUT_US;  // No signal until the first real pulse
+    lastUpdateMicros = nowMicros;
+    countWindowStartMicros = nowMicros;
+    restartEstimation();
+    signalTimedOut = true;
+    currentRPM = 0.0f;
+    filteredRPM = 0.0f;
+    countedRPM = 0.0f;
+    lastPulseCountSnapshot = 0;
+    lastCalculationMicros = nowMicros;
+}
+
+bool PulseEstimator::setPulsesPerRevolution(int pulses) {
+    if (pulses < 1 || pulses > ToothCorrection::MAX_TEETH) {
+        return false;
+    }
+
+    pulsesPerRevolution = pulses;
+    toothCorrection.setToothCount(pulses);
+    restartEstimation();
+    return true;
+}
+
+void PulseEstimator::setTrackerNoise(float jerkNoise, float measurementNoiseRPM) {
+    speedTracker.setJerkNoise(jerkNoise);
+    speedTracker.setMeasurementNoise(measurementNoiseRPM);
+}
@@ -0,0 +1,99 @@
+#ifndef PULSE_ESTIMATOR_H
+#define PULSE_ESTIMATOR_H
+
+#include <stdint.h>
+#include "PulseFilter.h"
+#include "ToothCorrection.h"
+#include "SpeedTracker.h"
+
+// How a pulse input is turned into RPM
+enum RPMEstimationMode {
+    RPM_MODE_PULSE_COUNT = 0,   // Count pulses over a fixed 1 second window
+    RPM_MODE_PULSE_PERIOD = 1   // Average the most recent inter-pulse periods (fresh estimate every pulse)
+};
+
+// One accepted edge as queued by an ISR
+struct PulseEvent {
+    uint32_t timestampMicros;
+    int8_t direction;           // +1 forward, -1 reverse (always +1 without a second channel)
+};
+
+// Loop-side RPM estimation for one pulse input: glitch filtering, tooth
+// correction, period averaging, counting fallback and tracking. All time comes
+// in as arguments, so it has no Arduino dependencies and can run on the host.
+class PulseEstimator {
+private:
+    static const int PERIOD_HISTORY_SIZE = 4;                      // Number of inter-pulse periods averaged
+    static const uint32_t RPM_CALCULATION_INTERVAL_US = 1000000;   // Counting window
+    static const uint32_t RPM_TIMEOUT_US = 3000000;
+    static constexpr float MIN_RPM_THRESHOLD = 1.0f;
+    static constexpr float MIN_STABLE_RPM = 50.0f;        // Minimum RPM to consider signal stable
+    static constexpr float PERIOD_MODE_MIN_RPM = 30.0f;   // Below this, period mode falls back to counting
+
+    unsigned long pulseCount;
+    long signedPulseCount;                    // Net pulses, reverse counts down
+    int8_t direction;                         // Direction of the most recent accepted pulse
+    uint32_t lastPulseMicros;
+    uint32_t lastUpdateMicros;
+    uint32_t countWindowStartMicros;          // Start of the current hardware count window
+    float pulsePeriods[PERIOD_HISTORY_SIZE];  // Circular buffer of tooth-corrected periods (microseconds)
+    int periodIndex;
+    int periodCount;
+    PulseFilter pulseFilter;                  // Glitch rejection on the timestamp stream
+    ToothCorrection toothCorrection;          // Per-tooth spacing correction for multi-tooth wheels
+    SpeedTracker speedTracker;                // Per-pulse speed/acceleration tracking filter
+    int pulsesPerRevolution;
+
+    uint32_t lastCalculationMicros;
+    float currentRPM;
+    float filteredRPM;                        // Tracker output, extrapolated to the last update()
+    unsigned long lastPulseCountSnapshot;
+    float countedRPM;                         // Result of the pulse counting path
+    RPMEstimationMode estimationMode;
+    bool signalTimedOut;                      // Period state was dropped at the last signal timeout
+
+    void updatePulseCount(uint32_t nowMicros);
+    void updatePulsePeriod(uint32_t nowMicros);
+    void updateFilteredRPM(uint32_t nowMicros);
+    void restartPeriods();
+    void restartEstimation();
+
+public:
+    explicit PulseEstimator(int pulsesPerRev = 1);
+
+    // Feed pulses in timestamp order, then call update() with the current time
+    void recordPulse(const PulseEvent& event);
+
+    // Feed a signed number of pulses counted in hardware since the previous call
+    void recordPulseCount(int32_t pulses, uint32_t nowMicros);
+
+    void update(uint32_t nowMicros);
+    void reset(uint32_t nowMicros);
+
+    // RPM values are signed: negative means the shaft is turning in reverse
+    float getRPM() const { return direction * currentRPM; }
+    float getFilteredRPM() const { return direction * filteredRPM; }       // Smoothed RPM for control
+    float getCountedRPM() const { return direction * countedRPM; }
+    float getAcceleration() const { return direction * speedTracker.getAcceleration(); }  // RPM per second
+    float getRPMVariance() const { return speedTracker.getVariance(); }    // Confidence of getFilteredRPM()
+    unsigned long getPulseCount() const { return pulseCount; }
+    long getSignedPulseCount() const { return signedPulseCount; }
+    int getDirection() const { return direction; }
+    uint32_t getMicrosSinceLastPulse() const { return lastUpdateMicros - lastPulseMicros; }
+    bool isReceivingSignal() const;        // Basic pulse detection (for debug)
+    bool isValidSignal() const;            // Filtered signal validation (for control)
+
+    // Configuration
+    void setEstimationMode(RPMEstimationMode mode) { estimationMode = mode; }
+    RPMEstimationMode getEstimationMode() const { return estimationMode; }
+    void setFilterMode(PulseFilterMode mode) { pulseFilter.setMode(mode); }
+    PulseFilterMode getFilterMode() const { return pulseFilter.getMode(); }
+    PulseFilter& getFilter() { return pulseFilter; }
+    const PulseFilter& getFilter() const { return pulseFilter; }
+    bool setPulsesPerRevolution(int pulses);
+    int getPulsesPerRevolution() const { return pulsesPerRevolution; }
+    const ToothCorrection& getToothCorrection() const { return toothCorrection; }
+    void setTrackerNoise(float jerkNoise, float measurementNoiseRPM);
+};
+
+#endif // PULSE_ESTIMATOR_H
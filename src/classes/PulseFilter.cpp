@@ -0,0 +1,172 @@
+#include "PulseFilter.h"
+
+PulseFilter::PulseFilter()
+	: mode(PULSE_FILTER_ADAPTIVE),
+	  fixedLockoutMicros(DEFAULT_FIXED_LOCKOUT_US),
+	  minPeriodFraction(DEFAULT_MIN_PERIOD_FRACTION),
+	  hampelThreshold(DEFAULT_HAMPEL_THRESHOLD),
+	  hasLastEdge(false),
+	  lastEdgeMicros(0),
+	  lastPeriod(0),
+	  window{0},
+	  windowIndex(0),
+	  windowCount(0),
+	  lastRawEdgeMicros(0),
+	  runSpacing(0),
+	  runLength(0),
+	  rejectedCount(0),
+	  outlierCount(0) {
+}
+
+PulseFilterResult PulseFilter::accept(uint32_t timestampMicros) {
+    if (!hasLastEdge) {
+        hasLastEdge = true;
+        lastEdgeMicros = timestampMicros;
+        lastRawEdgeMicros = timestampMicros;
+        return PULSE_ACCEPTED_NO_PERIOD;
+    }
+
+    uint32_t period = timestampMicros - lastEdgeMicros;
+    trackRun(timestampMicros);
+
+    if (period < ABSOLUTE_MIN_PERIOD_US) {
+        rejectedCount++;
+        return PULSE_REJECTED;
+    }
+
+    PulseFilterResult result;
+    if (mode == PULSE_FILTER_FIXED_LOCKOUT) {
+        result = (period > fixedLockoutMicros) ? PULSE_ACCEPTED : PULSE_REJECTED;
+    } else {
+        result = filterAdaptive(period);
+    }
+
+    if (result == PULSE_REJECTED) {
+        // Keep measuring from the last real edge so the next period is not split
+        rejectedCount++;
+        return result;
+    }
+
+    lastEdgeMicros = timestampMicros;
+    if (result == PULSE_ACCEPTED) {
+        lastPeriod = period;
+    }
+    return result;
+}
+
+PulseFilterResult PulseFilter::filterAdaptive(uint32_t period) {
+    if (windowCount == 0) {
+        pushWindow(period);
+        return PULSE_ACCEPTED;
+    }
+
+    uint32_t median = windowMedian();
+
+    // Speed-scaled lockout: an edge arriving well before the expected period is
+    // noise - unless it continues a steady run, in which case the shaft really
+    // sped up past the lockout and the window starts over from the run
+    if ((float)period < minPeriodFraction * (float)median) {
+        if (runLength < RESEED_RUN_LENGTH) {
+            return PULSE_REJECTED;
+        }
+        windowIndex = 0;
+        windowCount = 0;
+        pushWindow(runSpacing);
+        return PULSE_ACCEPTED_NO_PERIOD;
+    }
+
+    // Hampel test once the window is full. Outlying periods still enter the
+    // window so a genuine speed change is followed after a few pulses.
+    bool outlier = false;
+    if (windowCount == HAMPEL_WINDOW_SIZE) {
+        float sigma = MAD_TO_SIGMA * (float)windowMAD(median);
+        float minSigma = MIN_MAD_FRACTION * (float)median;
+        if (sigma < minSigma) {
+            sigma = minSigma;
+        }
+        float deviation = (float)period - (float)median;
+        if (deviation < 0) {
+            deviation = -deviation;
+        }
+        outlier = deviation > hampelThreshold * sigma;
+    }
+
+    pushWindow(period);
+
+    if (outlier) {
+        outlierCount++;
+        return PULSE_ACCEPTED_NO_PERIOD;
+    }
+    return PULSE_ACCEPTED;
+}
+
+void PulseFilter::pushWindow(uint32_t period) {
+    window[windowIndex] = period;
+    windowIndex = (windowIndex + 1) % HAMPEL_WINDOW_SIZE;
+    if (windowCount < HAMPEL_WINDOW_SIZE) {
+        windowCount++;
+    }
+}
+
+void PulseFilter::trackRun(uint32_t timestampMicros) {
+    uint32_t spacing = timestampMicros - lastRawEdgeMicros;
+    lastRawEdgeMicros = timestampMicros;
+
+    float change = (float)spacing - (float)runSpacing;
+    if (change < 0) {
+        change = -change;
+    }
+    if (runLength > 0 && change <= RUN_TOLERANCE * (float)runSpacing) {
+        runLength++;
+    } else {
+        runLength = 1;
+    }
+    runSpacing = spacing;
+}
+
+uint32_t PulseFilter::windowMedian() const {
+    // Insertion sort of a tiny copy is cheaper than anything cleverer at this size
+    uint32_t sorted[HAMPEL_WINDOW_SIZE];
+    for (int i = 0; i < windowCount; i++) {
+        uint32_t value = window[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    return sorted[windowCount / 2];
+}
+
+uint32_t PulseFilter::windowMAD(uint32_t median) const {
+    uint32_t sorted[HAMPEL_WINDOW_SIZE];
+    for (int i = 0; i < windowCount; i++) {
+        uint32_t value = window[i] > median ? window[i] - median : median - window[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    return sorted[windowCount / 2];
+}
+
+void PulseFilter::reset() {
+    hasLastEdge = false;
+    lastEdgeMicros = 0;
+    lastPeriod = 0;
+    windowIndex = 0;
+    windowCount = 0;
+    lastRawEdgeMicros = 0;
+    runSpacing = 0;
+    runLength = 0;
+}
+
+void PulseFilter::setMode(PulseFilterMode newMode) {
+    if (newMode != mode) {
+        mode = newMode;
+        reset();
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef PULSE_FILTER_H
+#define PULSE_FILTER_H
+
+#include <stdint.h>
+
+// Glitch rejection strategy for pulse edges
+enum PulseFilterMode {
+    PULSE_FILTER_FIXED_LOCKOUT = 0,  // Reject edges closer than a fixed lockout period
+    PULSE_FILTER_ADAPTIVE = 1        // Speed-scaled minimum period plus Hampel outlier rejection
+};
+
+// Verdict for a single edge
+enum PulseFilterResult {
+    PULSE_REJECTED = 0,           // Spurious edge - ignore it completely
+    PULSE_ACCEPTED_NO_PERIOD = 1, // Real edge, but its period is unusable (first edge or outlier)
+    PULSE_ACCEPTED = 2            // Real edge with a trustworthy period (see getLastPeriod())
+};
+
+// Filters a stream of edge timestamps (microseconds).
+// Pure logic with no Arduino dependencies so it can run on the host.
+class PulseFilter {
+private:
+    static const int HAMPEL_WINDOW_SIZE = 5;                  // Periods used for median/MAD
+    static const uint32_t DEFAULT_FIXED_LOCKOUT_US = 10000;   // Matches the original 10 ms lockout
+    static const uint32_t ABSOLUTE_MIN_PERIOD_US = 50;        // Nothing real is ever this fast
+    static constexpr float DEFAULT_MIN_PERIOD_FRACTION = 0.5f;
+    static constexpr float DEFAULT_HAMPEL_THRESHOLD = 3.0f;
+    static constexpr float MAD_TO_SIGMA = 1.4826f;            // Scales MAD to a normal standard deviation
+    static constexpr float MIN_MAD_FRACTION = 0.02f;          // MAD floor relative to the median
+    static const int RESEED_RUN_LENGTH = 4;                   // Evenly spaced edges that override the window
+    static constexpr float RUN_TOLERANCE = 0.25f;             // Spacing change that still continues a run
+
+    PulseFilterMode mode;
+    uint32_t fixedLockoutMicros;
+    float minPeriodFraction;      // Adaptive lockout as a fraction of the expected period
+    float hampelThreshold;        // Outlier threshold in robust standard deviations
+
+    bool hasLastEdge;
+    uint32_t lastEdgeMicros;
+    uint32_t lastPeriod;
+
+    uint32_t window[HAMPEL_WINDOW_SIZE];  // Recent periods, including outliers, so the window can follow real speed changes
+    int windowIndex;
+    int windowCount;
+
+    // Spacing of raw edges whatever their verdict: a run of evenly spaced
+    // edges is the shaft even when the window says they are too fast
+    uint32_t lastRawEdgeMicros;
+    uint32_t runSpacing;
+    int runLength;
+
+    uint32_t rejectedCount;
+    uint32_t outlierCount;
+
+    uint32_t windowMedian() const;
+    uint32_t windowMAD(uint32_t median) const;
+    void pushWindow(uint32_t period);
+    void trackRun(uint32_t timestampMicros);
+    PulseFilterResult filterAdaptive(uint32_t period);
+
+public:
+    PulseFilter();
+
+    // Classify an edge; accepted edges become the reference for the next period
+    PulseFilterResult accept(uint32_t timestampMicros);
+    void reset();
+
+    // Configuration
+    void setMode(PulseFilterMode newMode);
+    void setFixedLockoutMicros(uint32_t micros) { fixedLockoutMicros = micros; }
+    void setMinPeriodFraction(float fraction) { minPeriodFraction = fraction; }
+    void setHampelThreshold(float threshold) { hampelThreshold = threshold; }
+
+    // Getters
+    PulseFilterMode getMode() const { return mode; }
+    uint32_t getLastPeriod() const { return lastPeriod; }
+    uint32_t getExpectedPeriod() const { return windowCount > 0 ? windowMedian() : 0; }
+    uint32_t getRejectedCount() const { return rejectedCount; }
+    uint32_t getOutlierCount() const { return outlierCount; }
+};
+
+#endif // PULSE_FILTER_H
@@ -0,0 +1,153 @@
+#ifndef PULSE_MONITOR_H
+#define PULSE_MONITOR_H
+
+#include "config.h"
+#include "PulseEstimator.h"
+#include "PulseBackends.h"
+
+// Pulse input on a GPIO, parameterized at compile time.
+//
+// Each PulseMonitor<Pin, Config> instantiation gets its own acquisition
+// backend state (ISR trampolines, queue, hardware unit), so several sensors can
+// run side by side without virtual dispatch or a shared singleton. Create
+// exactly one object per instantiation.
+//
+// Time comes from the backend and messages go to the stream begin() and
+// printStatus() are handed (Serial on the target), so with the simulated
+// backend the monitor builds and runs on the host.
+//
+// Config must provide:
+//   static const PulseBackendType BACKEND;
+//   static const int PIN_B;                  // Quadrature B channel, -1 if not fitted
+//   static const int PULSES_PER_REV;
+//   static const size_t QUEUE_SIZE;          // Power of two
+//   static const uint32_t MIN_EDGE_SPACING_US;  // ISR-level ringing rejection
+//   static const char* name();
+// plus whatever the selected backend needs (see PulseBackends.h).
+template <int Pin, typename Config>
+class PulseMonitor : public PulseEstimator {
+public:
+    typedef typename PulseBackendSelector<Config::BACKEND, Pin, Config>::type Backend;
+
+    PulseMonitor() : PulseEstimator(Config::PULSES_PER_REV) {
+        Backend::setEnabled(true);  // Start enabled for testing/debug
+    }
+
+    template <typename Log>
+    void begin(Log& log) {
+        // Initialize all counters before enabling interrupt
+        reset();
+
+        // Start acquisition after initialization
+        Backend::begin();
+
+        log.print(Config::name());
+        log.print(": Initialized on GPIO ");
+        log.print(Pin);
+        log.print(" (");
+        log.print(getPulsesPerRevolution());
+        log.print(" pulses/rev, ");
+        log.print(Backend::name());
+        log.println(")");
+        if (hasDirectionSensing()) {
+            log.print(Config::name());
+            log.print(": Quadrature direction sensing on GPIO ");
+            log.println(Config::PIN_B);
+        }
+        log.print(Config::name());
+        log.print(": Estimation mode: ");
+        log.println(getEstimationMode() == RPM_MODE_PULSE_PERIOD ? "pulse period" : "pulse count");
+    }
+
+    void update() {
+        // Drain before taking the update time: an edge queued after an earlier
+        // micros() read would be "newer than now", and its age would wrap
+        Backend::drain(*this, Backend::now());
+        PulseEstimator::update(Backend::now());
+    }
+
+    void reset() {
+        Backend::clear();
+        PulseEstimator::reset(Backend::now());
+    }
+
+    // False, and nothing changed, if the count is out of range
+    bool setPulsesPerRevolution(int pulses) {
+        if (!PulseEstimator::setPulsesPerRevolution(pulses)) {
+            return false;
+        }
+        reset();
+        return true;
+    }
+
+    void setEnabled(bool enable) {
+        Backend::setEnabled(enable);
+        if (!enable) {
+            // When disabling, reset all counters to prevent stale readings
+            reset();
+        }
+    }
+
+    bool isEnabled() const { return Backend::isEnabled(); }
+    bool hasDirectionSensing() const { return Config::PIN_B >= 0; }
+    uint32_t getOverflowCount() const { return Backend::getOverflowCount(); }  // Pulses dropped by a full queue
+    uint32_t getIllegalTransitionCount() const { return Backend::getIllegalTransitionCount(); }
+
+    template <typename Log>
+    void printStatus(Log& out) {
+        out.print("=== ");
+        out.print(Config::name());
+        out.println(" Status ===");
+        out.print("Current RPM: ");
+        out.println(getRPM(), 1);
+        out.print("Counted RPM: ");
+        out.println(getCountedRPM(), 1);
+        out.print("Filtered RPM: ");
+        out.print(getFilteredRPM(), 1);
+        out.print(" (accel ");
+        out.print(getAcceleration(), 0);
+        out.println(" RPM/s)");
+        out.print("Backend: ");
+        out.println(Backend::name());
+        out.print("Mode: ");
+        out.println(getEstimationMode() == RPM_MODE_PULSE_PERIOD ? "Pulse period" : "Pulse count");
+        out.print("Total Pulses: ");
+        out.print(getPulseCount());
+        out.print(" (net ");
+        out.print(getSignedPulseCount());
+        out.println(")");
+        if (hasDirectionSensing()) {
+            out.print("Direction: ");
+            out.print(getDirection() > 0 ? "Forward" : "Reverse");
+            out.print(" (illegal transitions ");
+            out.print(getIllegalTransitionCount());
+            out.println(")");
+        }
+        out.print("Pulses/Rev: ");
+        out.print(getPulsesPerRevolution());
+        if (getPulsesPerRevolution() > 1) {
+            out.print(getToothCorrection().isLearned() ? " (spacing learned)" : " (learning spacing)");
+        }
+        out.println();
+        out.print("Signal Active: ");
+        out.println(isReceivingSignal() ? "Yes" : "No");
+        out.print("Valid Signal: ");
+        out.println(isValidSignal() ? "Yes" : "No");
+        out.print("Last Pulse: ");
+        out.print(getMicrosSinceLastPulse() / 1000UL);
+        out.println("ms ago");
+        out.print("Queue Overflows: ");
+        out.println(getOverflowCount());
+        out.print("Filter: ");
+        out.print(getFilterMode() == PULSE_FILTER_ADAPTIVE ? "Adaptive" : "Fixed lockout");
+        out.print(" (rejected ");
+        out.print(getFilter().getRejectedCount());
+        out.print(", outliers ");
+        out.print(getFilter().getOutlierCount());
+        out.println(")");
+        out.print("Enabled: ");
+        out.println(isEnabled() ? "Yes" : "No");
+    }
+};
+
+#endif // PULSE_MONITOR_H
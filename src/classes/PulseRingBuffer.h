@@ -0,0 +1,92 @@
+#ifndef PULSE_RING_BUFFER_H
+#define PULSE_RING_BUFFER_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// IRAM_ATTR comes from the ESP32 core; define it away so this header also builds on the host
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// Fixed-capacity single-producer/single-consumer ring buffer.
+// The producer (an ISR) calls push(), the consumer (the main loop) calls pop()/popBatch().
+// No locks or allocation: each index is only ever written by one side, and the
+// acquire/release ordering on head/tail publishes the slot contents.
+template <typename T, size_t Capacity>
+class PulseRingBuffer {
+private:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "PulseRingBuffer capacity must be a power of two");
+    static const uint32_t INDEX_MASK = Capacity - 1;
+
+    T buffer[Capacity];
+    std::atomic<uint32_t> head;           // Next slot to write (producer only)
+    std::atomic<uint32_t> tail;           // Next slot to read (consumer only)
+    std::atomic<uint32_t> overflowCount;  // Samples dropped because the buffer was full (producer only)
+
+public:
+    PulseRingBuffer() : head(0), tail(0), overflowCount(0) {}
+
+    // Producer side - safe to call from an ISR
+    inline IRAM_ATTR bool push(const T& value) {
+        uint32_t currentHead = head.load(std::memory_order_relaxed);
+        uint32_t currentTail = tail.load(std::memory_order_acquire);
+
+        if (currentHead - currentTail >= Capacity) {
+            overflowCount.store(overflowCount.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+            return false;
+        }
+
+        buffer[currentHead & INDEX_MASK] = value;
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& value) {
+        uint32_t currentTail = tail.load(std::memory_order_relaxed);
+        uint32_t currentHead = head.load(std::memory_order_acquire);
+
+        if (currentTail == currentHead) {
+            return false;
+        }
+
+        value = buffer[currentTail & INDEX_MASK];
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - drain up to maxCount samples in one pass, returns the number copied
+    size_t popBatch(T* out, size_t maxCount) {
+        uint32_t currentTail = tail.load(std::memory_order_relaxed);
+        uint32_t currentHead = head.load(std::memory_order_acquire);
+
+        size_t available = currentHead - currentTail;
+        size_t count = available < maxCount ? available : maxCount;
+
+        for (size_t i = 0; i < count; i++) {
+            out[i] = buffer[(currentTail + i) & INDEX_MASK];
+        }
+
+        tail.store(currentTail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side - discard everything currently queued
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const { return size() == 0; }
+    static size_t capacity() { return Capacity; }
+    uint32_t getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+};
+
+#endif // PULSE_RING_BUFFER_H
@@ -0,0 +1,25 @@
+#include "QuadratureDecoder.h"
+
+// Gray code sequence for forward rotation: 00 -> 01 -> 11 -> 10 -> 00
+const int8_t QuadratureDecoder::TRANSITIONS[16] = {
+     0,  1, -1, QuadratureDecoder::ILLEGAL,   // from 00
+    -1,  0, QuadratureDecoder::ILLEGAL,  1,   // from 01
+     1, QuadratureDecoder::ILLEGAL,  0, -1,   // from 10
+    QuadratureDecoder::ILLEGAL, -1,  1,  0    // from 11
+};
+
+QuadratureDecoder::QuadratureDecoder()
+	: state(0),
+	  quarterCount(0),
+	  direction(1),
+	  position(0),
+	  illegalCount(0) {
+}
+
+void QuadratureDecoder::reset(bool channelA, bool channelB) {
+    state = (channelA ? 2 : 0) | (channelB ? 1 : 0);
+    quarterCount = 0;
+    direction = 1;
+    position = 0;
+    illegalCount = 0;
+}
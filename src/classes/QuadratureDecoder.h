@@ -0,0 +1,74 @@
+#ifndef QUADRATURE_DECODER_H
+#define QUADRATURE_DECODER_H
+
+#include <stdint.h>
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// Table-driven decoder for a two-channel (A/B) quadrature signal.
+// Every legal transition moves the position by one quarter cycle; four in a row
+// in the same direction produce one signed pulse. A direction change restarts
+// the count, so a reversal is reported within four quarter cycles, and contact
+// bounce on a single channel can delay a pulse but never emit one. Illegal
+// transitions (both channels changing at once) are counted and ignored.
+// Pure logic with no Arduino dependencies so it can run on the host.
+class QuadratureDecoder {
+private:
+    static const int8_t ILLEGAL = 2;
+    static const int8_t TRANSITIONS[16];  // Indexed by (previous AB << 2) | current AB
+
+    uint8_t state;           // Last AB state (bit 1 = A, bit 0 = B)
+    int8_t quarterCount;     // Same-direction quarter cycles since the last pulse or reversal (-3..3)
+    int8_t direction;        // Direction of the most recent legal transition (+1/-1)
+    int32_t position;        // Net full cycles since reset
+    uint32_t illegalCount;
+
+public:
+    QuadratureDecoder();
+
+    // Feed the current channel levels; returns +1/-1 when a full cycle completes, otherwise 0
+    inline IRAM_ATTR int8_t update(bool channelA, bool channelB) {
+        uint8_t current = (channelA ? 2 : 0) | (channelB ? 1 : 0);
+        int8_t step = TRANSITIONS[(state << 2) | current];
+        state = current;
+
+        if (step == ILLEGAL) {
+            illegalCount++;
+            return 0;
+        }
+        if (step == 0) {
+            return 0;
+        }
+
+        // Direction follows the very first transition of a reversal, and the
+        // quarters counted the other way no longer lead to a pulse
+        if (step != direction) {
+            direction = step;
+            quarterCount = 0;
+        }
+        quarterCount += step;
+
+        if (quarterCount >= 4) {
+            quarterCount = 0;
+            position++;
+            return 1;
+        }
+        if (quarterCount <= -4) {
+            quarterCount = 0;
+            position--;
+            return -1;
+        }
+        return 0;
+    }
+
+    void reset(bool channelA, bool channelB);
+
+    // Getters
+    int8_t getDirection() const { return direction; }
+    int32_t getPosition() const { return position; }
+    uint32_t getIllegalCount() const { return illegalCount; }
+};
+
+#endif // QUADRATURE_DECODER_H
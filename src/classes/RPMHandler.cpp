@@ -1,44 +1,54 @@
 #include "RPMHandler.h"
 #include <Arduino.h>
 
-// 1970 MGB Three-speed manual transmission ratios
-const float RPMHandler::TRANSMISSION_RATIOS[5] = {
-    3.44f,  // Reverse gear
-    3.44f,  // 1st gear
-    2.21f,  // 2nd gear
-    1.37f,  // 3rd gear
-    1.0f    // Not used (placeholder)
-};
-
-RPMHandler::RPMHandler(GearIndicator* gearInd, SpeedometerWheel* speedo, DriveshaftMonitor* driveshaft)
+RPMHandler::RPMHandler(GearIndicator* gearInd, SpeedometerWheel* speedo, DriveshaftMonitor* driveshaft,
+                       Odometer* odo)
 	: gearIndicator(gearInd),
 	  speedometer(speedo),
 	  driveshaftMonitor(driveshaft),
+	  odometer(odo),
 	  currentGear(NEUTRAL),
-	  candidateGear(NEUTRAL),
 	  currentSpeed(0),
 	  lastEngineRPM(0.0f),
 	  lastDriveshaftRPM(0.0f),
-	  lastValidGearTime(0),
-	  candidateGearStartTime(0) {
+	  parameters(defaultVehicleParameters<ActiveVehicleProfile>()),
+	  classifierMode(DEFAULT_GEAR_CLASSIFIER),
+	  timedClassifier(&factors),
+	  hmmClassifier(parameters.transmissionRatios),
+	  ratioLearningEnabled(true) {
+    updateFactors();
+    timedClassifier.setStabilityTimeout(parameters.gearStabilityTimeoutMs);
+    ratioLearner.reset(parameters.transmissionRatios);
 }
 
-void RPMHandler::update(float engineRPM, float driveshaftRPM) {
+void RPMHandler::update(float engineRPM, float driveshaftRPM, EngineRPMSource source) {
     lastEngineRPM = engineRPM;
     lastDriveshaftRPM = driveshaftRPM;
     unsigned long currentTime = millis();
 
-    // Calculate speed from driveshaft RPM
-    int newSpeed = calculateSpeedFromDriveshaftRPM(driveshaftRPM);
+    // Refine the ratio table from steady driving before classifying. An estimated
+    // engine speed is the driveshaft times an assumed ratio, so learning from it
+    // would pull that gear's ratio towards the assumption.
+    bool measured = source == ENGINE_RPM_CAN || source == ENGINE_RPM_TACH;
+    if (ratioLearningEnabled && measured && ratioLearner.observe(engineRPM, driveshaftRPM)) {
+        applyLearnedRatios();
+    }
 
-    // Detect potential gear based on RPM ratios
-    Gear detectedGear = calculateOptimalGear(engineRPM, driveshaftRPM);
+    // Calculate speed from driveshaft RPM
+    float newSpeed = calculateSpeedFromDriveshaftRPM(driveshaftRPM);
 
-    // Evaluate gear stability with timing logic
-    Gear confirmedGear = evaluateGearStability(detectedGear, currentTime);
+    Gear confirmedGear;
+    if (classifierMode == GEAR_CLASSIFIER_HMM) {
+        // Probabilistic classifier confirms as soon as it is confident
+        confirmedGear = hmmClassifier.update(engineRPM, driveshaftRPM, currentTime);
+    } else {
+        // Ratio inside a gear's window, held for the stability timeout
+        confirmedGear = timedClassifier.update(engineRPM, driveshaftRPM, currentTime);
+    }
 
-    // Update speed if changed significantly (avoid micro-adjustments)
-    if (abs(newSpeed - currentSpeed) > 1) {
+    // Update speed once it moves past the hysteresis band (avoids chasing sensor
+    // jitter); a zero band follows every step the needle can resolve
+    if (fabsf(newSpeed - currentSpeed) > parameters.speedHysteresisMph) {
         currentSpeed = newSpeed;
         if (speedometer) {
             speedometer->moveToMPH(currentSpeed);
@@ -64,107 +74,122 @@ void RPMHandler::update(float engineRPM, float driveshaftRPM) {
     }
 }
 
-void RPMHandler::update(float engineRPM) {
+void RPMHandler::update(float engineRPM, EngineRPMSource source) {
     // Use DriveshaftMonitor for automatic driveshaft RPM reading
     if (driveshaftMonitor) {
-        float driveshaftRPM = driveshaftMonitor->getRPM();
-        update(engineRPM, driveshaftRPM);
+        float driveshaftRPM = driveshaftMonitor->getFilteredRPM();
+        update(engineRPM, driveshaftRPM, source);
     } else {
         // Fallback: use last known driveshaft RPM
-        update(engineRPM, lastDriveshaftRPM);
+        update(engineRPM, lastDriveshaftRPM, source);
     }
 }
 
-Gear RPMHandler::calculateOptimalGear(float engineRPM, float driveshaftRPM) {
-    // Handle special cases - low RPM indicates neutral or stopped
-    if (engineRPM < 100.0f || abs(driveshaftRPM) < 10.0f) {
-        return NEUTRAL;
+float RPMHandler::calculateSpeedFromDriveshaftRPM(float driveshaftRPM) {
+    // The needle shows road speed in either direction
+    driveshaftRPM = abs(driveshaftRPM);
+    if (driveshaftRPM <= 0) {
+        return 0.0f;
     }
 
-    // Calculate actual transmission ratio from RPM readings
-    float actualRatio = engineRPM / (abs(driveshaftRPM) * DIFFERENTIAL_RATIO);
+    // Differential, tire circumference and unit conversion are folded into one
+    // factor whenever the parameters change
+#if USE_FIXED_POINT_MATH
+    return Q16::toFloat(Q16::mul(Q16::fromFloat(driveshaftRPM), factors.mphPerDriveshaftRPMFixed));
+#else
+    return driveshaftRPM * factors.mphPerDriveshaftRPM;
+#endif
+}
 
-    // Check reverse gear (if driveshaft is negative)
-    if (driveshaftRPM < 0 && isGearRatioValid(actualRatio, REVERSE)) {
-        return REVERSE;
+float RPMHandler::calculateExpectedEngineRPM(Gear gear, float driveshaftRPM) {
+    if (gear == NEUTRAL || driveshaftRPM <= 0) {
+        return 0.0f;
     }
 
-    // Check forward gears 1-3
-    for (int i = GEAR_1; i <= GEAR_3; i++) {
-        if (isGearRatioValid(actualRatio, static_cast<Gear>(i))) {
-            return static_cast<Gear>(i);
-        }
-    }
+    return driveshaftRPM * factors.enginePerDriveshaft[gear];
+}
 
-    // No valid gear ratio found - likely shifting or clutch disengaged
-    return NEUTRAL;
+void RPMHandler::applyParameters(const VehicleParameters& updated) {
+    parameters = updated;
+    updateFactors();
+    timedClassifier.setStabilityTimeout(parameters.gearStabilityTimeoutMs);
+    hmmClassifier.setRatios(parameters.transmissionRatios);
+    hmmClassifier.reset();
+    ratioLearner.reset(parameters.transmissionRatios);
 }
 
-Gear RPMHandler::evaluateGearStability(Gear detectedGear, unsigned long currentTime) {
-    // If detected gear matches candidate, continue timing
-    if (detectedGear == candidateGear) {
-        // Check if gear has been stable long enough
-        if (currentTime - candidateGearStartTime >= GEAR_STABILITY_TIMEOUT_MS) {
-            lastValidGearTime = currentTime;
-            return candidateGear;  // Confirm this gear
+void RPMHandler::applyLearnedRatios() {
+    // Learned ratios replace the working table; getParameters() then carries
+    // them, so ParameterBlock::save() can persist what was learned
+    const float* learned = ratioLearner.getLearnedRatios();
+    for (int i = 0; i < GEAR_COUNT; i++) {
+        if (i != NEUTRAL) {
+            parameters.transmissionRatios[i] = learned[i];
         }
-        // Still timing this candidate gear
-        return currentGear;  // Keep current gear until confirmed
     }
+    updateFactors();
+    hmmClassifier.setRatios(parameters.transmissionRatios);
+}
 
-    // New gear detected - start timing
-    candidateGear = detectedGear;
-    candidateGearStartTime = currentTime;
+void RPMHandler::updateFactors() {
+    deriveVehicleFactors(parameters, factors);
 
-    // If we haven't had a valid gear for too long, default to neutral
-    if (currentTime - lastValidGearTime > GEAR_STABILITY_TIMEOUT_MS) {
-        return NEUTRAL;
+    // The odometer integrates revolutions, so it needs the same tire and
+    // differential as the needle or the two drift apart
+    if (odometer) {
+        odometer->setMilesPerRevolution(factors.mphPerDriveshaftRPM / 60.0f);
     }
-
-    // Keep current gear until new one is confirmed
-    return currentGear;
 }
 
-bool RPMHandler::isGearRatioValid(float actualRatio, Gear gear) {
-    if (gear < REVERSE || gear > GEAR_3) {
-        return false;
+void RPMHandler::setDifferentialRatio(float ratio) {
+    if (ratio <= 0.0f) {
+        Serial.println("RPMHandler: Invalid differential ratio: " + String(ratio, 3));
+        return;
     }
-
-    float expectedRatio = TRANSMISSION_RATIOS[gear];
-    float difference = abs(actualRatio - expectedRatio);
-
-    return difference <= GEAR_RATIO_TOLERANCE;
+    parameters.differentialRatio = ratio;
+    applyParameters(parameters);
 }
 
-int RPMHandler::calculateSpeedFromDriveshaftRPM(float driveshaftRPM) {
-    if (driveshaftRPM <= 0) {
-        return 0;
+void RPMHandler::setTireDiameter(float inches) {
+    if (inches <= 0.0f) {
+        Serial.println("RPMHandler: Invalid tire diameter: " + String(inches, 1));
+        return;
     }
+    parameters.tireDiameterInches = inches;
+    applyParameters(parameters);
+}
 
-    // Calculate wheel RPM from driveshaft RPM
-    float wheelRPM = driveshaftRPM / DIFFERENTIAL_RATIO;
-
-    // Calculate tire circumference in inches
-    float tireCircumference = PI * TIRE_DIAMETER_INCHES;
-
-    // Calculate speed in MPH
-    // (wheel RPM) * (circumference in inches) * (minutes/hour) / (inches/mile)
-    float speedMPH = (wheelRPM * tireCircumference * MINUTES_PER_HOUR) / INCHES_PER_MILE;
+void RPMHandler::setTransmissionRatio(Gear gear, float ratio) {
+    if (gear < REVERSE || gear >= GEAR_COUNT || gear == NEUTRAL || ratio < 0.0f) {
+        Serial.println("RPMHandler: Invalid transmission ratio for gear " + String((int)gear));
+        return;
+    }
+    parameters.transmissionRatios[gear] = ratio;
+    applyParameters(parameters);
+}
 
-    return (int)round(speedMPH);
+void RPMHandler::setGearStabilityTimeout(unsigned long ms) {
+    parameters.gearStabilityTimeoutMs = ms;
+    timedClassifier.setStabilityTimeout(ms);
 }
 
-float RPMHandler::calculateExpectedEngineRPM(Gear gear, float driveshaftRPM) {
-    if (gear == NEUTRAL || driveshaftRPM <= 0) {
-        return 0.0f;
+void RPMHandler::setGearClassifierMode(GearClassifierMode mode) {
+    if (mode == classifierMode) {
+        return;
     }
+    classifierMode = mode;
 
-    return driveshaftRPM * DIFFERENTIAL_RATIO * TRANSMISSION_RATIOS[gear];
+    // Start the newly selected classifier from the currently shown gear's evidence
+    hmmClassifier.reset();
+    timedClassifier.reset(currentGear, millis());
+
+    Serial.println(String("RPMHandler: Gear classifier ") +
+                   (mode == GEAR_CLASSIFIER_HMM ? "HMM" : "timed"));
 }
 
 float RPMHandler::getTransmissionRatio(Gear gear) const {
-    if (gear >= REVERSE && gear <= GEAR_3) {
-        return TRANSMISSION_RATIOS[gear];
+    if (gear >= REVERSE && gear < GEAR_COUNT) {
+        return parameters.transmissionRatios[gear];
     }
     return 1.0f;  // Default for invalid gear
 }
@@ -174,26 +199,52 @@ void RPMHandler::printStatus() {
     Serial.print("Current Gear: ");
     Serial.println(GEAR_NAMES[currentGear]);
     Serial.print("Current Speed: ");
-    Serial.print(currentSpeed);
-    Serial.println(" MPH");
+    Serial.print(currentSpeed, 1);
+    Serial.print(" MPH (hysteresis ");
+    Serial.print(parameters.speedHysteresisMph, 2);
+    Serial.println(" MPH)");
+    Serial.print("Gear Classifier: ");
+    Serial.println(classifierMode == GEAR_CLASSIFIER_HMM ? "HMM" : "Timed");
+    if (classifierMode == GEAR_CLASSIFIER_HMM) {
+        Serial.print("Gear Confidence: ");
+        Serial.println(hmmClassifier.getProbability(currentGear), 3);
+    }
     Serial.print("Engine RPM: ");
     Serial.println(lastEngineRPM);
     Serial.print("Driveshaft RPM: ");
     Serial.println(lastDriveshaftRPM);
+    Serial.print("Vehicle Profile: ");
+    Serial.println(ActiveVehicleProfile::NAME);
     Serial.print("Differential Ratio: ");
-    Serial.println(DIFFERENTIAL_RATIO);
+    Serial.println(parameters.differentialRatio);
     Serial.print("Tire Diameter: ");
-    Serial.print(TIRE_DIAMETER_INCHES);
+    Serial.print(parameters.tireDiameterInches);
     Serial.println(" inches");
 
     Serial.println("Transmission Ratios:");
-    Serial.print("  Reverse: ");
-    Serial.println(TRANSMISSION_RATIOS[REVERSE]);
-    Serial.print("  1st: ");
-    Serial.println(TRANSMISSION_RATIOS[GEAR_1]);
-    Serial.print("  2nd: ");
-    Serial.println(TRANSMISSION_RATIOS[GEAR_2]);
-    Serial.print("  3rd: ");
-    Serial.println(TRANSMISSION_RATIOS[GEAR_3]);
+    for (int i = REVERSE; i < GEAR_COUNT; i++) {
+        if (parameters.transmissionRatios[i] > 0.0f) {
+            Serial.print("  ");
+            Serial.print(GEAR_NAMES[i]);
+            Serial.print(": ");
+            Serial.println(parameters.transmissionRatios[i]);
+        }
+    }
     Serial.println("========================");
-}
\ No newline at end of file
+}
+
+void RPMHandler::printLearningReport() {
+    Serial.println("=== Gear Ratio Learning ===");
+    Serial.println("Learning: " + String(ratioLearningEnabled ? "Enabled" : "Disabled"));
+    for (int i = REVERSE; i < GEAR_COUNT; i++) {
+        Gear gear = static_cast<Gear>(i);
+        if (ratioLearner.getNominalRatio(gear) <= 0.0f) {
+            continue;
+        }
+        Serial.println("  " + String(GEAR_NAMES[i]) + ": nominal " + String(ratioLearner.getNominalRatio(gear), 3) +
+                       ", learned " + String(ratioLearner.getLearnedRatio(gear), 3) +
+                       " (" + String(ratioLearner.getDeviation(gear) * 100.0f, 1) + "%, " +
+                       String(ratioLearner.getSampleCount(gear)) + " samples)");
+    }
+    Serial.println("===========================");
+}
@@ -5,64 +5,98 @@
 #include "GearIndicator.h"
 #include "SpeedometerWheel.h"
 #include "DriveshaftMonitor.h"
+#include "Odometer.h"
+#include "HmmGearClassifier.h"
+#include "TimedGearClassifier.h"
+#include "VehicleProfile.h"
+#include "VehicleParameters.h"
+#include "GearRatioLearner.h"
 
+enum GearClassifierMode {
+    GEAR_CLASSIFIER_TIMED,  // Ratio within a fixed tolerance, held for the gear stability timeout
+    GEAR_CLASSIFIER_HMM     // Hidden Markov model, confirms when the posterior crosses a threshold
+};
+
+// Where the engine RPM passed to update() came from. Only measured engine
+// speed trains the ratio learner.
+enum EngineRPMSource {
+    ENGINE_RPM_NONE,
+    ENGINE_RPM_CAN,
+    ENGINE_RPM_TACH,
+    ENGINE_RPM_ESTIMATED    // Assumed from the driveshaft, carries no gear information
+};
+
+// Speed and gear detection. The active vehicle profile (see VehicleProfile.h)
+// supplies the default parameters; runtime values come from applyParameters().
 class RPMHandler {
 private:
     GearIndicator* gearIndicator;
     SpeedometerWheel* speedometer;
     DriveshaftMonitor* driveshaftMonitor;
-
-    // 1970 MGB Three-speed manual transmission specifications
-    static const float TRANSMISSION_RATIOS[5];  // Index 0=Reverse, 1=1st, 2=2nd, 3=3rd, 4=Not used
-    static constexpr float DIFFERENTIAL_RATIO = 3.9f;      // 1970 MGB differential ratio
-    static constexpr float TIRE_DIAMETER_INCHES = 23.0f;   // Approximate for 165-80R13 tires
+    Odometer* odometer;         // Distance per revolution follows the speed factor
 
     // Internal state
     Gear currentGear;
-    Gear candidateGear;          // Gear being evaluated for stability
-    int currentSpeed;
+    float currentSpeed;         // MPH last sent to the speedometer
     float lastEngineRPM;
     float lastDriveshaftRPM;
 
-    // Gear stability tracking
-    static const unsigned long GEAR_STABILITY_TIMEOUT_MS = 750;  // Time to confirm gear
-    static constexpr float GEAR_RATIO_TOLERANCE = 0.3f;          // Tolerance for gear detection
-    unsigned long lastValidGearTime;
-    unsigned long candidateGearStartTime;
+    // Vehicle parameters and the factors derived from them
+    VehicleParameters parameters;
+    VehicleFactors factors;
+
+    // Gear classification strategy
+    GearClassifierMode classifierMode;
+    TimedGearClassifier timedClassifier;   // Confirmation time is parameters.gearStabilityTimeoutMs
+    HmmGearClassifier hmmClassifier;
 
-    // Conversion constants
-    static constexpr float INCHES_PER_MILE = 63360.0f;
-    static constexpr float MINUTES_PER_HOUR = 60.0f;
+    // Online ratio learning
+    GearRatioLearner ratioLearner;
+    bool ratioLearningEnabled;
+    void applyLearnedRatios();
+    void updateFactors();       // Re-derive the factors and push them to the odometer
 
     // Helper methods
-    Gear calculateOptimalGear(float engineRPM, float driveshaftRPM);
-    Gear evaluateGearStability(Gear detectedGear, unsigned long currentTime);
-    bool isGearRatioValid(float actualRatio, Gear gear);
-    int calculateSpeedFromDriveshaftRPM(float driveshaftRPM);
+    float calculateSpeedFromDriveshaftRPM(float driveshaftRPM);
     float calculateExpectedEngineRPM(Gear gear, float driveshaftRPM);
 
 public:
-    RPMHandler(GearIndicator* gearInd, SpeedometerWheel* speedo, DriveshaftMonitor* driveshaft = nullptr);
+    RPMHandler(GearIndicator* gearInd, SpeedometerWheel* speedo, DriveshaftMonitor* driveshaft = nullptr,
+               Odometer* odo = nullptr);
 
     // Main update method - call this regularly with current RPM values
-    void update(float engineRPM, float driveshaftRPM);
+    void update(float engineRPM, float driveshaftRPM, EngineRPMSource source);
 
     // Overloaded update method that uses DriveshaftMonitor for automatic driveshaft RPM
-    void update(float engineRPM);
+    void update(float engineRPM, EngineRPMSource source);
+
+    // Configuration methods - take effect immediately; persist through ParameterBlock::save()
+    void applyParameters(const VehicleParameters& updated);
+    const VehicleParameters& getParameters() const { return parameters; }
+    const VehicleFactors& getFactors() const { return factors; }
+    void setDifferentialRatio(float ratio);
+    void setTireDiameter(float inches);
+    void setTransmissionRatio(Gear gear, float ratio);
+    void setGearStabilityTimeout(unsigned long ms);
+    void setSpeedHysteresis(float mph) { parameters.speedHysteresisMph = mph >= 0.0f ? mph : 0.0f; }
 
-    // Configuration methods
-    void setDifferentialRatio(float ratio) { /* Not implemented - const for MGB */ }
-    void setTireDiameter(float inches) { /* Not implemented - const for MGB */ }
+    void setGearClassifierMode(GearClassifierMode mode);
+    void setRatioLearningEnabled(bool enable) { ratioLearningEnabled = enable; }
+    bool isRatioLearningEnabled() const { return ratioLearningEnabled; }
+    const GearRatioLearner& getRatioLearner() const { return ratioLearner; }
+    GearClassifierMode getGearClassifierMode() const { return classifierMode; }
 
     // Getters
     Gear getCurrentGear() const { return currentGear; }
-    int getCurrentSpeed() const { return currentSpeed; }
-    float getDifferentialRatio() const { return DIFFERENTIAL_RATIO; }
-    float getTireDiameter() const { return TIRE_DIAMETER_INCHES; }
+    float getCurrentSpeed() const { return currentSpeed; }
+    float getDifferentialRatio() const { return parameters.differentialRatio; }
+    float getTireDiameter() const { return parameters.tireDiameterInches; }
+    const char* getProfileName() const { return ActiveVehicleProfile::NAME; }
     float getTransmissionRatio(Gear gear) const;
 
     // Utility methods
     void printStatus();
+    void printLearningReport();   // Learned versus nominal gear ratios
 };
 
 #endif // RPM_HANDLER_H
\ No newline at end of file
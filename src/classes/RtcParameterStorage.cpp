@@ -0,0 +1,28 @@
+#include "RtcParameterStorage.h"
+
+#if defined(ESP32)
+#include "esp_attr.h"
+#else
+#define RTC_NOINIT_ATTR
+#endif
+
+static RTC_NOINIT_ATTR uint32_t rtcStoredLength;
+static RTC_NOINIT_ATTR uint8_t rtcBuffer[RtcParameterStorage::CAPACITY];
+
+bool RtcParameterStorage::read(void* data, size_t length) {
+    // rtcStoredLength is garbage after power-on, so range-check it too
+    if (length == 0 || length > CAPACITY || rtcStoredLength != length) {
+        return false;
+    }
+    memcpy(data, rtcBuffer, length);
+    return true;
+}
+
+bool RtcParameterStorage::write(const void* data, size_t length) {
+    if (length == 0 || length > CAPACITY) {
+        return false;
+    }
+    memcpy(rtcBuffer, data, length);
+    rtcStoredLength = length;
+    return true;
+}
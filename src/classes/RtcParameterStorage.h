@@ -0,0 +1,18 @@
+#ifndef RTC_PARAMETER_STORAGE_H
+#define RTC_PARAMETER_STORAGE_H
+
+#include "ParameterStorage.h"
+
+// Blob in ESP32 RTC slow memory that the bootloader leaves alone, so it
+// survives software, panic, watchdog and brownout resets but not power loss.
+// After power-on the contents are garbage - callers must check their own CRC.
+// Backed by one static buffer, so create a single instance.
+class RtcParameterStorage : public ParameterStorage {
+public:
+    static const size_t CAPACITY = 64;
+
+    bool read(void* data, size_t length);
+    bool write(const void* data, size_t length);
+};
+
+#endif // RTC_PARAMETER_STORAGE_H
@@ -0,0 +1,79 @@
+#ifndef SIMULATED_PULSE_BACKEND_H
+#define SIMULATED_PULSE_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "EdgeLockout.h"
+#include "PulseRingBuffer.h"
+#include "PulseEstimator.h"
+
+// Pulse acquisition backend with no hardware behind it. Pulses are injected by
+// code (a synthetic pulse train, a replayed log, a bench demo) through the same
+// queue and drain interface as the real backends, so everything above the
+// backend runs unchanged. Time is a clock the caller sets, one per
+// instantiation. Has no Arduino dependencies and builds on the host.
+template <int Pin, typename Config>
+class SimulatedPulseBackend {
+private:
+    struct State {
+        PulseRingBuffer<PulseEvent, Config::QUEUE_SIZE> queue;
+        EdgeLockout<Config::MIN_EDGE_SPACING_US> lockout;
+        volatile int32_t pendingCount;   // Hardware-style counts waiting for drain()
+        volatile bool enabled;
+        uint32_t nowMicros;
+    };
+    static State state;
+
+public:
+    static const char* name() { return "simulated"; }
+
+    static uint32_t now() { return state.nowMicros; }
+    static void setTime(uint32_t micros) { state.nowMicros = micros; }
+
+    static void begin() {}
+
+    // Inject one timestamped edge, as a GPIO or capture backend would: false
+    // if it was dropped (disabled, ringing inside MIN_EDGE_SPACING_US, or a full queue)
+    static bool injectPulse(uint32_t timestampMicros, int8_t direction = 1) {
+        if (!state.enabled || !state.lockout.accept(timestampMicros)) {
+            return false;
+        }
+        PulseEvent event = { timestampMicros, direction };
+        return state.queue.push(event);
+    }
+
+    // Inject a signed pulse count, as the PCNT backend would (single-threaded use only)
+    static void injectCount(int32_t pulses) {
+        if (state.enabled) {
+            state.pendingCount = state.pendingCount + pulses;
+        }
+    }
+
+    static void drain(PulseEstimator& estimator, uint32_t nowMicros) {
+        PulseEvent event;
+        while (state.queue.pop(event)) {
+            estimator.recordPulse(event);
+        }
+
+        int32_t pulses = state.pendingCount;
+        if (pulses != 0) {
+            state.pendingCount = 0;
+            estimator.recordPulseCount(pulses, nowMicros);
+        }
+    }
+
+    static void clear() {
+        state.queue.clear();
+        state.pendingCount = 0;
+    }
+
+    static void setEnabled(bool enable) { state.enabled = enable; }
+    static bool isEnabled() { return state.enabled; }
+    static uint32_t getOverflowCount() { return state.queue.getOverflowCount(); }
+    static uint32_t getIllegalTransitionCount() { return 0; }
+};
+
+template <int Pin, typename Config>
+typename SimulatedPulseBackend<Pin, Config>::State SimulatedPulseBackend<Pin, Config>::state;
+
+#endif // SIMULATED_PULSE_BACKEND_H
@@ -0,0 +1,78 @@
+#ifndef SIMULATED_STEP_TIMER_H
+#define SIMULATED_STEP_TIMER_H
+
+#include <stdint.h>
+#include "HardwareStepTimer.h"
+
+// Step timer with no hardware behind it: the caller advances simulated time
+// and every tick that would have fired by then runs in order. Same interface
+// as HardwareStepTimer, so a step schedule can be checked against the motion
+// profile on the host. Has no Arduino dependencies.
+class SimulatedStepTimer {
+private:
+    StepTickCallback callback;
+    void* context;
+    uint32_t intervalMicros;
+    uint32_t periodStartMicros;   // Last tick, or begin(): where the hardware counter reloaded to 0
+    uint32_t nextTickMicros;
+    uint32_t lastTickMicros;
+    uint32_t nowMicros;
+    uint32_t tickCount;
+    bool running;
+
+public:
+    SimulatedStepTimer()
+        : callback(0), context(0), intervalMicros(0), periodStartMicros(0), nextTickMicros(0), lastTickMicros(0),
+          nowMicros(0), tickCount(0), running(false) {}
+
+    bool begin(StepTickCallback tickCallback, void* tickContext, uint32_t interval, uint32_t startMicros = 0) {
+        callback = tickCallback;
+        context = tickContext;
+        intervalMicros = interval;
+        nowMicros = startMicros;
+        periodStartMicros = startMicros;
+        nextTickMicros = startMicros + interval;
+        running = interval > 0;
+        return running;
+    }
+
+    // Applies to the period in progress, as HardwareStepTimer::setInterval()
+    // does: a period that has already outlasted the new interval ends shortly
+    void setInterval(uint32_t interval) {
+        intervalMicros = interval;
+        nextTickMicros = periodStartMicros + interval;
+        if ((int32_t)(nowMicros + HardwareStepTimer::REARM_MARGIN_US - nextTickMicros) > 0) {
+            nextTickMicros = nowMicros + HardwareStepTimer::REARM_MARGIN_US;
+        }
+    }
+    void stop() { running = false; }
+    bool isRunning() const { return running; }
+
+    // As HardwareStepTimer::getPeriodFraction()
+    float getPeriodFraction() const {
+        if (!running || intervalMicros == 0) {
+            return 0.0f;
+        }
+        uint32_t elapsed = nowMicros - periodStartMicros;
+        return elapsed >= intervalMicros ? 1.0f : (float)elapsed / (float)intervalMicros;
+    }
+
+    // Run every tick due at or before the given time
+    void advanceTo(uint32_t micros) {
+        while (running && (int32_t)(micros - nextTickMicros) >= 0) {
+            lastTickMicros = nextTickMicros;
+            periodStartMicros = nextTickMicros;
+            nowMicros = nextTickMicros;
+            nextTickMicros += intervalMicros;
+            tickCount++;
+            callback(context);
+        }
+        nowMicros = micros;
+    }
+
+    uint32_t getTickCount() const { return tickCount; }
+    uint32_t getLastTickMicros() const { return lastTickMicros; }  // Simulated time of the latest tick
+    uint32_t getInterval() const { return intervalMicros; }
+};
+
+#endif // SIMULATED_STEP_TIMER_H
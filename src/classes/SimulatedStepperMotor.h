@@ -0,0 +1,130 @@
+#ifndef SIMULATED_STEPPER_MOTOR_H
+#define SIMULATED_STEPPER_MOTOR_H
+
+#include <stdint.h>
+
+// A stepper motor for host tests of the characterization search: the rotor
+// follows each step it is given unless the step rate is above the motor's
+// pull-out rate, or has changed faster than its torque can accelerate the
+// rotor. Both are judged on the mean step rate over ACCELERATION_WINDOW_US,
+// about what the rotor's inertia smooths over: a short gap, or the rate
+// moving a little at each loop update, doesn't slip it, but a burst at full
+// rate from standstill does. Up to its start rate the rotor settles on every
+// step, so only the rate above that has to be accelerated. A rotor that missed
+// steps falls into the detent behind once it follows again, so it always ends
+// up whole electrical cycles behind, never a step or two. Positions are in the steps the motor is driven with.
+// No Arduino dependencies.
+class SimulatedStepperMotor {
+private:
+    struct RateSample {
+        uint32_t micros;
+        uint32_t midMicros;  // Middle of the span the rate is a mean over
+        float rate;          // Signed steps per second above the start rate
+    };
+
+    static const int HISTORY = 128;
+
+    float maxStepsPerSecond;
+    float maxStepsPerSecond2;
+    float startStepsPerSecond;
+    int stepsPerCycle;
+    RateSample history[HISTORY];
+    int newest;
+    int count;
+    uint32_t lastStepMicros;
+    int32_t commandedPosition;
+    int32_t rotorPosition;
+    uint32_t slips;              // Steps the rotor didn't follow
+    float peakRate;              // Highest the rotor followed
+    float peakAcceleration;
+
+    void push(uint32_t micros, uint32_t midMicros, float rate) {
+        newest = (newest + 1) % HISTORY;
+        history[newest].micros = micros;
+        history[newest].midMicros = midMicros;
+        history[newest].rate = rate;
+        count = count < HISTORY ? count + 1 : HISTORY;
+    }
+
+    void follow(int direction) {
+        rotorPosition += direction;
+        int32_t partial = (commandedPosition - rotorPosition) % stepsPerCycle;
+        if (partial != 0) {
+            rotorPosition += partial - (partial > 0 ? stepsPerCycle : -stepsPerCycle);
+        }
+    }
+
+public:
+    static const uint32_t ACCELERATION_WINDOW_US = 20000;
+    static const uint32_t STANDSTILL_US = 50000;   // A longer gap starts again from rest
+
+    // stepsPerElectricalCycle: four full steps, in the steps the motor is driven with
+    SimulatedStepperMotor(float maxRate, float maxAcceleration, float startRate = 200.0f, int stepsPerElectricalCycle = 4)
+        : maxStepsPerSecond(maxRate), maxStepsPerSecond2(maxAcceleration), startStepsPerSecond(startRate),
+          stepsPerCycle(stepsPerElectricalCycle),
+          newest(0), count(0), lastStepMicros(0), commandedPosition(0), rotorPosition(0), slips(0), peakRate(0.0f),
+          peakAcceleration(0.0f) {}
+
+    // One step of the drive, +1 or -1
+    void step(uint32_t micros, int direction) {
+        commandedPosition += direction;
+        if (count == 0 || micros - lastStepMicros >= STANDSTILL_US) {
+            count = 0;
+            push(micros, micros, 0.0f);
+            lastStepMicros = micros;
+            follow(direction);
+            return;
+        }
+        lastStepMicros = micros;
+
+        // Mean step rate over the last window: the steps since the oldest one
+        // still inside it, or just the last gap when that is longer
+        int steps = 1;
+        uint32_t span = micros - history[newest].micros;
+        for (int i = 1; i < count; i++) {
+            const RateSample& sample = history[(newest - i + HISTORY) % HISTORY];
+            if (micros - sample.micros > ACCELERATION_WINDOW_US) {
+                break;
+            }
+            steps = i + 1;
+            span = micros - sample.micros;
+        }
+        float speed = steps * 1000000.0f / (float)span;
+        float rate = direction * (speed > startStepsPerSecond ? speed - startStepsPerSecond : 0.0f);
+        uint32_t midMicros = micros - span / 2;
+
+        // Against the newest mean at least a window old; none yet means too soon after rest to tell
+        float acceleration = 0.0f;
+        for (int i = 0; i < count; i++) {
+            const RateSample& sample = history[(newest - i + HISTORY) % HISTORY];
+            if (micros - sample.micros >= ACCELERATION_WINDOW_US) {
+                acceleration = (rate - sample.rate) * 1000000.0f / (float)(midMicros - sample.midMicros);
+                break;
+            }
+        }
+        push(micros, midMicros, rate);
+
+        float magnitude = acceleration < 0.0f ? -acceleration : acceleration;
+        if (speed > maxStepsPerSecond || magnitude > maxStepsPerSecond2) {
+            slips++;
+            return;  // The rotor stays where it was
+        }
+        follow(direction);
+        peakRate = speed > peakRate ? speed : peakRate;
+        peakAcceleration = magnitude > peakAcceleration ? magnitude : peakAcceleration;
+    }
+
+    void resetPeaks() {
+        peakRate = 0.0f;
+        peakAcceleration = 0.0f;
+    }
+
+    int32_t getCommandedPosition() const { return commandedPosition; }
+    int32_t getRotorPosition() const { return rotorPosition; }
+    int32_t getLostSteps() const { return commandedPosition - rotorPosition; }
+    uint32_t getSlips() const { return slips; }
+    float getPeakRate() const { return peakRate; }
+    float getPeakAcceleration() const { return peakAcceleration; }
+};
+
+#endif // SIMULATED_STEPPER_MOTOR_H
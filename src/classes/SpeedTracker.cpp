@@ -0,0 +1,80 @@
+#include "SpeedTracker.h"
+
+SpeedTracker::SpeedTracker()
+	: jerkNoise(DEFAULT_JERK_NOISE),
+	  measurementVariance(DEFAULT_MEASUREMENT_NOISE * DEFAULT_MEASUREMENT_NOISE),
+	  initialized(false),
+	  lastUpdateMicros(0),
+	  rpm(0.0f),
+	  acceleration(0.0f),
+	  p00(0.0f),
+	  p01(0.0f),
+	  p11(0.0f) {
+}
+
+void SpeedTracker::update(float measuredRPM, uint32_t timestampMicros) {
+    if (!initialized) {
+        initialized = true;
+        lastUpdateMicros = timestampMicros;
+        rpm = measuredRPM;
+        acceleration = 0.0f;
+        p00 = measurementVariance;
+        p01 = 0.0f;
+        p11 = INITIAL_ACCEL_VARIANCE;
+        return;
+    }
+
+    float dt = (float)(timestampMicros - lastUpdateMicros) * 1e-6f;
+    lastUpdateMicros = timestampMicros;
+    if (dt > MAX_PREDICTION_SECONDS) {
+        dt = MAX_PREDICTION_SECONDS;
+    }
+    predict(dt);
+
+    // Measurement update with H = [1 0]
+    float innovation = measuredRPM - rpm;
+    float innovationVariance = p00 + measurementVariance;
+    float k0 = p00 / innovationVariance;
+    float k1 = p01 / innovationVariance;
+
+    rpm += k0 * innovation;
+    acceleration += k1 * innovation;
+
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+}
+
+void SpeedTracker::predict(float dt) {
+    float dt2 = dt * dt;
+
+    rpm += acceleration * dt;
+
+    // P = F P F' + Q for F = [1 dt; 0 1] and white-noise jerk
+    p00 += dt * (2.0f * p01 + dt * p11) + jerkNoise * dt2 * dt / 3.0f;
+    p01 += dt * p11 + jerkNoise * dt2 / 2.0f;
+    p11 += jerkNoise * dt;
+}
+
+float SpeedTracker::getRPMAt(uint32_t timestampMicros) const {
+    if (!initialized) {
+        return 0.0f;
+    }
+
+    float dt = (float)(timestampMicros - lastUpdateMicros) * 1e-6f;
+    if (dt > MAX_PREDICTION_SECONDS) {
+        dt = MAX_PREDICTION_SECONDS;
+    }
+
+    float predicted = rpm + acceleration * dt;
+    return predicted > 0.0f ? predicted : 0.0f;
+}
+
+void SpeedTracker::reset() {
+    initialized = false;
+    rpm = 0.0f;
+    acceleration = 0.0f;
+    p00 = 0.0f;
+    p01 = 0.0f;
+    p11 = 0.0f;
+}
@@ -0,0 +1,46 @@
+#ifndef SPEED_TRACKER_H
+#define SPEED_TRACKER_H
+
+#include <stdint.h>
+
+// Two-state Kalman tracker (speed, acceleration) for per-pulse RPM measurements.
+// Measurements arrive at irregular times, so the process model is propagated
+// with the actual time between pulses. Pure logic with no Arduino dependencies.
+class SpeedTracker {
+private:
+    static constexpr float DEFAULT_JERK_NOISE = 500000.0f;       // Process noise density (RPM^2/s^3)
+    static constexpr float DEFAULT_MEASUREMENT_NOISE = 20.0f;    // Per-pulse measurement std dev (RPM)
+    static constexpr float INITIAL_ACCEL_VARIANCE = 1000000.0f;  // (RPM/s)^2 before anything is known
+    static constexpr float MAX_PREDICTION_SECONDS = 1.0f;        // Cap on extrapolation between pulses
+
+    float jerkNoise;
+    float measurementVariance;
+
+    bool initialized;
+    uint32_t lastUpdateMicros;
+    float rpm;            // Estimated speed (RPM)
+    float acceleration;   // Estimated acceleration (RPM/s)
+    float p00, p01, p11;  // Covariance matrix (symmetric)
+
+    void predict(float dt);
+
+public:
+    SpeedTracker();
+
+    // Feed one measurement taken at timestampMicros
+    void update(float measuredRPM, uint32_t timestampMicros);
+    void reset();
+
+    // Configuration
+    void setJerkNoise(float noise) { jerkNoise = noise; }
+    void setMeasurementNoise(float rpmStdDev) { measurementVariance = rpmStdDev * rpmStdDev; }
+
+    // Getters
+    bool isInitialized() const { return initialized; }
+    float getRPM() const { return rpm; }
+    float getRPMAt(uint32_t timestampMicros) const;  // Extrapolated to a later time
+    float getAcceleration() const { return acceleration; }
+    float getVariance() const { return p00; }
+};
+
+#endif // SPEED_TRACKER_H
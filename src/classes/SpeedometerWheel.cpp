@@ -1,8 +1,26 @@
 #include "SpeedometerWheel.h"
 #include <Arduino.h>
 
-SpeedometerWheel::SpeedometerWheel()
-	: stepper(STEPS_PER_REVOLUTION, STEPPER_PIN_1, STEPPER_PIN_3, STEPPER_PIN_2, STEPPER_PIN_4),
+#if defined(ESP32)
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#endif
+
+// Endstop level straight from the input register - safe in the step interrupt
+static inline IRAM_ATTR bool readEndstopRegister() {
+#if defined(ESP32) && ENDSTOP_PIN < 32
+    return (REG_READ(GPIO_IN_REG) >> ENDSTOP_PIN) & 1;
+#elif defined(ESP32)
+    return (REG_READ(GPIO_IN1_REG) >> (ENDSTOP_PIN - 32)) & 1;
+#else
+    return false;
+#endif
+}
+
+SpeedometerWheel::SpeedometerWheel(ParameterStorage& rtcStorage, ParameterStorage& flashStorage)
+	: stepGenerator(STEPPER_PIN_1, STEPPER_PIN_2, STEPPER_PIN_3, STEPPER_PIN_4),
+	  stepTimer(STEPPER_TIMER_GROUP, STEPPER_TIMER_INDEX),
+	  dial(StepperDrive::MICROSTEPS),
 	  currentPosition(0),
 	  targetPosition(0),
 	  homeStartPosition(0),
@@ -10,10 +28,98 @@ SpeedometerWheel::SpeedometerWheel()
 	  homeMarkerWidth(0),
 	  isCalibrated(false),
 	  isMoving(false),
-	  transitionStartTime(0),
+	  markerWatch(dial),
+	  generatorOffset(0),
+	  driftCorrections(0),
+	  lastDriftSteps(0),
+	  homing(dial),
+	  homingMoveStart(0),
+	  pendingMph(0.0f),
+	  hasPendingMph(false),
+	  stateStore(rtcStorage, flashStorage),
+	  warmBoot(WARM_BOOT_NONE),
+	  parkedAtMarker(false),
+	  planner(dial.getStepsPerMph() * 20.0f, dial.getStepsPerMph() * 40.0f),
+	  stepScheduler(1),
+	  lastPlannerMicros(0),
 	  currentPositionFloat(0.0),
-	  startPositionFloat(0.0),
-	  targetPositionFloat(0.0) {
+	  needleMaxMphPerSecond(20.0f),
+	  needleMaxMphPerSecond2(40.0f),
+	  stepIntervalUs(0),
+	  trialMove(0),
+	  trialCrossings(0),
+	  trialDriftCorrections(0) {
+    memset(&savedState, 0, sizeof(savedState));
+    stepperLimits.stepsPerSecond = STEPPER_RPM * STEPS_PER_REVOLUTION / 60.0f;
+    stepperLimits.stepsPerSecond2 = STEPPER_ACCEL;
+    applyStepperLimits(stepperLimits, true);
+}
+
+void SpeedometerWheel::setMotionLimits(float maxMphPerSecond, float maxMphPerSecondSquared) {
+    needleMaxMphPerSecond = maxMphPerSecond;
+    needleMaxMphPerSecond2 = maxMphPerSecondSquared;
+    if (!characterizer.isActive()) {
+        applyStepperLimits(stepperLimits, true);
+    }
+}
+
+void SpeedometerWheel::setStepperLimits(float maxFullStepsPerSecond, float maxFullStepsPerSecondSquared) {
+    if (!(maxFullStepsPerSecond > 0.0f) || !(maxFullStepsPerSecondSquared > 0.0f)) {
+        return;
+    }
+    stepperLimits.stepsPerSecond = maxFullStepsPerSecond;
+    stepperLimits.stepsPerSecond2 = maxFullStepsPerSecondSquared;
+    if (!characterizer.isActive()) {
+        applyStepperLimits(stepperLimits, true);
+    }
+}
+
+void SpeedometerWheel::applyStepperLimits(const StepperLimits& limits, bool needleLimited) {
+    stepIntervalUs = (uint32_t)lroundf(1000000.0f / (limits.stepsPerSecond * StepperDrive::MICROSTEPS));
+    stepScheduler.setMinInterval(stepIntervalUs);
+    stepTimer.setInterval(stepIntervalUs);
+
+    // The planner must not outrun the step timer
+    float velocity = 1000000.0f / stepIntervalUs;
+    float acceleration = limits.stepsPerSecond2 * StepperDrive::MICROSTEPS;
+    if (needleLimited) {
+        float needleVelocity = needleMaxMphPerSecond * dial.getStepsPerMph();
+        float needleAcceleration = needleMaxMphPerSecond2 * dial.getStepsPerMph();
+        velocity = needleVelocity < velocity ? needleVelocity : velocity;
+        acceleration = needleAcceleration < acceleration ? needleAcceleration : acceleration;
+    }
+    planner.setLimits(velocity, acceleration);
+}
+
+bool SpeedometerWheel::setDialCalibration(const uint16_t fullStepsAtKnot[DIAL_CALIBRATION_POINTS]) {
+    if (!dial.setCalibration(fullStepsAtKnot)) {
+        Serial.println("Warning: Dial calibration table rejected, keeping the linear scale");
+        return false;
+    }
+    return true;
+}
+
+void SpeedometerWheel::settleAt(int position) {
+    generatorOffset = position - stepGenerator.getTarget();
+    currentPosition = position;
+    currentPositionFloat = position;
+    planner.reset(position);
+    isMoving = false;
+}
+
+WarmBootDecision SpeedometerWheel::restoreState() {
+    warmBoot = stateStore.load(dial.getStepsPerRevolution(), savedState);
+    if (warmBoot != WARM_BOOT_NONE) {
+        Serial.print("Saved needle position ");
+        Serial.print(savedState.position);
+        Serial.print(", marker ");
+        Serial.print(savedState.homeStartPosition);
+        Serial.print("+");
+        Serial.print(savedState.homeMarkerWidth);
+        Serial.print(" - warm boot: ");
+        Serial.println(NeedleStateStore::decisionName(warmBoot));
+    }
+    return warmBoot;
 }
 
 void SpeedometerWheel::begin() {
@@ -23,21 +129,35 @@ void SpeedometerWheel::begin() {
     Serial.print(STEPPER_PIN_2); Serial.print(", ");
     Serial.print(STEPPER_PIN_3); Serial.print(", ");
     Serial.println(STEPPER_PIN_4);
-    Serial.print("Constructor pin order: ");
-    Serial.print(STEPPER_PIN_1); Serial.print(", ");
-    Serial.print(STEPPER_PIN_3); Serial.print(", ");
-    Serial.print(STEPPER_PIN_2); Serial.print(", ");
-    Serial.println(STEPPER_PIN_4);
     Serial.print("Endstop pin: GPIO ");
     Serial.println(ENDSTOP_PIN);
 
     pinMode(ENDSTOP_PIN, INPUT_PULLUP);
-    stepper.setSpeed(STEPPER_RPM);
     currentPosition = 0;
     currentPositionFloat = 0.0;
+    if (warmBoot != WARM_BOOT_NONE) {
+        // Re-energize the detent the rotor was left in, so it doesn't jump
+        currentPosition = dial.wrap(savedState.position);
+        currentPositionFloat = currentPosition;
+        stepGenerator.setPhase(savedState.coilPhase);
+    }
 
-    Serial.println("Stepper speed set to: " + String(STEPPER_RPM) + " RPM");
-    Serial.println("Steps per revolution: " + String(STEPS_PER_REVOLUTION));
+    // Steps are emitted from a timer interrupt; the loop only moves the target
+    stepGenerator.begin();
+    if (stepTimer.begin(onStepTick, this, stepIntervalUs)) {
+        Serial.println("Step timer running: " + String(stepIntervalUs) + " us/step (" +
+                       String(stepperLimits.stepsPerSecond, 0) + " full steps/s)");
+    } else {
+        Serial.println("Warning: Step timer unavailable, stepping from the loop");
+    }
+    Serial.println("Stepper drive: " + String(StepperDrive::name()) + ", " +
+                   String(dial.getStepsPerRevolution()) + " steps per revolution");
+
+    // The bench tests move the rotor behind the step generator's back, so they
+    // only run when a full marker search follows anyway
+    if (warmBoot != WARM_BOOT_NONE) {
+        return;
+    }
 
     // Test stepper motor with a few steps
     Serial.println("Testing stepper motor movement...");
@@ -50,188 +170,222 @@ void SpeedometerWheel::begin() {
     // Run manual stepper test to verify motor operation
     Serial.println("\nRunning manual stepper motor test...");
     manualStepperTest();
+
+    // The tests drove the coils directly - hand them back to the step generator
+    stepGenerator.begin();
+}
+
+bool IRAM_ATTR SpeedometerWheel::onStepTick(void* context) {
+    SpeedometerWheel* wheel = static_cast<SpeedometerWheel*>(context);
+    // Sample before stepping: the rotor has had a whole tick to settle where it is
+    int32_t position = wheel->stepGenerator.getPosition();
+    bool endstop = readEndstopRegister();
+    wheel->markerWatch.sample(position, endstop);
+    wheel->edgeWatch.sample(position, endstop);
+    wheel->stepGenerator.tick();
+    return false;  // No task woken
 }
 
 bool SpeedometerWheel::readEndstop() {
     return digitalRead(ENDSTOP_PIN) == HIGH;  // HIGH means marker is detected
 }
 
+void SpeedometerWheel::stepAndWait(int steps) {
+    stepTimer.setInterval(stepIntervalUs);
+    stepGenerator.moveBy(steps);
+    while (stepGenerator.isMoving()) {
+        if (stepTimer.isRunning()) {
+            delay(1);
+        } else {
+            stepGenerator.tick();
+            delayMicroseconds(stepIntervalUs);
+        }
+    }
+}
+
 void SpeedometerWheel::singleStep(bool clockwise) {
-    stepper.step(clockwise ? 1 : -1);
-    currentPosition += clockwise ? 1 : -1;
+    // One motor full step whatever the drive mode, so searches take the same time
+    int steps = clockwise ? StepperDrive::MICROSTEPS : -StepperDrive::MICROSTEPS;
+    stepAndWait(steps);
+    currentPosition = dial.wrap(currentPosition + steps);
+}
 
-    // Wrap around at full revolution
-    if (currentPosition >= STEPS_PER_REVOLUTION) {
-        currentPosition = 0;
-    } else if (currentPosition < 0) {
-        currentPosition = STEPS_PER_REVOLUTION - 1;
+void SpeedometerWheel::prepareHoming() {
+    isCalibrated = false;
+    parkedAtMarker = false;
+    if (!characterizer.isActive()) {
+        hasPendingMph = false;  // A characterization re-home keeps the speed it is holding back
     }
+    settleAt(currentPosition);
+    stepTimer.setInterval(stepIntervalUs);  // Search moves run at the motor's step rate
+    stateStore.invalidateRtc();  // A reset mid-search must not trust a half-known position
 }
 
-int SpeedometerWheel::findEdge(bool clockwise, bool risingEdge) {
-    bool targetState = risingEdge;  // true for rising edge (entering marker), false for falling edge (leaving marker)
-    bool currentState = readEndstop();
+void SpeedometerWheel::startCalibration() {
+    WarmBootDecision decision = warmBoot;
+    warmBoot = WARM_BOOT_NONE;  // Only the first calibration after boot may use the saved state
+
+    if (decision == WARM_BOOT_TRUST) {
+        homing.resume(currentPosition, savedState.homeStartPosition, savedState.homeMarkerWidth);
+        Serial.println("Warm boot: resuming at saved position");
+        finishHoming();
+    } else if (decision == WARM_BOOT_VERIFY) {
+        prepareHoming();
+        homing.startVerify(currentPosition, savedState.homeStartPosition, savedState.homeMarkerWidth);
+        Serial.println("Warm boot: verifying saved position against the home marker");
+    } else {
+        startHoming();
+    }
+}
 
-    Serial.print("Searching for ");
-    Serial.print(risingEdge ? "rising" : "falling");
-    Serial.print(" edge, starting from state: ");
-    Serial.println(currentState ? "TRIGGERED" : "OPEN");
+void SpeedometerWheel::startHoming() {
+    prepareHoming();
 
-    // Move until we find the edge (search up to 1.5 revolutions to be thorough)
-    for (int i = 0; i < (STEPS_PER_REVOLUTION * 3 / 2); i++) {
-        singleStep(clockwise);
-        delay(5);  // Small delay for sensor stability
+    homing.start(currentPosition);
 
-        bool newState = readEndstop();
+    Serial.print("Starting home calibration, sensor: ");
+    Serial.println(readEndstop() ? "TRIGGERED" : "OPEN");
+}
 
-        // Debug output every 100 steps
-        if (i % 100 == 0) {
-            Serial.print("Step ");
-            Serial.print(i);
-            Serial.print("/");
-            Serial.print(STEPS_PER_REVOLUTION * 3 / 2);
-            Serial.print(" - Sensor: ");
-            Serial.println(newState ? "TRIGGERED" : "OPEN");
-        }
+bool SpeedometerWheel::calibrateHome() {
+    startHoming();
+    while (homing.isActive()) {
+        update();
+        delay(1);
+    }
+    return isCalibrated;
+}
 
-        if (currentState != newState && newState == targetState) {
-            Serial.print("Edge found at step ");
-            Serial.print(currentPosition);
-            Serial.print(" - Transition: ");
-            Serial.print(currentState ? "TRIGGERED" : "OPEN");
-            Serial.print(" -> ");
-            Serial.println(newState ? "TRIGGERED" : "OPEN");
-            return currentPosition;
+void SpeedometerWheel::updateHoming() {
+    bool moveDone = !stepGenerator.isMoving() && edgeWatch.hasSampled(stepGenerator.getTarget());
+    if (!stepTimer.isRunning()) {
+        // No timer: the loop steps up to a full step per update through the
+        // interrupt body, which also samples the position a move ends on
+        for (int i = 0; i < StepperDrive::MICROSTEPS && !moveDone; i++) {
+            onStepTick(this);
+            delayMicroseconds(stepIntervalUs);
+            moveDone = !stepGenerator.isMoving() && edgeWatch.hasSampled(stepGenerator.getTarget());
         }
-        currentState = newState;
     }
 
-    Serial.println("Edge not found after 1.5 revolutions");
-    return -1;  // Edge not found
-}
+    // A search ends on the edge it was looking for: the move is retargeted to
+    // it, and the rotor comes back if it ran on before the loop got here
+    EndstopEdge edge;
+    while (edgeWatch.take(edge)) {
+        int32_t end = homingMoveStart + homing.edge(edge.position - homingMoveStart, edge.triggered);
+        if (end != stepGenerator.getTarget()) {
+            stepGenerator.moveTo(end);
+        }
+    }
+    currentPosition = homing.getPosition();
 
-bool SpeedometerWheel::calibrateHome() {
-    Serial.println("Starting home calibration...");
-    Serial.println("Looking for home marker...");
-
-    // Check initial sensor state
-    bool initialState = readEndstop();
-    Serial.print("Initial sensor state: ");
-    Serial.println(initialState ? "TRIGGERED" : "OPEN");
-
-    // Verify stepper can move by testing a few steps
-    Serial.println("Pre-calibration movement test...");
-    for (int i = 0; i < 5; i++) {
-        Serial.print("Test step ");
-        Serial.print(i + 1);
-        Serial.print(" - Sensor: ");
-        bool state = readEndstop();
-        Serial.print(state ? "TRIGGERED" : "OPEN");
+    // Previous move still being stepped out, or its end not yet read
+    if (!moveDone || stepGenerator.isMoving()) {
+        return;
+    }
 
-        stepper.step(1);
-        delay(200);  // Longer delay for observation
+    HomingStatus previous = homing.getStatus();
+    int steps = homing.advance(readEndstop());
+    HomingStatus status = homing.getStatus();
 
-        bool newState = readEndstop();
-        Serial.print(" -> ");
-        Serial.println(newState ? "TRIGGERED" : "OPEN");
+    if (status != previous) {
+        Serial.print("Homing: ");
+        Serial.print(HomingSequencer::statusName(status));
+        Serial.print(" at step ");
+        Serial.print(currentPosition);
+        Serial.print(" after ");
+        Serial.print(homing.getTotalMoves());
+        Serial.println(" moves");
     }
 
-    // First, try clockwise rotation to find the start of the home marker
-    Serial.println("Phase 1: Finding rising edge (entering marker) - Clockwise search...");
-    homeStartPosition = findEdge(true, true);  // Find rising edge (entering marker)
-
-    if (homeStartPosition == -1) {
-        Serial.println("Marker not found clockwise, trying counterclockwise...");
-        homeStartPosition = findEdge(false, true);  // Try counterclockwise
+    if (steps != 0) {
+        edgeWatch.clear();
+        homingMoveStart = stepGenerator.getTarget();
+        stepGenerator.moveBy(steps);
+        currentPosition = homing.getPosition();
+        return;
     }
 
-    if (homeStartPosition == -1) {
-        Serial.println("Home marker start not found in either direction!");
+    if (status == HOMING_COMPLETE) {
+        finishHoming();
+    } else if (status == HOMING_FAILED_VERIFY) {
+        Serial.println("Warm boot: marker not where it was saved, falling back to full homing");
+        startHoming();
+    } else if (homing.isFailed()) {
+        Serial.println("Home calibration failed: " + String(HomingSequencer::statusName(status)));
+        if (characterizer.isActive()) {
+            characterizer.cancel();
+            Serial.println("Stepper characterization cancelled");
+        }
         Serial.println("Troubleshooting tips:");
         Serial.println("- Ensure marker is attached to wheel");
         Serial.println("- Check endstop sensor alignment");
         Serial.println("- Verify marker can block optical sensor");
         Serial.println("- Try manually rotating wheel to see sensor transitions");
-        return false;
-    }
-
-    Serial.print("Home marker starts at step: ");
-    Serial.println(homeStartPosition);
-
-    // Continue rotating to find the end of the home marker
-    Serial.println("Phase 2: Finding falling edge (leaving marker)...");
-    homeEndPosition = findEdge(true, false);  // Find falling edge (leaving marker)
-    if (homeEndPosition == -1) {
-        Serial.println("Home marker end not found!");
-        Serial.println("Marker may be too wide or sensor issue occurred");
-        return false;
     }
+}
 
-    Serial.print("Home marker ends at step: ");
-    Serial.println(homeEndPosition);
+void SpeedometerWheel::finishHoming() {
+    homeStartPosition = homing.getMarkerStart();
+    homeEndPosition = homing.getMarkerEnd();
+    homeMarkerWidth = homing.getMarkerWidth();
+    settleAt(homing.getPosition());
+    isCalibrated = true;
+    persistState(false);
 
-    // Calculate marker width
-    homeMarkerWidth = (homeEndPosition - homeStartPosition + STEPS_PER_REVOLUTION) % STEPS_PER_REVOLUTION;
+    MarkerCrossing searchCrossing;
+    markerWatch.takeCrossing(searchCrossing);  // Made by the search itself - nothing to check
 
-    Serial.print("Home marker width: ");
+    Serial.print("Home marker: steps ");
+    Serial.print(homeStartPosition);
+    Serial.print("-");
+    Serial.print(homeEndPosition);
+    Serial.print(" (");
     Serial.print(homeMarkerWidth);
-    Serial.println(" steps");
-
-    // Position at center of home marker
-    int centerOffset = homeMarkerWidth / 2;
-    int targetPosition = (homeStartPosition + centerOffset) % STEPS_PER_REVOLUTION;
+    Serial.println(" steps wide)");
+    Serial.println("Home calibration complete!");
 
-    // Move to center of home marker
-    int stepsToMove = (targetPosition - currentPosition + STEPS_PER_REVOLUTION) % STEPS_PER_REVOLUTION;
-    if (stepsToMove > STEPS_PER_REVOLUTION / 2) {
-        stepsToMove -= STEPS_PER_REVOLUTION;  // Go the shorter way
+    if (characterizer.isActive()) {
+        startCharacterizationTrial();  // Re-homed after a trial lost the marker
+        return;
+    }
+    if (hasPendingMph) {
+        hasPendingMph = false;
+        moveToMPH(pendingMph);
     }
-
-    stepper.step(stepsToMove);
-    currentPosition = targetPosition;
-
-    isCalibrated = true;
-    Serial.println("Home calibration complete!");
-    return true;
 }
 
-void SpeedometerWheel::moveToMPH(int mph) {
+void SpeedometerWheel::moveToMPH(float mph) {
+    if (homing.isActive() || characterizer.isActive()) {
+        pendingMph = mph;
+        hasPendingMph = true;
+        return;
+    }
     if (!isCalibrated) {
         Serial.println("Error: Wheel not calibrated. Call calibrateHome() first.");
         return;
     }
 
+    parkedAtMarker = false;
+
     // Constrain mph to valid range
     mph = constrain(mph, MIN_SPEED_MPH, MAX_SPEED_MPH);
 
     // Calculate target position
-    int targetSteps = stepsFromHome(mph);
-    int homeCenter = (homeStartPosition + homeMarkerWidth / 2) % STEPS_PER_REVOLUTION;
-    targetPosition = (homeCenter + targetSteps) % STEPS_PER_REVOLUTION;
-
-    // If already at target, do nothing
-    if (abs(targetPosition - (int)round(currentPositionFloat)) < 2) {
+    int targetSteps = dial.stepsFromHome(mph);
+    targetPosition = dial.wrap(getHomeCenter() + targetSteps);
+
+    // Retarget along the shortest way round from where the needle is now. The
+    // planner keeps its velocity, so a stream of updates never restarts a move.
+    int from = (int)lroundf(planner.getPosition());
+    float newTarget = (float)(from + dial.shortestPath(dial.wrap(from), targetPosition));
+    if (newTarget == planner.getTarget()) {
         return;
     }
-
-    // Start smooth transition
-    startPositionFloat = currentPositionFloat;
-    targetPositionFloat = targetPosition;
-
-    // Handle wrap-around for shortest path
-    if (abs(targetPositionFloat - startPositionFloat) > STEPS_PER_REVOLUTION / 2) {
-        if (targetPositionFloat > startPositionFloat) {
-            targetPositionFloat -= STEPS_PER_REVOLUTION;
-        } else {
-            targetPositionFloat += STEPS_PER_REVOLUTION;
-        }
-    }
-
-    transitionStartTime = millis();
-    isMoving = true;
+    startMove(newTarget);
 
     Serial.print("Starting transition to ");
-    Serial.print(mph);
+    Serial.print(mph, 2);
     Serial.print(" MPH (target position: ");
     Serial.print(targetPosition);
     Serial.println(")");
@@ -243,62 +397,85 @@ bool SpeedometerWheel::homeWheel() {
     }
 
     // Calculate shortest path to home center
-    int homeCenter = (homeStartPosition + homeMarkerWidth / 2) % STEPS_PER_REVOLUTION;
+    int homeCenter = getHomeCenter();
     int stepsToMove = shortestPathToHome();
 
     Serial.print("Homing wheel (");
     Serial.print(stepsToMove);
     Serial.println(" steps)");
 
-    stepper.step(stepsToMove);
-    currentPosition = homeCenter;
+    stepAndWait(stepsToMove);
+    settleAt(homeCenter);
 
     return true;
 }
 
-int SpeedometerWheel::stepsFromHome(int mph) {
-    // Calculate steps from home center to MPH position
-    // Add ZERO_MPH_OFFSET to account for 0 MPH position being offset from home
-    return ZERO_MPH_OFFSET + (mph * STEPS_PER_MPH);
-}
-
 int SpeedometerWheel::shortestPathToHome() {
     if (!isCalibrated) {
         return 0;
     }
 
-    int homeCenter = (homeStartPosition + homeMarkerWidth / 2) % STEPS_PER_REVOLUTION;
-    int stepsToMove = (homeCenter - currentPosition + STEPS_PER_REVOLUTION) % STEPS_PER_REVOLUTION;
-
-    // Choose shortest direction
-    if (stepsToMove > STEPS_PER_REVOLUTION / 2) {
-        stepsToMove -= STEPS_PER_REVOLUTION;  // Go the shorter way (negative = counterclockwise)
-    }
-
-    return stepsToMove;
+    // Shortest direction (negative = counterclockwise)
+    return dial.shortestPath(currentPosition, getHomeCenter());
 }
 
 void SpeedometerWheel::update() {
-    if (!isCalibrated || !isMoving) {
+    if (homing.isActive()) {
+        updateHoming();
+        return;
+    }
+    if (!isCalibrated) {
         return;
     }
 
-    unsigned long currentTime = millis();
-    unsigned long elapsed = currentTime - transitionStartTime;
+    checkDrift();
+    if (isMoving) {
+        updateMotion();
+    }
+    if (characterizer.isActive()) {
+        updateCharacterization();
+    }
 
-    if (elapsed >= SPEED_TRANSITION_TIME_MS) {
-        // Transition complete
-        currentPositionFloat = targetPositionFloat;
+    // Keep the RTC copy current; flash only once a park() move has come to rest
+    bool moving = isInTransition();
+    if (currentPosition != savedState.position || moving != (savedState.moving != 0)) {
+        persistState(parkedAtMarker);
+    }
+}
 
-        // Handle wrap-around
-        while (currentPositionFloat >= STEPS_PER_REVOLUTION) {
-            currentPositionFloat -= STEPS_PER_REVOLUTION;
-        }
-        while (currentPositionFloat < 0) {
-            currentPositionFloat += STEPS_PER_REVOLUTION;
-        }
+void SpeedometerWheel::startMove(float plannerTarget) {
+    planner.setTarget(plannerTarget);
+    if (!isMoving) {
+        lastPlannerMicros = micros();
+        isMoving = true;
+    }
+}
 
-        currentPosition = (int)round(currentPositionFloat);
+void SpeedometerWheel::updateMotion() {
+    unsigned long nowMicros = micros();
+    float dt = (nowMicros - lastPlannerMicros) / 1000000.0f;
+    lastPlannerMicros = nowMicros;
+    if (dt > 0.1f) {
+        dt = 0.1f;  // A stalled loop resumes the motion rather than jumping it
+    }
+
+    planner.update(dt);
+    currentPositionFloat = planner.getPosition();
+
+    // Lead the planner by a couple of updates and step at its velocity, so the
+    // steps until the next update are spread out rather than sent as one burst
+    float velocity = planner.getVelocity();
+    float lead = stepScheduler.leadPosition(currentPositionFloat, velocity, planner.getTarget(), dt);
+    updateStepperPosition(lead);
+    int32_t pending = stepGenerator.getTarget() - stepGenerator.getPosition();
+    float stepUnderway = pending > 0 ? stepTimer.getPeriodFraction() : pending < 0 ? -stepTimer.getPeriodFraction() : 0.0f;
+    float backlog = pending - stepUnderway + (lead - lroundf(lead));
+    stepTimer.setInterval(stepScheduler.interval(velocity, backlog, dt));
+
+    if (planner.isSettled()) {
+        // Transition complete - fold the unwrapped trajectory back into one revolution
+        planner.shift(dial.wrap((int)lroundf(currentPositionFloat)) - currentPositionFloat);
+        currentPositionFloat = planner.getPosition();
         isMoving = false;
 
         Serial.print("Speed transition complete. Position: ");
@@ -306,85 +483,217 @@ void SpeedometerWheel::update() {
         Serial.print(" (");
         Serial.print(getCurrentMPH());
         Serial.println(" MPH)");
-    } else {
-        // Calculate interpolated position
-        float progress = (float)elapsed / (float)SPEED_TRANSITION_TIME_MS;
-        float easedProgress = easeInOutCubic(progress);
-        currentPositionFloat = startPositionFloat + (targetPositionFloat - startPositionFloat) * easedProgress;
     }
+}
 
-    updateStepperPosition();
+void SpeedometerWheel::checkDrift() {
+    MarkerCrossing crossing;
+    int drift;
+    if (!markerWatch.takeCrossing(crossing) ||
+        !markerWatch.measureDrift(crossing, generatorOffset, homeStartPosition, homeMarkerWidth, drift)) {
+        return;
+    }
+
+    // The rotor is drift steps behind where we think it is. Move our frame
+    // back onto it and let the planner carry the needle on to the same target.
+    float target = planner.getTarget();
+    planner.shift((float)-drift);
+    planner.setTarget(target);
+    currentPositionFloat = planner.getPosition();
+    currentPosition = dial.wrap(currentPosition - drift);
+    generatorOffset -= drift;
+    if (!isMoving) {
+        lastPlannerMicros = micros();
+        isMoving = true;
+    }
+
+    driftCorrections++;
+    lastDriftSteps = drift;
 }
 
-float SpeedometerWheel::easeInOutCubic(float t) {
-    // Smooth easing function that starts slow, accelerates, then slows down
-    if (t < 0.5f) {
-        return 4.0f * t * t * t;
-    } else {
-        float f = (2.0f * t - 2.0f);
-        return 1.0f + f * f * f / 2.0f;
+bool SpeedometerWheel::startCharacterization() {
+    if (!isCalibrated || homing.isActive()) {
+        Serial.println("Error: Wheel not calibrated. Call calibrateHome() first.");
+        return false;
     }
+
+    CharacterizationRange range;
+    range.minimum.stepsPerSecond = STEPPER_CHARACTERIZE_MIN_RATE;
+    range.minimum.stepsPerSecond2 = STEPPER_CHARACTERIZE_MIN_ACCEL;
+    range.maximum.stepsPerSecond = STEPPER_CHARACTERIZE_MAX_RATE;
+    range.maximum.stepsPerSecond2 = STEPPER_CHARACTERIZE_MAX_ACCEL;
+    range.rampSteps = STEPS_PER_REVOLUTION / 4;  // Reach the trial rate within a quarter turn
+    characterizer.start(range);
+    hasPendingMph = false;
+
+    Serial.println("Characterizing stepper: sweeping past the home marker at rising step rates");
+    startCharacterizationTrial();
+    return true;
 }
 
-void SpeedometerWheel::updateStepperPosition() {
-    int targetSteps = (int)round(currentPositionFloat);
+void SpeedometerWheel::startCharacterizationTrial() {
+    StepperLimits trial;
+    if (!characterizer.getTrial(trial)) {
+        finishCharacterization();
+        return;
+    }
+
+    Serial.print("Characterization trial ");
+    Serial.print(characterizer.getTrialCount() + 1);
+    Serial.print(": ");
+    Serial.print(trial.stepsPerSecond, 0);
+    Serial.print(" steps/s, ");
+    Serial.print(trial.stepsPerSecond2, 0);
+    Serial.println(" steps/s^2");
+
+    // Start opposite the marker, so each revolution crosses it once mid-move
+    int anchor = dial.wrap(getHomeCenter() + dial.getStepsPerRevolution() / 2);
+    int from = (int)lroundf(planner.getPosition());
+    applyStepperLimits(characterizer.getRange().minimum, false);
+    startMove((float)(from + dial.shortestPath(dial.wrap(from), anchor)));
+    trialMove = 0;
+}
 
-    // Handle wrap-around
-    while (targetSteps >= STEPS_PER_REVOLUTION) {
-        targetSteps -= STEPS_PER_REVOLUTION;
+void SpeedometerWheel::updateCharacterization() {
+    if (isInTransition()) {
+        return;  // Current revolution still being stepped out
     }
-    while (targetSteps < 0) {
-        targetSteps += STEPS_PER_REVOLUTION;
+
+    if (trialMove == 0) {
+        trialCrossings = markerWatch.getCrossingCount();
+        trialDriftCorrections = driftCorrections;
+    }
+    if (trialMove <= CHARACTERIZATION_SWEEPS) {
+        StepperLimits trial;
+        characterizer.getTrial(trial);
+        applyStepperLimits(trialMove < CHARACTERIZATION_SWEEPS ? trial : characterizer.getRange().minimum, false);
+        startMove(planner.getPosition() + dial.getStepsPerRevolution());
+        trialMove++;
+        return;
     }
 
-    int stepsToMove = shortestPath(currentPosition, targetSteps);
+    // Losses in both directions would cancel out, which is why the sweeps only go clockwise
+    uint32_t crossings = markerWatch.getCrossingCount() - trialCrossings;
+    bool crossed = crossings >= (uint32_t)CHARACTERIZATION_SWEEPS + 1;
+    bool passed = crossed && driftCorrections == trialDriftCorrections;
+    characterizer.report(passed);
+
+    Serial.print("Characterization trial ");
+    Serial.print(characterizer.getTrialCount());
+    Serial.print(passed ? ": passed" : ": lost steps");
+    Serial.print(" (");
+    Serial.print(crossings);
+    Serial.print(" crossings, drift ");
+    Serial.print(driftCorrections == trialDriftCorrections ? 0 : lastDriftSteps);
+    Serial.println(" steps)");
 
-    if (stepsToMove != 0) {
-        stepper.step(stepsToMove);
-        currentPosition = targetSteps;
+    if (!crossed) {
+        // The rotor stalled badly enough to miss the marker: its position is
+        // unknown until the marker has been found again
+        applyStepperLimits(stepperLimits, true);
+        startHoming();
+        return;
     }
+    startCharacterizationTrial();  // Drift was corrected on the slow revolution's crossing
 }
 
-int SpeedometerWheel::shortestPath(int from, int to) {
-    int diff = (to - from + STEPS_PER_REVOLUTION) % STEPS_PER_REVOLUTION;
-    if (diff > STEPS_PER_REVOLUTION / 2) {
-        diff -= STEPS_PER_REVOLUTION;
+void SpeedometerWheel::finishCharacterization() {
+    if (characterizer.getStatus() == CHARACTERIZE_COMPLETE) {
+        StepperLimits best = characterizer.getBest();
+        StepperLimits recommended = characterizer.getRecommended();
+        Serial.print("Stepper characterized in ");
+        Serial.print(characterizer.getTrialCount());
+        Serial.print(" trials: reliable to ");
+        Serial.print(best.stepsPerSecond, 0);
+        Serial.print(" steps/s, ");
+        Serial.print(best.stepsPerSecond2, 0);
+        Serial.print(" steps/s^2 - using ");
+        Serial.print(recommended.stepsPerSecond, 0);
+        Serial.print(" steps/s, ");
+        Serial.print(recommended.stepsPerSecond2, 0);
+        Serial.println(" steps/s^2");
+        stepperLimits = recommended;
+    } else {
+        Serial.print("Stepper characterization failed after ");
+        Serial.print(characterizer.getTrialCount());
+        Serial.println(" trials - keeping the current limits");
     }
-    return diff;
+    applyStepperLimits(stepperLimits, true);
+
+    float mph = hasPendingMph ? pendingMph : 0.0f;
+    hasPendingMph = false;
+    moveToMPH(mph);
 }
 
-int SpeedometerWheel::getCurrentMPH() const {
-    if (!isCalibrated) {
-        return 0;
+void SpeedometerWheel::persistState(bool toFlash) {
+    savedState.stepsPerRevolution = dial.getStepsPerRevolution();
+    savedState.homeStartPosition = homeStartPosition;
+    savedState.homeMarkerWidth = homeMarkerWidth;
+    savedState.position = currentPosition;
+    savedState.coilPhase = stepGenerator.getTargetPhase();
+    savedState.moving = isInTransition() ? 1 : 0;
+    savedState.reserved = 0;
+
+    stateStore.saveRtc(savedState);
+    if (toFlash && !savedState.moving && stateStore.saveFlash(savedState)) {
+        Serial.println("Needle position saved to flash");
     }
+}
 
-    int homeCenter = (homeStartPosition + homeMarkerWidth / 2) % STEPS_PER_REVOLUTION;
-    int currentPos = (int)round(currentPositionFloat);
-    while (currentPos >= STEPS_PER_REVOLUTION) currentPos -= STEPS_PER_REVOLUTION;
-    while (currentPos < 0) currentPos += STEPS_PER_REVOLUTION;
+void SpeedometerWheel::saveState() {
+    if (isCalibrated && !homing.isActive()) {
+        persistState(true);
+    }
+}
+
+int SpeedometerWheel::getParkPosition() const {
+    // The scale starts clockwise of the marker, so approach it counterclockwise
+    return homing.verifyStartPosition(homeStartPosition, homeMarkerWidth, false);
+}
 
-    int stepsFromHomeCenter = (currentPos - homeCenter + STEPS_PER_REVOLUTION) % STEPS_PER_REVOLUTION;
-    if (stepsFromHomeCenter > STEPS_PER_REVOLUTION / 2) {
-        stepsFromHomeCenter -= STEPS_PER_REVOLUTION;
+void SpeedometerWheel::park() {
+    if (!isCalibrated || homing.isActive() || characterizer.isActive() || parkedAtMarker) {
+        return;
+    }
+    parkedAtMarker = true;
+
+    // Below the bottom of the scale, where the next cold boot's verify pass
+    // starts: it then crosses the marker without an approach move
+    int from = (int)lroundf(planner.getPosition());
+    float parkTarget = (float)(from + dial.shortestPath(dial.wrap(from), getParkPosition()));
+    if (parkTarget != planner.getTarget()) {
+        startMove(parkTarget);
+    } else {
+        saveState();
     }
+    Serial.print("Parking beside the home marker at step ");
+    Serial.println(getParkPosition());
+}
+
+void SpeedometerWheel::updateStepperPosition(float position) {
+    int targetSteps = dial.wrap((int)lroundf(position));
+    int stepsToMove = dial.shortestPath(currentPosition, targetSteps);
 
-    int stepsFromZero = stepsFromHomeCenter - ZERO_MPH_OFFSET;
-    return constrain(stepsFromZero / STEPS_PER_MPH, MIN_SPEED_MPH, MAX_SPEED_MPH);
+    if (stepsToMove != 0) {
+        stepGenerator.moveBy(stepsToMove);  // Returns at once; the timer emits the steps
+        currentPosition = targetSteps;
+    }
 }
 
-int SpeedometerWheel::getTargetMPH() const {
+float SpeedometerWheel::getCurrentMPH() const {
     if (!isCalibrated) {
         return 0;
     }
 
-    int homeCenter = (homeStartPosition + homeMarkerWidth / 2) % STEPS_PER_REVOLUTION;
-    int stepsFromHomeCenter = (targetPosition - homeCenter + STEPS_PER_REVOLUTION) % STEPS_PER_REVOLUTION;
-    if (stepsFromHomeCenter > STEPS_PER_REVOLUTION / 2) {
-        stepsFromHomeCenter -= STEPS_PER_REVOLUTION;
+    return mphAtPosition((int)round(currentPositionFloat));
+}
+
+float SpeedometerWheel::getTargetMPH() const {
+    if (!isCalibrated) {
+        return 0;
     }
 
-    int stepsFromZero = stepsFromHomeCenter - ZERO_MPH_OFFSET;
-    return constrain(stepsFromZero / STEPS_PER_MPH, MIN_SPEED_MPH, MAX_SPEED_MPH);
+    return mphAtPosition(targetPosition);
 }
 
 void SpeedometerWheel::testStepperMotor() {
@@ -399,7 +708,7 @@ void SpeedometerWheel::testStepperMotor() {
         bool sensorState = readEndstop();
         Serial.println(sensorState ? "TRIGGERED" : "OPEN");
 
-        stepper.step(1);
+        stepAndWait(StepperDrive::MICROSTEPS);
         delay(100);  // Slower for observation
     }
 
@@ -424,15 +733,9 @@ void SpeedometerWheel::continuousStepperTest() {
     Serial.println("Rotating stepper motor clockwise...\n");
 
     while (true) {
-        // Take one step
-        stepper.step(1);
+        // Take one step (wraps the position)
+        singleStep(true);
         stepCount++;
-        currentPosition++;
-
-        // Wrap position
-        if (currentPosition >= STEPS_PER_REVOLUTION) {
-            currentPosition = 0;
-        }
 
         // Check sensor state
         bool currentSensorState = readEndstop();
@@ -479,8 +782,8 @@ void SpeedometerWheel::continuousStepperTest() {
 void SpeedometerWheel::alternativeStepperTest() {
     Serial.println("=== ALTERNATIVE STEPPER TEST ===");
     Serial.println("If the regular stepper isn't working, this might be a pin sequence issue.");
-    Serial.println("The current pin order in constructor is: IN1, IN3, IN2, IN4");
-    Serial.println("For 28BYJ-48, the Arduino Stepper library expects this specific order.");
+    Serial.println("The step generator drives IN1-IN4 in winding order: 1100, 0110, 0011, 1001");
+    Serial.println("For 28BYJ-48, swapped IN2/IN3 wires make the motor buzz instead of turning.");
     Serial.println("Let's try some manual pin control to verify hardware...");
 
     // Set all pins as outputs
@@ -1,14 +1,28 @@
 #ifndef SPEEDOMETER_WHEEL_H
 #define SPEEDOMETER_WHEEL_H
 
-#include <Stepper.h>
 #include <cmath>
 #include "config.h"
+#include "MotionPlanner.h"
+#include "StepGenerator.h"
+#include "StepperDrives.h"
+#include "HardwareStepTimer.h"
+#include "StepScheduler.h"
+#include "DialGeometry.h"
+#include "HomingSequencer.h"
+#include "EndstopEdgeWatch.h"
+#include "NeedleStateStore.h"
+#include "MarkerCrossingDetector.h"
+#include "StepperCharacterizer.h"
+
+typedef StepperDriveSelector<STEPPER_DRIVE_MODE>::type StepperDrive;
 
 class SpeedometerWheel {
 private:
-    Stepper stepper;
-    int currentPosition;        // Current step position
+    StepGenerator<StepperDrive> stepGenerator;  // Steps are emitted from the timer interrupt
+    HardwareStepTimer stepTimer;
+    DialGeometry dial;          // Step/MPH math in drive steps
+    int currentPosition;        // Commanded step position
     int targetPosition;         // Target step position for smooth transitions
     int homeStartPosition;      // Step position where home marker starts
     int homeEndPosition;        // Step position where home marker ends
@@ -16,48 +30,122 @@ private:
     bool isCalibrated;          // Whether home calibration has been completed
     bool isMoving;              // Whether wheel is currently transitioning
 
-    // Smooth movement configuration
-    static const unsigned long SPEED_TRANSITION_TIME_MS = 1200;  // Time to complete speed change
-    unsigned long transitionStartTime;
+    // Drift check: the step interrupt samples the endstop on every tick
+    MarkerCrossingDetector markerWatch;
+    int32_t generatorOffset;    // Wheel position = wrap(generator position + offset)
+    uint32_t driftCorrections;
+    int lastDriftSteps;
+
+    // Home marker search: sweeps stepped out by the timer, ended on the edges
+    // the step interrupt records
+    HomingSequencer homing;
+    EndstopEdgeWatch edgeWatch;
+    int32_t homingMoveStart;    // Generator position the current search move started from
+    float pendingMph;           // Last speed requested while homing or characterizing, applied after
+    bool hasPendingMph;
+
+    // Saved position for warm boots (RTC memory, and flash when parked)
+    NeedleStateStore stateStore;
+    NeedleState savedState;     // As loaded at boot, then as last written to RTC
+    WarmBootDecision warmBoot;
+    bool parkedAtMarker;        // park() - saved to flash once the needle comes to rest
+
+    // Smooth movement: acceleration-limited trajectory in (unwrapped) drive steps,
+    // stepped out at the planner's velocity
+    MotionPlanner planner;
+    StepScheduler stepScheduler;
+    unsigned long lastPlannerMicros;
     float currentPositionFloat;
-    float startPositionFloat;
-    float targetPositionFloat;
 
-    static const int ZERO_MPH_OFFSET = 256;  // Steps from home to 0 MPH position (1/8 revolution)
+    // Motor limits in full steps. The planner gets the tighter of these and the
+    // needle limits; the step timer never runs faster than the motor's step rate.
+    StepperLimits stepperLimits;
+    float needleMaxMphPerSecond;
+    float needleMaxMphPerSecond2;
+    uint32_t stepIntervalUs;
+
+    // Characterization: each trial positions the needle opposite the marker,
+    // makes CHARACTERIZATION_SWEEPS clockwise revolutions at the trial limits,
+    // then one at the range minimum whose crossing catches steps lost after the
+    // last fast one. It passes if every revolution crossed the marker and none
+    // saw drift.
+    StepperCharacterizer characterizer;
+    int trialMove;              // 0 = positioning, then sweeps, then the closing revolution
+    uint32_t trialCrossings;    // Marker crossings when the sweeps began
+    uint32_t trialDriftCorrections;
+
+    static const int CHARACTERIZATION_SWEEPS = 3;
+
+    static bool IRAM_ATTR onStepTick(void* context);
 
     // Private helper methods
     bool readEndstop();
     void singleStep(bool clockwise);
-    int findEdge(bool clockwise, bool risingEdge);
-    float easeInOutCubic(float t);
-    void updateStepperPosition();
-    int shortestPath(int from, int to);
+    void stepAndWait(int steps);  // Blocking - calibration and bench tests only
+    void updateHoming();
+    void finishHoming();
+    void prepareHoming();
+    void updateMotion();
+    void startMove(float plannerTarget);
+    void applyStepperLimits(const StepperLimits& limits, bool needleLimited);
+    void startCharacterizationTrial();
+    void updateCharacterization();
+    void finishCharacterization();
+    void persistState(bool toFlash);
+    void checkDrift();
+    int getParkPosition() const;  // Where a verify pass starts, on the 0 MPH side of the marker
+    void settleAt(int position);  // Stationary at a known position (after calibration/homing)
+    void updateStepperPosition(float position);
+    int getHomeCenter() const { return dial.wrap(homeStartPosition + homeMarkerWidth / 2); }
+    float mphAtPosition(int position) const { return dial.mphAtPosition(position, getHomeCenter()); }
 
 public:
-    SpeedometerWheel();
+    // Saved needle state lives in rtcStorage (survives resets) and flashStorage (survives power-off)
+    SpeedometerWheel(ParameterStorage& rtcStorage, ParameterStorage& flashStorage);
 
     // Initialization and calibration
+    WarmBootDecision restoreState(); // Before begin(); a warm boot skips the bench tests
     void begin();
-    bool calibrateHome();
+    void startCalibration();         // Warm boot if restoreState() allowed it, else startHoming()
+    void startHoming();              // Non-blocking - update() runs the search
+    bool calibrateHome();            // Blocking wrapper around startHoming()
+    bool startCharacterization();    // Non-blocking search for the motor's step rate/acceleration limits
 
     // Update method - call this regularly in your main loop
     void update();
 
     // Movement methods
-    void moveToMPH(int mph);
+    void moveToMPH(float mph);
+    void setMotionLimits(float maxMphPerSecond, float maxMphPerSecondSquared);
+    void setStepperLimits(float maxFullStepsPerSecond, float maxFullStepsPerSecondSquared);
+    bool setDialCalibration(const uint16_t fullStepsAtKnot[DIAL_CALIBRATION_POINTS]);
     bool homeWheel();
+    void saveState();                // Parked - write the position to flash
+    void park();                     // Engine off - rest beside the marker and save there
 
     // Getters
     int getCurrentPosition() const { return (int)round(currentPositionFloat); }
     int getTargetPosition() const { return targetPosition; }
-    int getCurrentMPH() const;
-    int getTargetMPH() const;
+    float getCurrentMPH() const;
+    float getTargetMPH() const;
     int getHomeMarkerWidth() const { return homeMarkerWidth; }
+    const DialGeometry& getDial() const { return dial; }
     bool getCalibrationStatus() const { return isCalibrated; }
-    bool isInTransition() const { return isMoving; }
+    HomingStatus getHomingStatus() const { return homing.getStatus(); }
+    bool isHoming() const { return homing.isActive(); }
+    bool isParked() const { return parkedAtMarker; }
+    const HomingSequencer& getHoming() const { return homing; }
+    WarmBootDecision getWarmBootDecision() const { return warmBoot; }
+    uint32_t getDriftCorrections() const { return driftCorrections; }
+    int getLastDriftSteps() const { return lastDriftSteps; }  // Positive = needle had fallen behind
+    const NeedleStateStore& getStateStore() const { return stateStore; }
+    bool isCharacterizing() const { return characterizer.isActive(); }
+    const StepperCharacterizer& getCharacterizer() const { return characterizer; }
+    StepperLimits getStepperLimits() const { return stepperLimits; }
+    bool isInTransition() const { return isMoving || stepGenerator.isMoving(); }
 
     // Utility methods
-    int stepsFromHome(int mph);
+    int stepsFromHome(float mph) const { return dial.stepsFromHome(mph); }
     int shortestPathToHome();
     void testStepperMotor();         // Test stepper motor functionality
     void continuousStepperTest();    // Continuous stepper rotation with sensor monitoring
@@ -0,0 +1,125 @@
+#ifndef STEP_GENERATOR_H
+#define STEP_GENERATOR_H
+
+#include <stdint.h>
+
+// IRAM_ATTR comes from the ESP32 core; define it away so this header also builds on the host
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// One coil energization pattern as GPIO set/clear masks, so a step is a
+// handful of register writes with no per-pin work
+struct CoilPhase {
+    uint32_t setLow;      // GPIO 0-31 to drive high
+    uint32_t clearLow;    // GPIO 0-31 to drive low
+    uint32_t setHigh;     // GPIO 32-39 to drive high (bit 0 = GPIO 32)
+    uint32_t clearHigh;   // GPIO 32-39 to drive low
+};
+
+// Masks for a coil pattern (bit n = coil n on, coils in winding order)
+inline CoilPhase makeCoilPhase(const int pins[4], uint8_t pattern) {
+    CoilPhase coil = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; i++) {
+        bool on = pattern & (1 << i);
+        if (pins[i] < 32) {
+            (on ? coil.setLow : coil.clearLow) |= 1UL << pins[i];
+        } else {
+            (on ? coil.setHigh : coil.clearHigh) |= 1UL << (pins[i] - 32);
+        }
+    }
+    return coil;
+}
+
+// Unipolar stepper step generator. tick() is called from a timer interrupt and
+// emits at most one step towards the target, so the step rate is the timer
+// rate and the main loop only ever moves the target. Positions are unwrapped
+// counts of drive steps (full, half or micro - see StepperDrives.h).
+//
+// Drive must provide:
+//   typedef ... Phase;                      // Precomputed output state for one step
+//   static const int MICROSTEPS;            // Drive steps per motor full step
+//   static const int PHASE_COUNT;           // Power of two
+//   static void buildPhases(const int pins[4], Phase* phases);
+//   static void begin(const int pins[4]);
+//   static void apply(const Phase& phase);  // IRAM_ATTR, no flash-resident calls
+template <typename Drive>
+class StepGenerator {
+public:
+    typedef typename Drive::Phase Phase;
+
+private:
+    static_assert((Drive::PHASE_COUNT & (Drive::PHASE_COUNT - 1)) == 0,
+                  "StepGenerator phase count must be a power of two");
+
+    int pins[4];
+    Phase phases[Drive::PHASE_COUNT];
+    volatile int32_t position;       // Last step emitted (written by tick() only)
+    volatile int32_t target;         // Written by the main loop only
+    volatile uint16_t phase;
+    volatile uint32_t stepCount;
+
+public:
+    // Coils in winding order (IN1-IN4 on a ULN2003 board)
+    StepGenerator(int pin1, int pin2, int pin3, int pin4)
+        : position(0), target(0), phase(0), stepCount(0) {
+        pins[0] = pin1;
+        pins[1] = pin2;
+        pins[2] = pin3;
+        pins[3] = pin4;
+        Drive::buildPhases(pins, phases);
+    }
+
+    // Configure the outputs and drive the current phase
+    void begin() {
+        Drive::begin(pins);
+        energize();
+    }
+
+    // Timer interrupt body; returns true if a step was taken
+    inline IRAM_ATTR bool tick() {
+        int32_t current = position;
+        int32_t goal = target;
+        if (current == goal) {
+            return false;
+        }
+
+        int direction = goal > current ? 1 : -1;
+        uint16_t next = (uint16_t)((phase + direction) & (Drive::PHASE_COUNT - 1));
+        Drive::apply(phases[next]);
+        phase = next;
+        position = current + direction;
+        stepCount = stepCount + 1;
+        return true;
+    }
+
+    // Drive the current phase so the rotor holds (and snaps to) a known position
+    void energize() { Drive::apply(phases[phase]); }
+
+    // Resume from a saved phase before begin(), so re-energizing holds the
+    // rotor in the detent it is already sitting in
+    void setPhase(uint16_t savedPhase) { phase = savedPhase & (Drive::PHASE_COUNT - 1); }
+
+    // Phase the coils will be in once the target is reached. Retries if a
+    // tick lands between the reads.
+    uint16_t getTargetPhase() const {
+        int32_t before;
+        uint16_t current;
+        do {
+            before = position;
+            current = phase;
+        } while (before != position);
+        return (uint16_t)((current + (target - before)) & (Drive::PHASE_COUNT - 1));
+    }
+
+    void moveTo(int32_t steps) { target = steps; }
+    void moveBy(int32_t steps) { target = target + steps; }
+
+    int32_t getPosition() const { return position; }
+    int32_t getTarget() const { return target; }
+    bool isMoving() const { return position != target; }
+    uint32_t getStepCount() const { return stepCount; }
+    const Phase& getPhase(int index) const { return phases[index]; }
+};
+
+#endif // STEP_GENERATOR_H
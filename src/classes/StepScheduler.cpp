@@ -0,0 +1,36 @@
+#include "StepScheduler.h"
+#include <math.h>
+
+StepScheduler::StepScheduler(uint32_t minIntervalMicros)
+	: minIntervalUs(minIntervalMicros > 0 ? minIntervalMicros : 1) {
+}
+
+float StepScheduler::leadPosition(float position, float velocity, float target, float updateSeconds) const {
+    float lead = position + velocity * updateSeconds * LEAD_UPDATES;
+
+    // A decelerating needle would otherwise be stepped past its target and back.
+    // Only a lead that crosses the target is cut: after a reversing retarget the
+    // planner is still moving away from it, and so must the generator.
+    if ((lead - target) * (position - target) < 0.0f) {
+        lead = target;
+    }
+    return lead;
+}
+
+uint32_t StepScheduler::interval(float velocity, float backlogSteps, float updateSeconds) const {
+    // In steady motion the backlog is the lead itself; more means the generator
+    // fell behind, less that it is about to reach the target early
+    float speed = fabsf(velocity);
+    float backlog = velocity < 0.0f ? -backlogSteps : backlogSteps;   // Along the motion
+    if (speed == 0.0f) {
+        backlog = fabsf(backlogSteps);
+    }
+    float rate = speed + (backlog - speed * updateSeconds * LEAD_UPDATES) / CATCH_UP_SECONDS;
+
+    float slowest = 1000000.0f / MAX_INTERVAL_US;
+    if (rate <= slowest) {
+        return MAX_INTERVAL_US > minIntervalUs ? MAX_INTERVAL_US : minIntervalUs;
+    }
+    float intervalUs = 1000000.0f / rate;
+    return intervalUs > minIntervalUs ? (uint32_t)intervalUs : minIntervalUs;
+}
@@ -0,0 +1,36 @@
+#ifndef STEP_SCHEDULER_H
+#define STEP_SCHEDULER_H
+
+#include <stdint.h>
+
+// Paces the step generator from the motion planner. Each loop update hands the
+// generator a target that leads the planner by LEAD_UPDATES update periods
+// (never past the planner's own target) and sets the step timer to 1/|v|,
+// corrected for any backlog so the generator stays that far behind the target.
+// Steps then come out evenly spaced at the planner's velocity instead of in a
+// burst at the motor's top rate after every update. No Arduino dependencies.
+class StepScheduler {
+private:
+    uint32_t minIntervalUs;       // Motor's top step rate
+
+public:
+    static const int LEAD_UPDATES = 2;              // Loop jitter must not let the generator reach the target early
+    static constexpr float CATCH_UP_SECONDS = 0.05f;   // Backlog error is worked off over this long
+    static const uint32_t MAX_INTERVAL_US = 20000;  // Slowest tick: a creeping or settling needle still steps within 20 ms
+
+    explicit StepScheduler(uint32_t minIntervalMicros);
+
+    void setMinInterval(uint32_t intervalMicros) { minIntervalUs = intervalMicros > 0 ? intervalMicros : 1; }
+    uint32_t getMinInterval() const { return minIntervalUs; }
+
+    // Position the generator should be heading for after an update updateSeconds after the last
+    float leadPosition(float position, float velocity, float target, float updateSeconds) const;
+
+    // Step timer interval for a generator backlogSteps short of the lead
+    // position. Fractional: the target is the lead rounded to a whole step,
+    // and the step underway is the timer's period fraction along; counted in
+    // whole steps, the rate would hunt by 1/CATCH_UP_SECONDS every update.
+    uint32_t interval(float velocity, float backlogSteps, float updateSeconds) const;
+};
+
+#endif // STEP_SCHEDULER_H
@@ -0,0 +1,144 @@
+#include "StepperCharacterizer.h"
+#include <math.h>
+
+const float StepperCharacterizer::RATE_GROWTH = 1.25f;
+const float StepperCharacterizer::ACCELERATION_GROWTH = 1.5f;
+const float StepperCharacterizer::RESOLUTION = 1.05f;
+const float StepperCharacterizer::SAFETY_MARGIN = 0.8f;
+
+void StepperCharacterizer::LimitSearch::start(float minimum, float searchMaximum, float searchGrowth, float knownGood) {
+    maximum = searchMaximum;
+    growth = searchGrowth;
+    passed = knownGood;
+    failed = 0.0f;
+    candidate = knownGood > 0.0f ? fminf(knownGood * growth, maximum) : minimum;
+}
+
+bool StepperCharacterizer::LimitSearch::report(bool trialPassed) {
+    if (trialPassed) {
+        passed = candidate;
+    } else {
+        failed = candidate;
+    }
+
+    if (passed <= 0.0f) {
+        return false;  // The minimum itself failed
+    }
+    if (failed <= 0.0f) {
+        // Still climbing
+        if (passed >= maximum) {
+            return false;
+        }
+        candidate = fminf(passed * growth, maximum);
+        return true;
+    }
+    if (failed <= passed * RESOLUTION) {
+        return false;
+    }
+    candidate = sqrtf(passed * failed);  // Geometric midpoint: limits scale, they don't add
+    return true;
+}
+
+StepperCharacterizer::StepperCharacterizer()
+	: status(CHARACTERIZE_IDLE),
+	  trialCount(0) {
+    range.minimum.stepsPerSecond = 0.0f;
+    range.minimum.stepsPerSecond2 = 0.0f;
+    range.maximum = range.minimum;
+    range.rampSteps = 1.0f;
+    best = range.minimum;
+    rateSearch.start(0.0f, 0.0f, RATE_GROWTH, 0.0f);
+    accelerationSearch.start(0.0f, 0.0f, ACCELERATION_GROWTH, 0.0f);
+}
+
+float StepperCharacterizer::rampAcceleration(float stepsPerSecond) const {
+    // Rate trials must actually reach the rate, but shouldn't probe acceleration
+    // any harder than that - it gets its own search afterwards
+    float acceleration = stepsPerSecond * stepsPerSecond / (2.0f * range.rampSteps);
+    return fminf(fmaxf(acceleration, range.minimum.stepsPerSecond2), range.maximum.stepsPerSecond2);
+}
+
+void StepperCharacterizer::start(const CharacterizationRange& searchRange) {
+    range = searchRange;
+    if (range.rampSteps < 1.0f) {
+        range.rampSteps = 1.0f;
+    }
+    trialCount = 0;
+    best.stepsPerSecond = 0.0f;
+    best.stepsPerSecond2 = 0.0f;
+    rateSearch.start(range.minimum.stepsPerSecond, range.maximum.stepsPerSecond, RATE_GROWTH, 0.0f);
+    status = CHARACTERIZE_RATE;
+}
+
+void StepperCharacterizer::cancel() {
+    if (isActive()) {
+        status = CHARACTERIZE_FAILED;
+    }
+}
+
+bool StepperCharacterizer::getTrial(StepperLimits& trial) const {
+    if (status == CHARACTERIZE_RATE) {
+        trial.stepsPerSecond = rateSearch.candidate;
+        trial.stepsPerSecond2 = rampAcceleration(rateSearch.candidate);
+        return true;
+    }
+    if (status == CHARACTERIZE_ACCELERATION) {
+        trial.stepsPerSecond = best.stepsPerSecond * SAFETY_MARGIN;
+        trial.stepsPerSecond2 = accelerationSearch.candidate;
+        return true;
+    }
+    return false;
+}
+
+void StepperCharacterizer::report(bool passed) {
+    if (!isActive()) {
+        return;
+    }
+    trialCount++;
+
+    if (status == CHARACTERIZE_RATE) {
+        if (rateSearch.report(passed)) {
+            return;
+        }
+        if (rateSearch.passed <= 0.0f) {
+            status = CHARACTERIZE_FAILED;
+            return;
+        }
+
+        // The best rate passed at its ramp acceleration, so that is where the
+        // acceleration search starts. It runs at the derated rate the result
+        // will use: right at the rate limit, occasional skips would be blamed
+        // on the acceleration.
+        best.stepsPerSecond = rateSearch.passed;
+        best.stepsPerSecond2 = rampAcceleration(rateSearch.passed);
+        accelerationSearch.start(range.minimum.stepsPerSecond2, range.maximum.stepsPerSecond2,
+                                 ACCELERATION_GROWTH, best.stepsPerSecond2);
+        status = best.stepsPerSecond2 < range.maximum.stepsPerSecond2 ? CHARACTERIZE_ACCELERATION
+                                                                       : CHARACTERIZE_COMPLETE;
+        return;
+    }
+
+    bool searching = accelerationSearch.report(passed);
+    best.stepsPerSecond2 = accelerationSearch.passed;
+    if (!searching) {
+        status = CHARACTERIZE_COMPLETE;
+    }
+}
+
+StepperLimits StepperCharacterizer::getRecommended() const {
+    StepperLimits recommended;
+    recommended.stepsPerSecond = best.stepsPerSecond * SAFETY_MARGIN;
+    recommended.stepsPerSecond2 = best.stepsPerSecond2 * SAFETY_MARGIN;
+    return recommended;
+}
+
+const char* StepperCharacterizer::statusName(CharacterizationStatus status) {
+    switch (status) {
+    case CHARACTERIZE_IDLE:         return "idle";
+    case CHARACTERIZE_RATE:         return "searching step rate";
+    case CHARACTERIZE_ACCELERATION: return "searching acceleration";
+    case CHARACTERIZE_COMPLETE:     return "complete";
+    case CHARACTERIZE_FAILED:       return "failed";
+    }
+    return "unknown";
+}
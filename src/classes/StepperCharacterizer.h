@@ -0,0 +1,84 @@
+#ifndef STEPPER_CHARACTERIZER_H
+#define STEPPER_CHARACTERIZER_H
+
+// Step rate and acceleration a motor is driven at, in motor full steps
+struct StepperLimits {
+    float stepsPerSecond;
+    float stepsPerSecond2;
+};
+
+// Where the search starts and stops
+struct CharacterizationRange {
+    StepperLimits minimum;   // First trial; a motor that fails here fails the run
+    StepperLimits maximum;   // Never tried above these
+    float rampSteps;         // Rate trials accelerate hard enough to reach the rate within this many steps
+};
+
+enum CharacterizationStatus {
+    CHARACTERIZE_IDLE = 0,
+    CHARACTERIZE_RATE,           // Raising the step rate at a modest acceleration
+    CHARACTERIZE_ACCELERATION,   // Raising the acceleration at the best rate
+    CHARACTERIZE_COMPLETE,
+    CHARACTERIZE_FAILED          // Lost steps at the minimum limits, or cancelled
+};
+
+// Search for the fastest step rate and acceleration a motor follows without
+// losing steps. The caller runs each trial handed out by getTrial() - sweeps
+// past the home marker at those limits - and reports whether the marker stayed
+// where calibration put it. The rate is searched first, then the acceleration
+// at the derated rate: each grows geometrically from the minimum until a trial
+// fails, then is bisected between the last pass and the first failure. The
+// result is derated by SAFETY_MARGIN so supply sag and a warm motor still have
+// headroom.
+// No Arduino dependencies.
+class StepperCharacterizer {
+private:
+    // One limit, bracketed between the highest pass and the lowest failure
+    struct LimitSearch {
+        float maximum;
+        float growth;
+        float passed;        // 0 = nothing passed yet
+        float failed;        // 0 = nothing failed yet
+        float candidate;
+
+        void start(float minimum, float maximum, float growth, float knownGood);
+        bool report(bool trialPassed);  // True while more trials are needed
+    };
+
+    CharacterizationRange range;
+    CharacterizationStatus status;
+    LimitSearch rateSearch;
+    LimitSearch accelerationSearch;
+    StepperLimits best;
+    int trialCount;
+
+    float rampAcceleration(float stepsPerSecond) const;
+
+public:
+    static const float RATE_GROWTH;
+    static const float ACCELERATION_GROWTH;
+    static const float RESOLUTION;       // Stop bisecting once failure/pass is within this ratio
+    static const float SAFETY_MARGIN;
+
+    StepperCharacterizer();
+
+    void start(const CharacterizationRange& searchRange);
+    void cancel();
+
+    // The limits to try next; false once the search has finished
+    bool getTrial(StepperLimits& trial) const;
+
+    // Outcome of the trial last returned by getTrial()
+    void report(bool passed);
+
+    CharacterizationStatus getStatus() const { return status; }
+    bool isActive() const { return status == CHARACTERIZE_RATE || status == CHARACTERIZE_ACCELERATION; }
+    int getTrialCount() const { return trialCount; }
+    const CharacterizationRange& getRange() const { return range; }
+    StepperLimits getBest() const { return best; }     // Highest limits that passed
+    StepperLimits getRecommended() const;             // getBest() derated by SAFETY_MARGIN
+
+    static const char* statusName(CharacterizationStatus status);
+};
+
+#endif // STEPPER_CHARACTERIZER_H
@@ -0,0 +1,185 @@
+#ifndef STEPPER_DRIVES_H
+#define STEPPER_DRIVES_H
+
+#include <math.h>
+#include "config.h"
+#include "StepGenerator.h"
+
+#if defined(ESP32)
+#include <Arduino.h>
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "soc/ledc_reg.h"
+#include "driver/ledc.h"
+#endif
+
+// Coil drive modes for StepGenerator (see the Drive requirements there).
+// Every position in SpeedometerWheel is counted in drive steps, so the dial
+// math scales with MICROSTEPS automatically.
+enum StepperDriveMode {
+    STEPPER_DRIVE_FULL = 0,    // Two coils on, 4 phases - STEPS_PER_REVOLUTION steps/rev
+    STEPPER_DRIVE_HALF = 1,    // Alternating one/two coils, 8 phases - twice the resolution
+    STEPPER_DRIVE_MICRO = 2    // Sine/cosine PWM on the coils - STEPPER_MICROSTEPS per full step
+};
+
+// Applies a coil pattern through the ESP32 write-1-to-set/clear registers.
+// Atomic per bank, so nothing else sharing the port can be disturbed.
+struct GpioCoilOutput {
+    static inline IRAM_ATTR void apply(const CoilPhase& phase) {
+#if defined(ESP32)
+        REG_WRITE(GPIO_OUT_W1TC_REG, phase.clearLow);
+        REG_WRITE(GPIO_OUT_W1TS_REG, phase.setLow);
+        REG_WRITE(GPIO_OUT1_W1TC_REG, phase.clearHigh);
+        REG_WRITE(GPIO_OUT1_W1TS_REG, phase.setHigh);
+#else
+        (void)phase;
+#endif
+    }
+
+    static void begin(const int pins[4]) {
+#if defined(ESP32)
+        for (int i = 0; i < 4; i++) {
+            pinMode(pins[i], OUTPUT);
+        }
+#else
+        (void)pins;
+#endif
+    }
+};
+
+// Full step: 1100, 0110, 0011, 1001
+struct FullStepDrive {
+    typedef CoilPhase Phase;
+    static const int MICROSTEPS = 1;
+    static const int PHASE_COUNT = 4;
+    static const char* name() { return "full-step"; }
+
+    static void buildPhases(const int pins[4], Phase* phases) {
+        static const uint8_t SEQUENCE[PHASE_COUNT] = { 0x3, 0x6, 0xC, 0x9 };
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            phases[i] = makeCoilPhase(pins, SEQUENCE[i]);
+        }
+    }
+
+    static void begin(const int pins[4]) { GpioCoilOutput::begin(pins); }
+    static inline IRAM_ATTR void apply(const Phase& phase) { GpioCoilOutput::apply(phase); }
+};
+
+// Half step: 1000, 1100, 0100, 0110, 0010, 0011, 0001, 1001. Odd phases match
+// the full-step ones, so both modes agree on direction.
+struct HalfStepDrive {
+    typedef CoilPhase Phase;
+    static const int MICROSTEPS = 2;
+    static const int PHASE_COUNT = 8;
+    static const char* name() { return "half-step"; }
+
+    static void buildPhases(const int pins[4], Phase* phases) {
+        static const uint8_t SEQUENCE[PHASE_COUNT] = { 0x1, 0x3, 0x2, 0x6, 0x4, 0xC, 0x8, 0x9 };
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            phases[i] = makeCoilPhase(pins, SEQUENCE[i]);
+        }
+    }
+
+    static void begin(const int pins[4]) { GpioCoilOutput::begin(pins); }
+    static inline IRAM_ATTR void apply(const Phase& phase) { GpioCoilOutput::apply(phase); }
+};
+
+// PWM duty for each coil at one micro-step
+struct PwmPhase {
+    uint16_t duty[4];
+};
+
+// Micro-stepping through four LEDC channels. IN1/IN3 are the two halves of
+// winding A and IN2/IN4 of winding B, so the coil currents follow cos/sin of
+// the electrical angle (90 degrees per full step). The ULN2003 only switches,
+// so the winding inductance does the smoothing at the 20 kHz carrier.
+template <int Microsteps>
+struct MicroStepDrive {
+    static_assert(Microsteps >= 2 && (Microsteps & (Microsteps - 1)) == 0,
+                  "Micro-steps per full step must be a power of two");
+
+    typedef PwmPhase Phase;
+    static const int MICROSTEPS = Microsteps;
+    static const int PHASE_COUNT = 4 * Microsteps;
+    static const int PWM_BITS = 10;
+    static const uint32_t PWM_FREQUENCY = 20000;  // Above hearing
+    static const char* name() { return "micro-step"; }
+
+    static void buildPhases(const int[4], Phase* phases) {  // Pins are bound to channels in begin()
+        const float maxDuty = (float)((1 << PWM_BITS) - 1);
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            // Phase 0 sits at 45 degrees, where full-step phase 0 (IN1+IN2) is
+            float angle = (i + Microsteps / 2) * (float)M_PI / (2.0f * Microsteps);
+            float a = cosf(angle);
+            float b = sinf(angle);
+            phases[i].duty[0] = (uint16_t)lroundf((a > 0.0f ? a : 0.0f) * maxDuty);
+            phases[i].duty[1] = (uint16_t)lroundf((b > 0.0f ? b : 0.0f) * maxDuty);
+            phases[i].duty[2] = (uint16_t)lroundf((a < 0.0f ? -a : 0.0f) * maxDuty);
+            phases[i].duty[3] = (uint16_t)lroundf((b < 0.0f ? -b : 0.0f) * maxDuty);
+        }
+    }
+
+    static void begin(const int pins[4]) {
+#if defined(ESP32)
+        ledc_timer_config_t timerConfig = {};
+        timerConfig.speed_mode = LEDC_HIGH_SPEED_MODE;
+        timerConfig.duty_resolution = (ledc_timer_bit_t)PWM_BITS;
+        timerConfig.timer_num = (ledc_timer_t)STEPPER_LEDC_TIMER;
+        timerConfig.freq_hz = PWM_FREQUENCY;
+        timerConfig.clk_cfg = LEDC_AUTO_CLK;
+        ledc_timer_config(&timerConfig);
+
+        for (int i = 0; i < 4; i++) {
+            ledc_channel_config_t channelConfig = {};
+            channelConfig.gpio_num = pins[i];
+            channelConfig.speed_mode = LEDC_HIGH_SPEED_MODE;
+            channelConfig.channel = (ledc_channel_t)(STEPPER_LEDC_CHANNEL_BASE + i);
+            channelConfig.timer_sel = (ledc_timer_t)STEPPER_LEDC_TIMER;
+            channelConfig.duty = 0;
+            ledc_channel_config(&channelConfig);
+            ledc_update_duty(LEDC_HIGH_SPEED_MODE, channelConfig.channel);  // Output enabled from here on
+        }
+#else
+        (void)pins;
+#endif
+    }
+
+    // The LEDC driver is flash-resident and takes a lock, so the step interrupt
+    // writes the channel registers itself: the duty (4 fractional bits), then
+    // a one-cycle, no-fade update that latches it at the next PWM period. The
+    // same sequence ledc_set_duty() + ledc_update_duty() perform.
+    static inline IRAM_ATTR void apply(const Phase& phase) {
+#if defined(ESP32)
+        const uint32_t channelStride = LEDC_HSCH1_DUTY_REG - LEDC_HSCH0_DUTY_REG;
+        const uint32_t update = LEDC_DUTY_START_HSCH0 | LEDC_DUTY_INC_HSCH0 |
+                                (1 << LEDC_DUTY_NUM_HSCH0_S) | (1 << LEDC_DUTY_CYCLE_HSCH0_S);
+        for (int i = 0; i < 4; i++) {
+            uint32_t offset = (STEPPER_LEDC_CHANNEL_BASE + i) * channelStride;
+            REG_WRITE(LEDC_HSCH0_DUTY_REG + offset, (uint32_t)phase.duty[i] << 4);
+            REG_WRITE(LEDC_HSCH0_CONF1_REG + offset, update);
+        }
+#else
+        (void)phase;
+#endif
+    }
+};
+
+template <int Mode>
+struct StepperDriveSelector;
+
+template <>
+struct StepperDriveSelector<STEPPER_DRIVE_FULL> {
+    typedef FullStepDrive type;
+};
+
+template <>
+struct StepperDriveSelector<STEPPER_DRIVE_HALF> {
+    typedef HalfStepDrive type;
+};
+
+template <>
+struct StepperDriveSelector<STEPPER_DRIVE_MICRO> {
+    typedef MicroStepDrive<STEPPER_MICROSTEPS> type;
+};
+
+#endif // STEPPER_DRIVES_H
@@ -0,0 +1,36 @@
+#ifndef TACH_MONITOR_H
+#define TACH_MONITOR_H
+
+#include "config.h"
+#include "PulseMonitor.h"
+
+// PCNT has only a 12.8us glitch filter, so every ring of the coil would count as a spark
+static_assert(TACH_PULSE_BACKEND != PULSE_BACKEND_PCNT,
+              "TACH_PULSE_BACKEND cannot be PCNT - it can't apply the spark-ringing lockout");
+
+// A four-stroke engine fires every cylinder once per two crank revolutions
+static_assert(TACH_CYLINDERS >= 2 && TACH_CYLINDERS % 2 == 0,
+              "TACH_CYLINDERS must be even - odd cylinder counts give fractional pulses per revolution");
+
+// Ignition (coil negative / tach output) signal configuration for PulseMonitor
+struct TachPulseConfig {
+    static const PulseBackendType BACKEND = TACH_PULSE_BACKEND;
+    static const int PIN_B = -1;                     // Ignition has no direction
+    static const int PULSES_PER_REV = TACH_CYLINDERS / 2;
+    static const size_t QUEUE_SIZE = 64;
+
+    // Spark ringing: the coil primary oscillates for a millisecond or more after
+    // each spark. Lock out half a spark period at the redline, which drops the
+    // ringing but still leaves 2x headroom above TACH_MAX_RPM.
+    static const uint32_t MIN_EDGE_SPACING_US = 60000000UL / ((uint32_t)TACH_MAX_RPM * PULSES_PER_REV) / 2;
+
+    static const int PCNT_UNIT = 1;                  // PCNT backend only
+    static const int PCNT_FILTER_TICKS = 1023;       // PCNT backend only: 12.8us glitch filter
+    static const int MCPWM_UNIT = 1;                 // MCPWM capture backend only
+    static const int MCPWM_CAPTURE = 0;              // MCPWM capture backend only
+    static const char* name() { return "TachMonitor"; }
+};
+
+typedef PulseMonitor<TACH_SENSOR_PIN, TachPulseConfig> TachMonitor;
+
+#endif // TACH_MONITOR_H
@@ -0,0 +1,90 @@
+#include "TimedGearClassifier.h"
+#include <math.h>
+
+TimedGearClassifier::TimedGearClassifier(const VehicleFactors* vehicleFactors)
+	: factors(vehicleFactors),
+	  stabilityTimeoutMs(750),
+	  confirmedGear(NEUTRAL),
+	  candidateGear(NEUTRAL),
+	  candidateStartMillis(0),
+	  lastValidMillis(0) {
+}
+
+Gear TimedGearClassifier::update(float engineRPM, float driveshaftRPM, uint32_t nowMillis) {
+    Gear detectedGear = detect(engineRPM, driveshaftRPM);
+
+    // If detected gear matches candidate, continue timing
+    if (detectedGear == candidateGear) {
+        // Check if gear has been stable long enough
+        if (nowMillis - candidateStartMillis >= stabilityTimeoutMs) {
+            lastValidMillis = nowMillis;
+            confirmedGear = candidateGear;
+        }
+        // Otherwise keep the current gear until this candidate is confirmed
+        return confirmedGear;
+    }
+
+    // New gear detected - start timing
+    candidateGear = detectedGear;
+    candidateStartMillis = nowMillis;
+
+    // If we haven't had a valid gear for too long, default to neutral
+    if (nowMillis - lastValidMillis > stabilityTimeoutMs) {
+        confirmedGear = NEUTRAL;
+    }
+    return confirmedGear;
+}
+
+Gear TimedGearClassifier::detect(float engineRPM, float driveshaftRPM) const {
+    // Handle special cases - low RPM indicates neutral or stopped
+    if (engineRPM < MIN_ENGINE_RPM || fabsf(driveshaftRPM) < MIN_DRIVESHAFT_RPM) {
+        return NEUTRAL;
+    }
+
+    // Convert once; every gear test below reuses the sample
+    RatioSample sample;
+#if USE_FIXED_POINT_MATH
+    sample.engineRPM = Q16::fromFloat(engineRPM);
+    sample.shaftRPM = Q16::fromFloat(fabsf(driveshaftRPM));
+#else
+    sample.engineRPM = engineRPM;
+    sample.shaftRPM = fabsf(driveshaftRPM);
+#endif
+
+    // A reversing driveshaft can only mean reverse gear
+    if (driveshaftRPM < 0) {
+        return isGearRatioValid(sample, REVERSE) ? REVERSE : NEUTRAL;
+    }
+
+    // Check the forward gears fitted to this profile
+    for (int i = GEAR_1; i < GEAR_COUNT; i++) {
+        if (isGearRatioValid(sample, static_cast<Gear>(i))) {
+            return static_cast<Gear>(i);
+        }
+    }
+
+    // No valid gear ratio found - likely shifting or clutch disengaged
+    return NEUTRAL;
+}
+
+bool TimedGearClassifier::isGearRatioValid(const RatioSample& sample, Gear gear) const {
+    if (gear < REVERSE || gear >= GEAR_COUNT || factors->enginePerDriveshaft[gear] <= 0.0f) {
+        return false;
+    }
+
+    // Ratio window scaled by shaft speed, instead of dividing engine by shaft RPM
+#if USE_FIXED_POINT_MATH
+    return sample.engineRPM >= Q16::mulWide(sample.shaftRPM, factors->enginePerDriveshaftMinFixed[gear]) &&
+           sample.engineRPM <= Q16::mulWide(sample.shaftRPM, factors->enginePerDriveshaftMaxFixed[gear]);
+#else
+    return sample.engineRPM >= sample.shaftRPM * factors->enginePerDriveshaftMin[gear] &&
+           sample.engineRPM <= sample.shaftRPM * factors->enginePerDriveshaftMax[gear];
+#endif
+}
+
+void TimedGearClassifier::reset(Gear shownGear, uint32_t nowMillis) {
+    confirmedGear = shownGear;
+    candidateGear = shownGear;
+    candidateStartMillis = nowMillis;
+    lastValidMillis = nowMillis;
+}
@@ -0,0 +1,56 @@
+#ifndef TIMED_GEAR_CLASSIFIER_H
+#define TIMED_GEAR_CLASSIFIER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "VehicleParameters.h"
+
+// Fixed-tolerance gear classifier: a sample matches a gear when its
+// engine/driveshaft ratio falls inside that gear's window (see
+// deriveVehicleFactors()), and a gear is confirmed once it has matched on every
+// sample for the stability timeout. If nothing is confirmed for that long the
+// gear drops to NEUTRAL. Pure logic with no Arduino dependencies.
+class TimedGearClassifier {
+private:
+    static constexpr float MIN_ENGINE_RPM = 100.0f;     // Below this the engine is stopped or idling in neutral
+    static constexpr float MIN_DRIVESHAFT_RPM = 10.0f;
+
+    // One engine/driveshaft sample in the number format selected by USE_FIXED_POINT_MATH
+    struct RatioSample {
+#if USE_FIXED_POINT_MATH
+        Q16::fixed engineRPM;
+        Q16::fixed shaftRPM;     // Magnitude - direction is handled separately
+#else
+        float engineRPM;
+        float shaftRPM;
+#endif
+    };
+
+    const VehicleFactors* factors;
+    uint32_t stabilityTimeoutMs;
+    Gear confirmedGear;
+    Gear candidateGear;          // Gear being evaluated for stability
+    uint32_t candidateStartMillis;
+    uint32_t lastValidMillis;
+
+    bool isGearRatioValid(const RatioSample& sample, Gear gear) const;
+
+public:
+    explicit TimedGearClassifier(const VehicleFactors* vehicleFactors);
+
+    // Feed one sample; returns the confirmed gear
+    Gear update(float engineRPM, float driveshaftRPM, uint32_t nowMillis);
+
+    // Gear whose window this sample falls in, NEUTRAL if none
+    Gear detect(float engineRPM, float driveshaftRPM) const;
+
+    // Restart timing with shownGear as the confirmed gear
+    void reset(Gear shownGear, uint32_t nowMillis);
+
+    void setStabilityTimeout(uint32_t ms) { stabilityTimeoutMs = ms; }
+    uint32_t getStabilityTimeout() const { return stabilityTimeoutMs; }
+    Gear getConfirmedGear() const { return confirmedGear; }
+    Gear getCandidateGear() const { return candidateGear; }
+};
+
+#endif // TIMED_GEAR_CLASSIFIER_H
@@ -0,0 +1,103 @@
+#include "ToothCorrection.h"
+
+ToothCorrection::ToothCorrection()
+	: toothCount(1),
+	  toothIndex(0),
+	  learningRate(DEFAULT_LEARNING_RATE),
+	  revolutionValid(true),
+	  learnedRevolutions(0) {
+    reset();
+}
+
+float ToothCorrection::correct(uint32_t period) {
+    if (toothCount <= 1) {
+        return (float)period;  // Single tooth - nothing to correct
+    }
+
+    revolutionPeriods[toothIndex] = period;
+    float corrected = (float)period / corrections[toothIndex];
+
+    advance(1);
+    return corrected;
+}
+
+void ToothCorrection::skip(int teeth) {
+    if (toothCount <= 1 || teeth <= 0) {
+        return;
+    }
+
+    revolutionValid = false;
+    advance(teeth);
+}
+
+void ToothCorrection::advance(int teeth) {
+    for (int i = 0; i < teeth; i++) {
+        toothIndex++;
+        if (toothIndex >= toothCount) {
+            toothIndex = 0;
+            if (revolutionValid) {
+                learnRevolution();
+            }
+            revolutionValid = true;  // Start collecting the next revolution
+        }
+    }
+}
+
+void ToothCorrection::learnRevolution() {
+    float revolutionSum = 0.0f;
+    for (int i = 0; i < toothCount; i++) {
+        revolutionSum += (float)revolutionPeriods[i];
+    }
+    if (revolutionSum <= 0.0f) {
+        return;
+    }
+
+    // Each tooth's share of the revolution relative to an evenly spaced wheel
+    float scale = (float)toothCount / revolutionSum;
+    float correctionSum = 0.0f;
+    for (int i = 0; i < toothCount; i++) {
+        float observed = (float)revolutionPeriods[i] * scale;
+        corrections[i] += learningRate * (observed - corrections[i]);
+        correctionSum += corrections[i];
+    }
+
+    // Renormalize so the corrections never change the average speed
+    float normalize = (float)toothCount / correctionSum;
+    for (int i = 0; i < toothCount; i++) {
+        corrections[i] *= normalize;
+    }
+
+    if (learnedRevolutions < LEARNED_AFTER_REVOLUTIONS) {
+        learnedRevolutions++;
+    }
+}
+
+void ToothCorrection::reset() {
+    toothIndex = 0;
+    revolutionValid = true;
+    learnedRevolutions = 0;
+    for (int i = 0; i < MAX_TEETH; i++) {
+        corrections[i] = 1.0f;
+        revolutionPeriods[i] = 0;
+    }
+}
+
+void ToothCorrection::setToothCount(int teeth) {
+    if (teeth < 1) {
+        teeth = 1;
+    } else if (teeth > MAX_TEETH) {
+        teeth = MAX_TEETH;
+    }
+
+    if (teeth != toothCount) {
+        toothCount = teeth;
+        reset();
+    }
+}
+
+float ToothCorrection::getCorrection(int tooth) const {
+    if (tooth < 0 || tooth >= toothCount) {
+        return 1.0f;
+    }
+    return corrections[tooth];
+}
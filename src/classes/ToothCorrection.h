@@ -0,0 +1,50 @@
+#ifndef TOOTH_CORRECTION_H
+#define TOOTH_CORRECTION_H
+
+#include <stdint.h>
+
+// Learns the actual angular spacing of each tooth on a multi-tooth target wheel
+// and corrects individual tooth periods so uneven spacing does not show up as
+// speed ripple. Pure logic with no Arduino dependencies so it can run on the host.
+class ToothCorrection {
+public:
+    static const int MAX_TEETH = 16;
+
+private:
+    static constexpr float DEFAULT_LEARNING_RATE = 0.05f;
+    static const int LEARNED_AFTER_REVOLUTIONS = 20;  // Revolutions before corrections are trusted
+
+    int toothCount;
+    int toothIndex;                 // Tooth whose gap ends at the next edge
+    float learningRate;
+    float corrections[MAX_TEETH];   // Observed gap / nominal gap for each tooth (mean is 1.0)
+
+    uint32_t revolutionPeriods[MAX_TEETH];  // Raw periods of the revolution in progress
+    bool revolutionValid;                   // False if any gap this revolution was missing/outlying
+    int learnedRevolutions;
+
+    void learnRevolution();
+    void advance(int teeth);
+
+public:
+    ToothCorrection();
+
+    // Feed the raw period ending at the current tooth; returns the corrected period
+    float correct(uint32_t period);
+
+    // Advance past teeth whose periods are unusable (outliers or missed edges)
+    void skip(int teeth);
+
+    void reset();
+
+    // Configuration
+    void setToothCount(int teeth);
+    void setLearningRate(float rate) { learningRate = rate; }
+
+    // Getters
+    int getToothCount() const { return toothCount; }
+    float getCorrection(int tooth) const;
+    bool isLearned() const { return learnedRevolutions >= LEARNED_AFTER_REVOLUTIONS; }
+};
+
+#endif // TOOTH_CORRECTION_H
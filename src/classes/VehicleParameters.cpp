@@ -0,0 +1,58 @@
+#include "VehicleParameters.h"
+#include "Crc32.h"
+
+uint32_t computeParameterCrc(const VehicleParameters& parameters) {
+    return computeCrc32(&parameters, offsetof(VehicleParameters, crc));
+}
+
+bool isValidVehicleParameters(const VehicleParameters& parameters) {
+    if (parameters.magic != PARAMETER_MAGIC || parameters.version != PARAMETER_VERSION ||
+        parameters.size != sizeof(VehicleParameters) || parameters.crc != computeParameterCrc(parameters)) {
+        return false;
+    }
+
+    // Reject values that would make the speed math meaningless
+    if (!(parameters.differentialRatio > 0.5f && parameters.differentialRatio < 10.0f) ||
+        !(parameters.tireDiameterInches > 10.0f && parameters.tireDiameterInches < 40.0f) ||
+        parameters.driveshaftPulsesPerRev < 1 || parameters.driveshaftPulsesPerRev > ToothCorrection::MAX_TEETH ||
+        !(parameters.speedHysteresisMph >= 0.0f && parameters.speedHysteresisMph <= 5.0f) ||
+        !(parameters.needleMaxVelocityMphPerSec > 0.0f && parameters.needleMaxVelocityMphPerSec <= 100.0f) ||
+        !(parameters.needleMaxAccelerationMphPerSec2 > 0.0f && parameters.needleMaxAccelerationMphPerSec2 <= 1000.0f) ||
+        !(parameters.stepperMaxStepsPerSec >= 50.0f && parameters.stepperMaxStepsPerSec <= STEPPER_CHARACTERIZE_MAX_RATE) ||
+        !(parameters.stepperMaxStepsPerSec2 >= 50.0f && parameters.stepperMaxStepsPerSec2 <= STEPPER_CHARACTERIZE_MAX_ACCEL) ||
+        !DialGeometry::isValidCalibration(parameters.dialCalibrationSteps)) {
+        return false;
+    }
+    for (int i = 0; i < GEAR_COUNT; i++) {
+        if (!(parameters.transmissionRatios[i] >= 0.0f && parameters.transmissionRatios[i] < 10.0f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void deriveVehicleFactors(const VehicleParameters& parameters, VehicleFactors& factors) {
+    using namespace VehicleProfileMath;
+
+    // Road speed per driveshaft RPM: wheel RPM * tire circumference * 60 / inches per mile.
+    // Speed is linear in shaft speed, so this one factor is the whole RPM->MPH table.
+    factors.mphPerDriveshaftRPM = PI_F * parameters.tireDiameterInches * MINUTES_PER_HOUR /
+                                  (parameters.differentialRatio * INCHES_PER_MILE);
+    factors.mphPerDriveshaftRPMFixed = Q16::fromFloat(factors.mphPerDriveshaftRPM);
+
+    const float* ratios = parameters.transmissionRatios;
+    for (int gear = 0; gear < GEAR_COUNT; gear++) {
+        // Forward gears are ordered tallest first; neighbours bound each other's windows
+        bool forward = gear >= GEAR_1;
+        float taller = (forward && gear > GEAR_1) ? ratios[gear - 1] : 0.0f;
+        float shorter = (forward && gear + 1 < GEAR_COUNT) ? ratios[gear + 1] : 0.0f;
+
+        // The driveshaft is on the gearbox output, so engine/driveshaft is the
+        // gearbox ratio alone - the differential only matters for road speed
+        factors.enginePerDriveshaft[gear] = ratios[gear];
+        factors.enginePerDriveshaftMin[gear] = lowerRatioBound(ratios[gear], shorter);
+        factors.enginePerDriveshaftMax[gear] = upperRatioBound(ratios[gear], taller);
+        factors.enginePerDriveshaftMinFixed[gear] = Q16::fromFloat(factors.enginePerDriveshaftMin[gear]);
+        factors.enginePerDriveshaftMaxFixed[gear] = Q16::fromFloat(factors.enginePerDriveshaftMax[gear]);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef VEHICLE_PARAMETERS_H
+#define VEHICLE_PARAMETERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "VehicleProfile.h"
+#include "ToothCorrection.h"
+#include "FixedPoint.h"
+#include "DialGeometry.h"
+
+// Runtime-tunable vehicle parameters. A flat struct stored as one blob: loaded
+// once at boot, then read directly by the components - nothing is parsed after
+// startup. The vehicle profile supplies the defaults.
+struct VehicleParameters {
+    uint32_t magic;                          // PARAMETER_MAGIC
+    uint16_t version;                        // PARAMETER_VERSION - bump on any layout change
+    uint16_t size;                           // sizeof(VehicleParameters)
+
+    float differentialRatio;
+    float tireDiameterInches;
+    float transmissionRatios[GEAR_COUNT];    // Indexed by Gear, 0 = not fitted
+    int32_t driveshaftPulsesPerRev;
+    uint32_t gearStabilityTimeoutMs;         // Timed gear classifier confirmation time
+    float needleMaxVelocityMphPerSec;        // Speedometer needle motion limits, in dial MPH
+    float needleMaxAccelerationMphPerSec2;
+    uint32_t gearTransitionTimeMs;           // Gear indicator easing time
+    float speedHysteresisMph;                // Speed change needed before the needle is re-targeted
+    uint16_t dialCalibrationSteps[DIAL_CALIBRATION_POINTS];  // Full steps past 0 MPH at each dial knot
+    float stepperMaxStepsPerSec;             // Motor limits in full steps, from stepper characterization
+    float stepperMaxStepsPerSec2;
+
+    uint32_t crc;                            // CRC-32 of every byte above
+};
+
+static const uint32_t PARAMETER_MAGIC = 0x56504152;  // "VPAR"
+static const uint16_t PARAMETER_VERSION = 5;
+
+// Speed and gear-window factors derived from the parameters, so the hot path
+// only multiplies and compares. Q16.16 copies serve USE_FIXED_POINT_MATH builds.
+struct VehicleFactors {
+    float mphPerDriveshaftRPM;
+    float enginePerDriveshaft[GEAR_COUNT];      // The gearbox ratio itself; 0 = gear not fitted
+    float enginePerDriveshaftMin[GEAR_COUNT];   // Accepted window for the timed classifier
+    float enginePerDriveshaftMax[GEAR_COUNT];
+
+    Q16::fixed mphPerDriveshaftRPMFixed;
+    Q16::fixed enginePerDriveshaftMinFixed[GEAR_COUNT];
+    Q16::fixed enginePerDriveshaftMaxFixed[GEAR_COUNT];
+};
+
+// Defaults for a vehicle profile (see VehicleProfile.h)
+template <typename Profile>
+VehicleParameters defaultVehicleParameters() {
+    VehicleParameters parameters;
+    parameters.magic = PARAMETER_MAGIC;
+    parameters.version = PARAMETER_VERSION;
+    parameters.size = sizeof(VehicleParameters);
+    parameters.differentialRatio = Profile::DIFFERENTIAL_RATIO;
+    parameters.tireDiameterInches = Profile::TIRE_DIAMETER_INCHES;
+    for (int i = 0; i < GEAR_COUNT; i++) {
+        parameters.transmissionRatios[i] = Profile::TRANSMISSION_RATIOS[i];
+    }
+    parameters.driveshaftPulsesPerRev = DRIVESHAFT_PULSES_PER_REV;
+    parameters.gearStabilityTimeoutMs = 750;
+    parameters.needleMaxVelocityMphPerSec = 20.0f;
+    parameters.needleMaxAccelerationMphPerSec2 = 40.0f;
+    parameters.gearTransitionTimeMs = 800;
+    parameters.speedHysteresisMph = 0.25f;
+    DialGeometry::linearCalibration(parameters.dialCalibrationSteps);
+    parameters.stepperMaxStepsPerSec = STEPPER_RPM * STEPS_PER_REVOLUTION / 60.0f;
+    parameters.stepperMaxStepsPerSec2 = STEPPER_ACCEL;
+    parameters.crc = 0;
+    return parameters;
+}
+
+uint32_t computeParameterCrc(const VehicleParameters& parameters);
+
+// Header, CRC and value ranges all check out
+bool isValidVehicleParameters(const VehicleParameters& parameters);
+
+void deriveVehicleFactors(const VehicleParameters& parameters, VehicleFactors& factors);
+
+#endif // VEHICLE_PARAMETERS_H
@@ -0,0 +1,8 @@
+#include "VehicleProfile.h"
+
+// Out-of-line definitions for the constexpr profile members that are used by address
+constexpr const char* Mgb3SpeedProfile::NAME;
+constexpr float Mgb3SpeedProfile::TRANSMISSION_RATIOS[GEAR_COUNT];
+
+constexpr const char* Mgb4SpeedOverdriveProfile::NAME;
+constexpr float Mgb4SpeedOverdriveProfile::TRANSMISSION_RATIOS[GEAR_COUNT];
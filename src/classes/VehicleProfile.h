@@ -0,0 +1,74 @@
+#ifndef VEHICLE_PROFILE_H
+#define VEHICLE_PROFILE_H
+
+#include "config.h"
+
+// Compile-time vehicle descriptions. A profile is a type with:
+//   static constexpr const char* NAME;
+//   static constexpr float DIFFERENTIAL_RATIO;
+//   static constexpr float TIRE_DIAMETER_INCHES;
+//   static constexpr float TRANSMISSION_RATIOS[GEAR_COUNT];  // Indexed by Gear, 0 = not fitted
+// Forward ratios must decrease from GEAR_1 upwards.
+
+// 1970 MGB three-speed manual
+struct Mgb3SpeedProfile {
+    static constexpr const char* NAME = "1970 MGB 3-speed";
+    static constexpr float DIFFERENTIAL_RATIO = 3.9f;      // 1970 MGB differential ratio
+    static constexpr float TIRE_DIAMETER_INCHES = 23.0f;   // Approximate for 165-80R13 tires
+    static constexpr float TRANSMISSION_RATIOS[GEAR_COUNT] = {
+        3.44f,  // Reverse
+        0.0f,   // Neutral
+        3.44f,  // 1st
+        2.21f,  // 2nd
+        1.37f,  // 3rd
+        0.0f,   // 4th (not fitted)
+        0.0f    // Overdrive (not fitted)
+    };
+};
+
+// MGB all-synchro four-speed with Laycock LH overdrive (0.802) on top gear.
+// Overdrive 3rd (1.107) sits within measurement noise of 4th and is not modelled.
+struct Mgb4SpeedOverdriveProfile {
+    static constexpr const char* NAME = "MGB 4-speed overdrive";
+    static constexpr float DIFFERENTIAL_RATIO = 3.909f;
+    static constexpr float TIRE_DIAMETER_INCHES = 23.0f;
+    static constexpr float TRANSMISSION_RATIOS[GEAR_COUNT] = {
+        3.095f, // Reverse
+        0.0f,   // Neutral
+        3.44f,  // 1st
+        2.167f, // 2nd
+        1.382f, // 3rd
+        1.0f,   // 4th
+        0.802f  // 4th + overdrive
+    };
+};
+
+// Conversion constants and gear-window math shared by the parameter code
+namespace VehicleProfileMath {
+    static constexpr float PI_F = 3.14159265358979f;
+    static constexpr float INCHES_PER_MILE = 63360.0f;
+    static constexpr float MINUTES_PER_HOUR = 60.0f;
+    static constexpr float GEAR_RATIO_TOLERANCE = 0.3f;   // Widest accepted ratio error
+
+    // Ratio window for a gear: +/- tolerance, but never past the midpoint to a
+    // neighbouring gear (0 = no neighbour on that side), so windows never overlap
+    constexpr float lowerRatioBound(float ratio, float shorterNeighbour) {
+        return ratio <= 0.0f ? 0.0f
+             : shorterNeighbour > 0.0f && (ratio + shorterNeighbour) * 0.5f > ratio - GEAR_RATIO_TOLERANCE
+                 ? (ratio + shorterNeighbour) * 0.5f
+                 : ratio - GEAR_RATIO_TOLERANCE;
+    }
+
+    constexpr float upperRatioBound(float ratio, float tallerNeighbour) {
+        return ratio <= 0.0f ? 0.0f
+             : tallerNeighbour > 0.0f && (ratio + tallerNeighbour) * 0.5f < ratio + GEAR_RATIO_TOLERANCE
+                 ? (ratio + tallerNeighbour) * 0.5f
+                 : ratio + GEAR_RATIO_TOLERANCE;
+    }
+}
+
+// Profile in use, selected in config.h. It supplies the defaults for the
+// runtime parameter block (see VehicleParameters.h).
+typedef VEHICLE_PROFILE ActiveVehicleProfile;
+
+#endif // VEHICLE_PROFILE_H
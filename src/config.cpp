@@ -1,5 +1,14 @@
 #include "config.h"
+#include "classes/CanSignalDecoder.h"
 
 // Define the global constants
-const int GEAR_ANGLES[5] = {0, 15, 30, 45, 60};
-const char* GEAR_NAMES[5] = {"Reverse", "Neutral", "1", "2", "3"};
\ No newline at end of file
+const int GEAR_ANGLES[GEAR_COUNT] = {0, 15, 30, 45, 60, 75, 90};
+const char* GEAR_NAMES[GEAR_COUNT] = {"Reverse", "Neutral", "1", "2", "3", "4", "OD"};
+
+// CAN signals to decode. Default: MegaSquirt dash broadcast (base ID 1512),
+// group 0 carries engine RPM as a big-endian uint16 in bytes 6-7.
+//   { canId, extendedId, byteOffset, length, bigEndian, isSigned, scale, offset, signal }
+const CanSignalDefinition CAN_SIGNAL_TABLE[] = {
+    { 0x5E8, false, 6, 2, true, false, 1.0f, 0.0f, CAN_SIGNAL_ENGINE_RPM },
+};
+const int CAN_SIGNAL_TABLE_SIZE = sizeof(CAN_SIGNAL_TABLE) / sizeof(CAN_SIGNAL_TABLE[0]);
@@ -5,6 +5,49 @@
 #define SERVO_PIN 19  // GPIO 19 - PWM capable pin for servo control
 #define DRIVESHAFT_SENSOR_PIN 18  // GPIO 18 - Driveshaft optical endstop sensor
 
+// Optional second driveshaft sensor, offset a quarter tooth from the first, for
+// quadrature direction sensing (-1 = not fitted, reverse cannot be detected)
+#define DRIVESHAFT_SENSOR_B_PIN -1
+
+// Driveshaft pulse acquisition backend (see classes/PulseBackends.h):
+//   PULSE_BACKEND_GPIO_ISR      - one interrupt per edge (default)
+//   PULSE_BACKEND_PCNT          - hardware counter, no interrupts; best for multi-tooth wheels at speed
+//   PULSE_BACKEND_MCPWM_CAPTURE - hardware edge timestamps
+#define DRIVESHAFT_PULSE_BACKEND PULSE_BACKEND_GPIO_ISR
+
+// Driveshaft target wheel - number of teeth/slots passing the sensor per revolution
+#define DRIVESHAFT_PULSES_PER_REV 1
+
+// Ignition tach input - coil negative or ECU tach output through an opto-isolated
+// conditioning stage (never connect coil negative directly: it swings to hundreds of volts)
+#define TACH_SENSOR_PIN 4         // GPIO 4 - Conditioned ignition pulses, active low
+#define TACH_CYLINDERS 4          // Four-stroke cylinder count (MGB B-series: 4)
+#define TACH_MAX_RPM 7000         // Redline - sets the spark-ringing lockout
+#define TACH_PULSE_BACKEND PULSE_BACKEND_GPIO_ISR   // Or MCPWM capture; PCNT can't lock out the ringing
+
+// CAN bus (TWAI) engine data - needs an external transceiver such as an SN65HVD230
+#define CAN_TX_PIN 17         // GPIO 17 - Transceiver TXD (unused in listen-only mode, but must be assigned)
+#define CAN_RX_PIN 16         // GPIO 16 - Transceiver RXD
+#define CAN_BITRATE 500000    // Bus speed in bit/s (125k, 250k, 500k or 1M)
+
+// Frame decode table for the CAN signals, defined in config.cpp
+struct CanSignalDefinition;
+extern const CanSignalDefinition CAN_SIGNAL_TABLE[];
+extern const int CAN_SIGNAL_TABLE_SIZE;
+
+// Gear classifier used at startup (selectable at runtime via RPMHandler::setGearClassifierMode):
+//   GEAR_CLASSIFIER_TIMED - fixed ratio tolerance held for 750ms
+//   GEAR_CLASSIFIER_HMM   - probabilistic, confirms as soon as confident
+#define DEFAULT_GEAR_CLASSIFIER GEAR_CLASSIFIER_TIMED
+
+// Number format for the speed, gear-ratio and easing math:
+//   0 - float (reference)
+//   1 - Q16.16 fixed point (integer only, ISR safe)
+// Can also be set from build_flags (-DUSE_FIXED_POINT_MATH=1)
+#ifndef USE_FIXED_POINT_MATH
+#define USE_FIXED_POINT_MATH 0
+#endif
+
 // OLED Display Settings - using default I2C pins like working project
 // Default I2C pins: SDA=21, SCL=22 (ESP32 defaults)
 // No explicit pin definitions needed - Wire library uses defaults
@@ -15,14 +58,26 @@ enum Gear {
     NEUTRAL = 1,    // 15 degrees
     GEAR_1 = 2,     // 30 degrees
     GEAR_2 = 3,     // 45 degrees
-    GEAR_3 = 4      // 60 degrees
+    GEAR_3 = 4,     // 60 degrees
+    GEAR_4 = 5,     // 75 degrees
+    GEAR_OD = 6     // 90 degrees - top gear with overdrive engaged
 };
+#define GEAR_COUNT 7
 
 // Gear angle lookup (in degrees)
-extern const int GEAR_ANGLES[5];
+extern const int GEAR_ANGLES[GEAR_COUNT];
 
 // Gear string lookup
-extern const char* GEAR_NAMES[5];
+extern const char* GEAR_NAMES[GEAR_COUNT];
+
+// Stationary this long counts as parked: the odometer and the needle position
+// are saved to flash once per stop (main.cpp updateParking())
+#define PARK_SAVE_DELAY_MS 5000
+
+// Vehicle profile (see classes/VehicleProfile.h):
+//   Mgb3SpeedProfile          - 1970 MGB three-speed
+//   Mgb4SpeedOverdriveProfile - MGB four-speed with overdrive on top gear
+#define VEHICLE_PROFILE Mgb3SpeedProfile
 
 // Speedometer Stepper Motor Definitions (moved to avoid I2C conflict)
 #define STEPPER_PIN_1 25  // GPIO 25 - Stepper motor pin 1
@@ -35,12 +90,40 @@ extern const char* GEAR_NAMES[5];
 #define MIN_SPEED_MPH 0
 #define MAX_SPEED_MPH 90
 #define SPEED_RANGE (MAX_SPEED_MPH - MIN_SPEED_MPH)
+#define DIAL_CALIBRATION_POINTS 10  // Dial table knots, evenly spaced from MIN to MAX MPH (every 10 MPH)
 
 // 28BYJ-48 Stepper Motor Specifications
 #define STEPS_PER_REVOLUTION 2048  // Steps per full revolution for 28BYJ-48
-#define STEPPER_RPM 15            // Maximum recommended RPM
+#define STEPPER_RPM 15            // Default step rate until the motor has been characterized
+#define STEPPER_ACCEL 2000        // Default acceleration limit, full steps/s^2 (the needle limits are lower)
+#define STEPPER_TIMER_GROUP 0     // Hardware timer driving the step generator
+#define STEPPER_TIMER_INDEX 0
+
+// Stepper coil drive (see StepperDrives.h):
+//   STEPPER_DRIVE_FULL  - 2048 steps/rev, full torque (default)
+//   STEPPER_DRIVE_HALF  - 4096 steps/rev
+//   STEPPER_DRIVE_MICRO - 2048 * STEPPER_MICROSTEPS steps/rev, PWM on four LEDC channels
+// Dial positions are counted in drive steps, so all the MPH math follows the mode.
+#define STEPPER_DRIVE_MODE STEPPER_DRIVE_FULL
+#define STEPPER_MICROSTEPS 8          // Micro-steps per full step (power of two)
+#define STEPPER_LEDC_TIMER 3          // Micro-step PWM timer and first of four channels;
+#define STEPPER_LEDC_CHANNEL_BASE 4   // must not overlap the gear servo's
+
+// Warm boot: a saved needle position is confirmed by one pass over the home
+// marker instead of a full search. Edges must land within this many full steps
+// of where they were, or the wheel falls back to full homing.
+#define HOME_VERIFY_TOLERANCE_STEPS 16
 
-// Calculate steps per MPH (assuming full revolution covers full speed range)
-#define STEPS_PER_MPH (STEPS_PER_REVOLUTION / SPEED_RANGE)
+// Stepper characterization (SpeedometerWheel::startCharacterization): the step
+// rate and acceleration are searched between these limits, in full steps per
+// second and full steps per second squared, by sweeping the needle past the
+// home marker and watching it for drift. Set STEPPER_CHARACTERIZE_ON_BOOT to 1
+// on the bench to run it after homing and save the result to the vehicle
+// parameters; it takes several minutes.
+#define STEPPER_CHARACTERIZE_ON_BOOT 0
+#define STEPPER_CHARACTERIZE_MIN_RATE 256      // 7.5 RPM
+#define STEPPER_CHARACTERIZE_MAX_RATE 1500
+#define STEPPER_CHARACTERIZE_MIN_ACCEL 500
+#define STEPPER_CHARACTERIZE_MAX_ACCEL 20000
 
 #endif // CONFIG_H
\ No newline at end of file
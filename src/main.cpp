@@ -6,12 +6,27 @@
 #include "classes/RPMHandler.h"
 #include "classes/DisplayManager.h"
 #include "classes/DriveshaftMonitor.h"
+#include "classes/CanBusReceiver.h"
+#include "classes/TachMonitor.h"
+#include "classes/ParameterBlock.h"
+#include "classes/NvsParameterStorage.h"
+#include "classes/Odometer.h"
+#include "classes/PartitionJournalFlash.h"
+#include "classes/RtcParameterStorage.h"
 
+NvsParameterStorage parameterStorage("speedo", "vehicle");
+ParameterBlock parameterBlock(parameterStorage, defaultVehicleParameters<ActiveVehicleProfile>());
 GearIndicator gearIndicator;
-SpeedometerWheel speedometer;
+RtcParameterStorage needleRtcStorage;
+NvsParameterStorage needleFlashStorage("speedo", "needle");
+SpeedometerWheel speedometer(needleRtcStorage, needleFlashStorage);
 DisplayManager displayManager;
 DriveshaftMonitor driveshaftMonitor;
-RPMHandler rpmHandler(&gearIndicator, &speedometer, &driveshaftMonitor);
+TachMonitor tachMonitor;
+CanBusReceiver canBus(CAN_SIGNAL_TABLE, CAN_SIGNAL_TABLE_SIZE);
+PartitionJournalFlash odometerFlash("odometer");
+Odometer odometer(odometerFlash);
+RPMHandler rpmHandler(&gearIndicator, &speedometer, &driveshaftMonitor, &odometer);
 
 void setup() {
   Serial.begin(115200);
@@ -20,14 +35,52 @@ void setup() {
   Serial.println(VERSION_STRING);
   Serial.println("Starting system initialization...");
 
+  // Vehicle parameters: one NVS blob read, defaults if missing or corrupt
+  ParameterLoadResult parameterResult = parameterBlock.load();
+  if (parameterResult == PARAMETERS_LOADED) {
+    Serial.println("Vehicle parameters loaded from NVS");
+  } else if (parameterResult == PARAMETERS_INVALID) {
+    Serial.println("Warning: Stored vehicle parameters invalid, using profile defaults");
+  } else {
+    Serial.println("Using " + String(ActiveVehicleProfile::NAME) + " profile defaults");
+  }
+  const VehicleParameters& parameters = parameterBlock.get();
+  rpmHandler.applyParameters(parameters);
+  gearIndicator.setTransitionTime(parameters.gearTransitionTimeMs);
+  speedometer.setStepperLimits(parameters.stepperMaxStepsPerSec, parameters.stepperMaxStepsPerSec2);
+  speedometer.setMotionLimits(parameters.needleMaxVelocityMphPerSec, parameters.needleMaxAccelerationMphPerSec2);
+  speedometer.setDialCalibration(parameters.dialCalibrationSteps);
+
+  // Odometer: newest journal record from the dedicated flash partition (distance
+  // per revolution comes from RPMHandler with every parameter change)
+  if (odometer.begin()) {
+    Serial.println("Odometer: " + String(odometer.getOdometerMiles(), 1) + " mi, trip " +
+                   String(odometer.getTripMiles(), 1) + " mi (" +
+                   String(odometer.getJournal().getRecoveryReads()) + " journal reads)");
+  } else {
+    Serial.println("Warning: Odometer partition not found, distance will not be saved");
+  }
+
+  // A saved needle position skips the splash, the stepper bench tests and the marker search
+  bool warmBoot = speedometer.restoreState() != WARM_BOOT_NONE;
+
   // Initialize display first
-  if (!displayManager.begin()) {
+  if (!displayManager.begin(!warmBoot)) {
     Serial.println("Warning: Display initialization failed, continuing without display");
   }
 
   gearIndicator.begin();
   speedometer.begin();
-  driveshaftMonitor.begin();
+  driveshaftMonitor.begin(Serial);
+  if (parameters.driveshaftPulsesPerRev != DRIVESHAFT_PULSES_PER_REV &&
+      !driveshaftMonitor.setPulsesPerRevolution(parameters.driveshaftPulsesPerRev)) {
+    Serial.println("DriveshaftMonitor: Invalid pulses per revolution: " + String(parameters.driveshaftPulsesPerRev));
+  }
+  tachMonitor.begin(Serial);
+
+  if (!canBus.begin()) {
+    Serial.println("Warning: CAN bus unavailable, using tach input for engine RPM");
+  }
 
   // Enable driveshaft monitor for testing
   driveshaftMonitor.setEnabled(true);
@@ -35,19 +88,42 @@ void setup() {
   // Test servo output immediately after initialization
 
   // Demo sequence: calibrate speedometer, then run demo
-  delay(2000);
+  if (!warmBoot) {
+    delay(2000);
+  }
 
   // Serial.println("Starting continuous stepper test to verify sensor...");
   // displayManager.showCalibrationScreen("Stepper Test");
   // speedometer.continuousStepperTest();
 
+  // Home the needle in the background; loop() reports the outcome
   Serial.println("Calibrating speedometer...");
   displayManager.showCalibrationScreen("Calibrating...");
+  speedometer.startCalibration();
+}
+
+unsigned long lastRpmReport = 0;
+unsigned long lastStatusUpdate = 0;
+unsigned long lastDemoTransition = 0;
+int demoStep = 0;
+bool demoMode = true;  // Enable demo mode when no driveshaft signal
+HomingStatus lastHomingStatus = HOMING_IDLE;
+const char* ENGINE_RPM_SOURCE_NAMES[] = {"none", "CAN", "tach", "est"};  // Indexed by EngineRPMSource
+CharacterizationStatus lastCharacterizationStatus = CHARACTERIZE_IDLE;
+unsigned long lastDrivingMillis = 0;
+bool parked = true;  // Nothing to save until the car has moved
+
+// Show the homing outcome once, when the search finishes
+void reportHoming() {
+  HomingStatus status = speedometer.getHomingStatus();
+  if (status == lastHomingStatus) {
+    return;
+  }
+  lastHomingStatus = status;
 
-  if (speedometer.calibrateHome()) {
+  if (status == HOMING_COMPLETE) {
     Serial.println("Speedometer calibrated successfully!");
     displayManager.showCalibrationScreen("Calibration OK");
-    delay(1000);
 
     // Start real RPM-based speed calculation
     Serial.println("Starting RPM-based speed calculation...");
@@ -56,25 +132,82 @@ void setup() {
     // Initial neutral state
     displayManager.updateStatus(NEUTRAL, 0, GEAR_NAMES[NEUTRAL]);
     displayManager.updateDiagnostics(false, false, true);
-  } else {
+
+#if STEPPER_CHARACTERIZE_ON_BOOT
+    // Bench mode: find the motor's limits once per boot (trials may re-home along the way)
+    if (speedometer.getCharacterizer().getStatus() == CHARACTERIZE_IDLE) {
+      displayManager.showCalibrationScreen("Stepper Test");
+      speedometer.startCharacterization();
+    }
+#endif
+  } else if (speedometer.getHoming().isFailed()) {
     Serial.println("Speedometer calibration failed!");
     displayManager.showErrorScreen("Calibration Failed");
-    delay(3000);
   }
 }
 
-unsigned long lastRpmReport = 0;
-unsigned long lastStatusUpdate = 0;
-unsigned long lastDemoTransition = 0;
-int demoStep = 0;
-bool demoMode = true;  // Enable demo mode when no driveshaft signal
+// Keep the stepper limits once a characterization run finds them
+void reportCharacterization() {
+  CharacterizationStatus status = speedometer.getCharacterizer().getStatus();
+  if (status == lastCharacterizationStatus) {
+    return;
+  }
+  lastCharacterizationStatus = status;
+
+  if (status == CHARACTERIZE_COMPLETE) {
+    StepperLimits limits = speedometer.getStepperLimits();
+    VehicleParameters updated = parameterBlock.get();
+    updated.stepperMaxStepsPerSec = limits.stepsPerSecond;
+    updated.stepperMaxStepsPerSec2 = limits.stepsPerSecond2;
+    if (parameterBlock.save(updated)) {
+      Serial.println("Stepper limits saved to NVS");
+    } else {
+      Serial.println("Warning: Stepper limits could not be saved");
+    }
+    displayManager.showCalibrationScreen("Stepper Test OK");
+  } else if (status == CHARACTERIZE_FAILED) {
+    displayManager.showErrorScreen("Stepper Test Failed");
+  }
+}
+
+// Power may be cut at any time once the car stops: after PARK_SAVE_DELAY_MS
+// stationary, journal whatever distance the odometer has not yet committed and
+// save the needle position to flash, once per stop. With the engine off as
+// well, the needle rests beside the home marker so the next cold boot only has
+// a short verify pass to make; it comes back to 0 MPH when the engine starts.
+void updateParking(unsigned long now, bool engineRunning) {
+  if (driveshaftMonitor.isReceivingSignal()) {
+    lastDrivingMillis = now;
+    parked = false;
+    return;
+  }
+  if (now - lastDrivingMillis < PARK_SAVE_DELAY_MS) {
+    return;
+  }
+  if (!parked) {
+    parked = true;
+    if (!odometer.flush(now)) {
+      Serial.println("Warning: Odometer could not be saved");
+    }
+    speedometer.saveState();
+  }
+  if (!engineRunning && !speedometer.isParked()) {
+    speedometer.park();
+  } else if (engineRunning && speedometer.isParked()) {
+    speedometer.moveToMPH(0);
+  }
+}
 
 void loop() {
   // Update all components for smooth transitions
   gearIndicator.update();
   speedometer.update();
+  reportHoming();
+  reportCharacterization();
   displayManager.update();
   driveshaftMonitor.update();
+  tachMonitor.update();
+  odometer.update(driveshaftMonitor.getPulseCount(), driveshaftMonitor.getPulsesPerRevolution(), millis());
 
   // Update display diagnostics with current component states
   displayManager.updateDiagnostics(
@@ -83,27 +216,36 @@ void loop() {
     speedometer.getCalibrationStatus()
   );
 
-  // Get current driveshaft RPM and calculate estimated engine RPM
+  // Get current driveshaft RPM
   unsigned long currentTime = millis();
-  float driveshaftRPM = driveshaftMonitor.getRPM();
+  float driveshaftRPM = driveshaftMonitor.getFilteredRPM();
 
-  // Simulate engine RPM based on driveshaft RPM and estimated gear ratio
-  // For now, assume 2nd gear (2.21:1) * differential (3.9:1) = ~8.6:1 overall
-  // This gives a reasonable estimate until we add real engine RPM sensing
-  float estimatedEngineRPM = 0.0f;
-  if (driveshaftRPM > 10.0f) {  // Only calculate if we have meaningful driveshaft RPM
-    estimatedEngineRPM = driveshaftRPM * 3.9f * 2.0f;  // Assume average gear ratio
+  // Engine RPM source priority: CAN bus, then ignition tach, then an estimate
+  float engineRPM = 0.0f;
+  EngineRPMSource engineRPMSource = ENGINE_RPM_NONE;
+  if (canBus.getEngineRPM(engineRPM)) {
+    engineRPMSource = ENGINE_RPM_CAN;
+  } else if (tachMonitor.isValidSignal()) {
+    engineRPM = tachMonitor.getFilteredRPM();
+    engineRPMSource = ENGINE_RPM_TACH;
+  } else if (abs(driveshaftRPM) > 10.0f) {
+    // No measured engine speed - fall back to an estimate so the bench demo still moves.
+    // Gear detection is meaningless in this mode: the ratio is assumed, not measured,
+    // and RPMHandler does not learn from it.
+    engineRPM = abs(driveshaftRPM) * 2.21f;  // Assume 2nd gear
+    engineRPMSource = ENGINE_RPM_ESTIMATED;
   }
+  updateParking(currentTime, engineRPMSource != ENGINE_RPM_NONE && engineRPM > 0.0f);
 
   // Check if we should use RPM handler or demo mode
   // Use isValidSignal() for control to filter noise, but keep isReceivingSignal() for debug
-  if (driveshaftMonitor.isEnabled() && driveshaftMonitor.isValidSignal() && driveshaftRPM > 10.0f) {
+  if (driveshaftMonitor.isEnabled() && driveshaftMonitor.isValidSignal() && abs(driveshaftRPM) > 10.0f) {
     // Real RPM mode - use driveshaft sensor data
     if (demoMode) {
       Serial.println("Driveshaft signal detected - switching to RPM mode");
       demoMode = false;
     }
-    rpmHandler.update(estimatedEngineRPM);
+    rpmHandler.update(engineRPM, driveshaftRPM, engineRPMSource);
   } 
   /*
   else {
@@ -154,9 +296,11 @@ void loop() {
   if (currentTime - lastRpmReport > 2000) {
     lastRpmReport = currentTime;
     Serial.println("Driveshaft: " + String(driveshaftRPM, 1) + " RPM | " +
-                   "Engine: " + String(estimatedEngineRPM, 0) + " RPM | " +
-                   "Speed: " + String(rpmHandler.getCurrentSpeed()) + " MPH | " +
+                   "Engine: " + String(engineRPM, 0) + " RPM (" + ENGINE_RPM_SOURCE_NAMES[engineRPMSource] + ") | " +
+                   "Speed: " + String(rpmHandler.getCurrentSpeed(), 1) + " MPH | " +
                    "Gear: " + String(GEAR_NAMES[rpmHandler.getCurrentGear()]) + " | " +
+                   "Odo: " + String(odometer.getOdometerMiles(), 1) + " mi | " +
+                   "Drift fixes: " + String(speedometer.getDriftCorrections()) + " | " +
                    "Signal: " + String(driveshaftMonitor.isReceivingSignal() ? "OK" : "NO"));
   }
 /*
@@ -174,5 +318,8 @@ void loop() {
     // Note: In demo mode, display is updated immediately when demo transitions occur
   }
 */
-  delay(10);  // Small delay for smooth animation
+  // Small delay for smooth animation. While homing the timer steps each move,
+  // but the loop starts the next one and retargets on endstop edges, so a
+  // short delay cuts the idle time between moves.
+  delay(speedometer.isHoming() ? 1 : 10);
 }
\ No newline at end of file
@@ -0,0 +1,219 @@
+// Frame decoding, signal age and acceptance filter of the CAN signal decoder,
+// and candump log replay and decode throughput
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "CandumpReplay.h"
+#include "CanSignalDecoder.h"
+
+static const CanSignalDefinition TABLE[] = {
+    { 0x5E8, false, 6, 2, true, false, 1.0f, 0.0f, CAN_SIGNAL_ENGINE_RPM },
+    { 0x5EA, false, 0, 2, false, true, 0.1f, 0.0f, CAN_SIGNAL_ENGINE_RPM },
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_decodes_big_endian_candump_frame(void) {
+    CanSignalDecoder decoder(TABLE, 1);
+    CanFrame frame;
+    uint32_t timestamp;
+    TEST_ASSERT_TRUE(CanSignalDecoder::parseCandumpLine("(1436509052.249713) can0 5E8#0000000000000BB8", frame, timestamp));
+    TEST_ASSERT_EQUAL_UINT32(0x5E8, frame.id);
+    TEST_ASSERT_EQUAL_INT(8, frame.length);
+    TEST_ASSERT_TRUE(decoder.decode(frame, timestamp));
+
+    float rpm = 0.0f;
+    TEST_ASSERT_TRUE(decoder.getValue(CAN_SIGNAL_ENGINE_RPM, timestamp + 10, 500, rpm));
+    TEST_ASSERT_EQUAL_FLOAT(3000.0f, rpm);
+    TEST_ASSERT_FALSE(decoder.getValue(CAN_SIGNAL_ENGINE_RPM, timestamp + 600, 500, rpm));
+}
+
+void test_decodes_signed_little_endian_scaled(void) {
+    CanSignalDecoder decoder(TABLE, 2);
+    CanFrame frame;
+    uint32_t timestamp;
+    TEST_ASSERT_TRUE(CanSignalDecoder::parseCandumpLine("(1.0) can0 5EA#38FF", frame, timestamp));
+    decoder.decode(frame, timestamp);
+    float value = 0.0f;
+    TEST_ASSERT_TRUE(decoder.getValue(CAN_SIGNAL_ENGINE_RPM, timestamp, 500, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -20.0f, value);
+}
+
+void test_frame_stored_after_the_clock_read_is_fresh(void) {
+    // The receive task can store a frame between the reader's millis() and its copy
+    CanSignalDecoder decoder(TABLE, 1);
+    CanFrame frame = { 0x5E8, false, 8, { 0, 0, 0, 0, 0, 0, 0x0B, 0xB8 } };
+    decoder.decode(frame, 100000);
+
+    float rpm = 0.0f;
+    TEST_ASSERT_TRUE(decoder.getValue(CAN_SIGNAL_ENGINE_RPM, 99995, 500, rpm));
+    TEST_ASSERT_EQUAL_FLOAT(3000.0f, rpm);
+}
+
+void test_never_written_signal_is_invalid(void) {
+    CanSignalDecoder decoder(TABLE, 1);
+    float rpm = 0.0f;
+    TEST_ASSERT_FALSE(decoder.getValue(CAN_SIGNAL_ENGINE_RPM, 0, 500, rpm));
+}
+
+void test_acceptance_filter_passes_every_table_id(void) {
+    CanSignalDecoder decoder(TABLE, 2);
+    uint32_t code, mask;
+    TEST_ASSERT_TRUE(decoder.computeAcceptanceFilter(code, mask));
+    for (int i = 0; i < 2; i++) {
+        uint32_t id = TABLE[i].canId << 21;
+        TEST_ASSERT_EQUAL_UINT32(code & ~mask, id & ~mask);
+    }
+}
+
+// A minute of bus traffic in candump format: engine RPM in 0x5E8 every 10 ms
+// ramping 800 -> 6800, among frames the table doesn't carry (a standard ID at
+// 2 ms, one at 5 ms, an extended J1939 ID at 20 ms)
+static std::string syntheticLog(int seconds, int& rpmFrames, float& lastRpm) {
+    std::string log;
+    char line[80];
+    rpmFrames = 0;
+    for (int ms = 0; ms < seconds * 1000; ms++) {
+        double timestamp = 1436509052.0 + ms / 1000.0;
+        if (ms % 2 == 0) {
+            snprintf(line, sizeof(line), "(%.6f) can0 280#%02X%02X1C0000000000\n", timestamp, ms & 0xFF, (ms >> 8) & 0xFF);
+            log += line;
+        }
+        if (ms % 5 == 0) {
+            snprintf(line, sizeof(line), "(%.6f) can0 1A0#00FF%04X\n", timestamp, ms & 0xFFFF);
+            log += line;
+        }
+        if (ms % 10 == 0) {
+            int rpm = 800 + ms / 10 % 6000;
+            snprintf(line, sizeof(line), "(%.6f) can0 5E8#000000000000%04X\n", timestamp, rpm);
+            log += line;
+            rpmFrames++;
+            lastRpm = (float)rpm;
+        }
+        if (ms % 20 == 0) {
+            snprintf(line, sizeof(line), "(%.6f) can0 18FEF100#FFFFFF%02XFFFFFFFF\n", timestamp, ms & 0xFF);
+            log += line;
+        }
+    }
+    return log;
+}
+
+void test_replays_a_multi_line_log(void) {
+    const char LOG[] =
+        "(1436509052.000000) can0 280#0102030405060708\n"
+        "(1436509052.010000) can0 5E8#0000000000000BB8\r\n"
+        "\n"
+        "not a candump line\n"
+        "(1436509052.020000) can0 18FEF100#FFFFFF00FFFFFFFF\n"
+        "(1436509052.030000) can0 5E8#0000000000000FA0";   // No newline at the end
+    CanSignalDecoder decoder(TABLE, 2);
+    CandumpReplay replay(decoder);
+    replay.replay(LOG, sizeof(LOG) - 1);
+
+    const CandumpReplayStats& stats = replay.getStats();
+    TEST_ASSERT_EQUAL_UINT32(6, stats.lines);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.decoded);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.malformed);
+    TEST_ASSERT_EQUAL_UINT32(2, decoder.getDecodedFrameCount());
+
+    float rpm = 0.0f;
+    TEST_ASSERT_TRUE(decoder.getValue(CAN_SIGNAL_ENGINE_RPM, replay.getLastTimestampMillis(), 500, rpm));
+    TEST_ASSERT_EQUAL_FLOAT(4000.0f, rpm);
+}
+
+void test_replays_a_log_file(void) {
+    int rpmFrames;
+    float lastRpm;
+    std::string log = syntheticLog(2, rpmFrames, lastRpm);
+    char path[] = "/tmp/candump_replay_XXXXXX";
+    FILE* file = fdopen(mkstemp(path), "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(log.c_str(), file);
+    fclose(file);
+
+    CanSignalDecoder fromFile(TABLE, 2);
+    CanSignalDecoder fromMemory(TABLE, 2);
+    CandumpReplay fileReplay(fromFile);
+    CandumpReplay memoryReplay(fromMemory);
+    TEST_ASSERT_TRUE(fileReplay.replayFile(path));
+    memoryReplay.replay(log.data(), log.size());
+    remove(path);
+
+    TEST_ASSERT_EQUAL_UINT32(memoryReplay.getStats().frames, fileReplay.getStats().frames);
+    TEST_ASSERT_EQUAL_UINT32(rpmFrames, fileReplay.getStats().decoded);
+    TEST_ASSERT_EQUAL_UINT32(0, fileReplay.getStats().malformed);
+    TEST_ASSERT_FALSE(fileReplay.replayFile("/nonexistent/candump.log"));
+}
+
+void test_replay_throughput(void) {
+    int rpmFrames;
+    float lastRpm;
+    std::string log = syntheticLog(60, rpmFrames, lastRpm);
+
+    // Parse and decode, the whole log at once
+    CanSignalDecoder decoder(TABLE, 2);
+    CandumpReplay replay(decoder);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    replay.replay(log.data(), log.size());
+    double replaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const CandumpReplayStats& stats = replay.getStats();
+
+    TEST_ASSERT_EQUAL_UINT32(0, stats.malformed);
+    TEST_ASSERT_EQUAL_UINT32(rpmFrames, stats.decoded);
+    float rpm = 0.0f;
+    TEST_ASSERT_TRUE(decoder.getValue(CAN_SIGNAL_ENGINE_RPM, replay.getLastTimestampMillis(), 500, rpm));
+    TEST_ASSERT_EQUAL_FLOAT(lastRpm, rpm);
+
+    // Decode alone, as the receive task does with frames from the driver
+    std::vector<CanFrame> frames;
+    std::vector<uint32_t> timestamps;
+    size_t position = 0;
+    while (position < log.size()) {
+        size_t newline = log.find('\n', position);
+        CanFrame frame;
+        uint32_t timestamp;
+        CanSignalDecoder::parseCandumpLine(log.substr(position, newline - position).c_str(), frame, timestamp);
+        frames.push_back(frame);
+        timestamps.push_back(timestamp);
+        position = newline + 1;
+    }
+    CanSignalDecoder decodeOnly(TABLE, 2);
+    const int PASSES = 10;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (size_t i = 0; i < frames.size(); i++) {
+            decodeOnly.decode(frames[i], timestamps[i]);
+        }
+    }
+    double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL_UINT32(rpmFrames * PASSES, decodeOnly.getDecodedFrameCount());
+
+    double replayRate = stats.frames / replaySeconds;
+    double decodeRate = frames.size() * PASSES / decodeSeconds;
+    char message[160];
+    snprintf(message, sizeof(message), "%lu frames (%lu s of bus): replay %.2f M frames/s, decode alone %.1f M frames/s (host)",
+             (unsigned long)stats.frames, 60UL, replayRate / 1e6, decodeRate / 1e6);
+    TEST_MESSAGE(message);
+
+    // A saturated 500 kbit/s bus carries under 4500 standard frames per second
+    TEST_ASSERT_GREATER_THAN(100000.0, replayRate);
+    TEST_ASSERT_GREATER_THAN(1000000.0, decodeRate);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_decodes_big_endian_candump_frame);
+    RUN_TEST(test_decodes_signed_little_endian_scaled);
+    RUN_TEST(test_frame_stored_after_the_clock_read_is_fresh);
+    RUN_TEST(test_never_written_signal_is_invalid);
+    RUN_TEST(test_acceptance_filter_passes_every_table_id);
+    RUN_TEST(test_replays_a_multi_line_log);
+    RUN_TEST(test_replays_a_log_file);
+    RUN_TEST(test_replay_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,128 @@
+// Piecewise-linear dial calibration: MPH -> steps -> MPH round trips,
+// monotonicity both ways, and rejected tables, in several drive modes
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "DialGeometry.h"
+
+// A face printed tight at the bottom of the scale and open towards the top,
+// in full steps past 0 MPH at every 10 MPH
+static const uint16_t NON_LINEAR[DIAL_CALIBRATION_POINTS] = {0, 120, 270, 450, 660, 900, 1160, 1440, 1730, 2030};
+
+static const int HOME_CENTER_FULL_STEPS = 700;
+
+// Half a step in MPH on the segment holding this speed
+static float halfStepMph(const uint16_t fullStepsAtKnot[], int microsteps, float mph) {
+    int segment = (int)((mph - MIN_SPEED_MPH) / DialGeometry::KNOT_SPACING_MPH);
+    segment = segment > DIAL_CALIBRATION_POINTS - 2 ? DIAL_CALIBRATION_POINTS - 2 : segment;
+    float span = (float)(fullStepsAtKnot[segment + 1] - fullStepsAtKnot[segment]) * microsteps;
+    return 0.5f * DialGeometry::KNOT_SPACING_MPH / span;
+}
+
+static void checkTable(const uint16_t fullStepsAtKnot[], int microsteps) {
+    DialGeometry dial(microsteps);
+    TEST_ASSERT_TRUE(dial.setCalibration(fullStepsAtKnot));
+    int homeCenter = HOME_CENTER_FULL_STEPS * microsteps;
+
+    // Every knot lands exactly where it was measured
+    for (int i = 0; i < DIAL_CALIBRATION_POINTS; i++) {
+        float mph = MIN_SPEED_MPH + i * DialGeometry::KNOT_SPACING_MPH;
+        TEST_ASSERT_EQUAL_INT(dial.getZeroOffsetSteps() + fullStepsAtKnot[i] * microsteps, dial.stepsFromHome(mph));
+    }
+
+    // MPH -> steps never falls, and reads back within half a step of its segment
+    int previous = dial.stepsFromHome(MIN_SPEED_MPH);
+    float worst = 0.0f;
+    float worstRatio = 0.0f;
+    for (float mph = MIN_SPEED_MPH; mph <= MAX_SPEED_MPH; mph += 0.01f) {
+        int steps = dial.stepsFromHome(mph);
+        TEST_ASSERT_GREATER_OR_EQUAL(previous, steps);
+        previous = steps;
+
+        float error = fabsf(dial.mphAtPosition(dial.wrap(homeCenter + steps), homeCenter) - mph);
+        float bound = halfStepMph(fullStepsAtKnot, microsteps, mph);
+        TEST_ASSERT_LESS_OR_EQUAL(bound * 1.01f, error);
+        worst = error > worst ? error : worst;
+        worstRatio = error / bound > worstRatio ? error / bound : worstRatio;
+    }
+
+    // Steps -> MPH rises with every step up to the top knot, and goes back to the same step
+    int top = fullStepsAtKnot[DIAL_CALIBRATION_POINTS - 1] * microsteps;
+    float previousMph = -1.0f;
+    for (int fromZero = 0; fromZero <= top; fromZero++) {
+        int position = dial.wrap(homeCenter + dial.getZeroOffsetSteps() + fromZero);
+        float mph = dial.mphAtPosition(position, homeCenter);
+        TEST_ASSERT_GREATER_THAN(previousMph, mph);
+        previousMph = mph;
+        TEST_ASSERT_EQUAL_INT(dial.getZeroOffsetSteps() + fromZero, dial.stepsFromHome(mph));
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%dx: worst MPH round trip %.4f MPH (%.2f of the local half step)",
+             microsteps, worst, worstRatio);
+    TEST_MESSAGE(message);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_non_linear_table_round_trips_in_every_mode(void) {
+    const int MODES[] = {1, 2, 8, 16};
+    for (int i = 0; i < 4; i++) {
+        checkTable(NON_LINEAR, MODES[i]);
+    }
+}
+
+void test_linear_table_matches_the_default_scale(void) {
+    uint16_t linear[DIAL_CALIBRATION_POINTS];
+    DialGeometry::linearCalibration(linear);
+    TEST_ASSERT_TRUE(DialGeometry::isValidCalibration(linear));
+    checkTable(linear, 1);
+
+    DialGeometry calibrated(1);
+    DialGeometry fresh(1);
+    calibrated.setCalibration(linear);
+    for (float mph = MIN_SPEED_MPH; mph <= MAX_SPEED_MPH; mph += 0.05f) {
+        TEST_ASSERT_EQUAL_INT(fresh.stepsFromHome(mph), calibrated.stepsFromHome(mph));
+    }
+}
+
+void test_invalid_tables_are_rejected(void) {
+    uint16_t table[DIAL_CALIBRATION_POINTS];
+    DialGeometry dial(1);
+    DialGeometry fresh(1);
+
+    // Not starting at 0 MPH
+    memcpy(table, NON_LINEAR, sizeof(table));
+    table[0] = 5;
+    TEST_ASSERT_FALSE(dial.setCalibration(table));
+
+    // A flat segment: two speeds on one step, and no inverse
+    memcpy(table, NON_LINEAR, sizeof(table));
+    table[4] = table[3];
+    TEST_ASSERT_FALSE(dial.setCalibration(table));
+
+    // Falling
+    memcpy(table, NON_LINEAR, sizeof(table));
+    table[6] = table[5] - 1;
+    TEST_ASSERT_FALSE(dial.setCalibration(table));
+
+    // A full revolution would put 90 MPH on top of 0 MPH
+    memcpy(table, NON_LINEAR, sizeof(table));
+    table[DIAL_CALIBRATION_POINTS - 1] = STEPS_PER_REVOLUTION;
+    TEST_ASSERT_FALSE(dial.setCalibration(table));
+
+    // The scale is left as it was
+    for (float mph = MIN_SPEED_MPH; mph <= MAX_SPEED_MPH; mph += 0.5f) {
+        TEST_ASSERT_EQUAL_INT(fresh.stepsFromHome(mph), dial.stepsFromHome(mph));
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_non_linear_table_round_trips_in_every_mode);
+    RUN_TEST(test_linear_table_matches_the_default_scale);
+    RUN_TEST(test_invalid_tables_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,223 @@
+// Drift correction with injected skipped steps: SpeedometerWheel's
+// updateMotion() and checkDrift() on the host, with the step interrupt feeding
+// a MarkerCrossingDetector from a rotor that misses some of the steps
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "DialGeometry.h"
+#include "MarkerCrossingDetector.h"
+#include "MotionPlanner.h"
+#include "SimulatedStepTimer.h"
+#include "StepGenerator.h"
+#include "StepScheduler.h"
+
+// Counts steps, drives nothing
+struct CountingDrive {
+    typedef int Phase;
+    static const int MICROSTEPS = 1;
+    static const int PHASE_COUNT = 4;
+    static void buildPhases(const int[4], Phase* phases) {
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            phases[i] = i;
+        }
+    }
+    static void begin(const int[4]) {}
+    static void apply(const Phase&) {}
+};
+
+static const uint32_t MIN_INTERVAL_US = 1953;    // Motor's top rate, full steps
+static const float NEEDLE_VELOCITY = 455.0f;     // 20 MPH/s in full steps
+static const float NEEDLE_ACCELERATION = 910.0f;
+static const int MARKER_START = 1000;            // Full steps
+static const int MARKER_WIDTH = 40;
+
+struct Needle {
+    DialGeometry dial;
+    StepGenerator<CountingDrive> generator;
+    SimulatedStepTimer timer;
+    MarkerCrossingDetector markerWatch;
+    MotionPlanner planner;
+    StepScheduler scheduler;
+    int stepSize;
+    int currentPosition;         // Commanded wheel position, wrapped
+    int32_t generatorOffset;     // Wheel position = wrap(generator position + offset)
+    int32_t rotorError;          // Where the rotor really is, less the generator position
+    int skipsLeft;               // Steps the rotor is still to miss
+    uint32_t driftCorrections;
+    int lastDriftSteps;
+    uint32_t now;
+    uint32_t loops;
+
+    explicit Needle(int microsteps)
+        : dial(microsteps),
+          generator(0, 1, 2, 3),
+          markerWatch(dial),
+          planner(NEEDLE_VELOCITY * microsteps, NEEDLE_ACCELERATION * microsteps),
+          scheduler(MIN_INTERVAL_US / microsteps),
+          stepSize(microsteps),
+          currentPosition(0),
+          generatorOffset(0),
+          rotorError(0),
+          skipsLeft(0),
+          driftCorrections(0),
+          lastDriftSteps(0),
+          now(0),
+          loops(0) {
+        timer.begin(onTick, this, MIN_INTERVAL_US / microsteps);
+    }
+
+    bool endstopAt(int32_t rotor) const {
+        return dial.wrap(rotor - MARKER_START * stepSize) < MARKER_WIDTH * stepSize;
+    }
+
+    static bool onTick(void* context) {
+        Needle* needle = static_cast<Needle*>(context);
+        int32_t position = needle->generator.getPosition();
+        needle->markerWatch.sample(position, needle->endstopAt(position + needle->rotorError));
+        if (needle->generator.tick() && needle->skipsLeft > 0) {
+            needle->rotorError -= needle->generator.getPosition() - position;  // The rotor stayed put
+            needle->skipsLeft--;
+        }
+        return false;
+    }
+
+    // SpeedometerWheel::checkDrift()
+    void checkDrift() {
+        MarkerCrossing crossing;
+        int drift;
+        if (!markerWatch.takeCrossing(crossing) ||
+            !markerWatch.measureDrift(crossing, generatorOffset, MARKER_START * stepSize, MARKER_WIDTH * stepSize, drift)) {
+            return;
+        }
+        float target = planner.getTarget();
+        planner.shift((float)-drift);
+        planner.setTarget(target);
+        currentPosition = dial.wrap(currentPosition - drift);
+        generatorOffset -= drift;
+        driftCorrections++;
+        lastDriftSteps = drift;
+    }
+
+    // SpeedometerWheel::update() with updateMotion(), 8-13 ms after the last
+    void update() {
+        uint32_t dtMicros = 8000 + (loops++ * 7919) % 5000;
+        now += dtMicros;
+        timer.advanceTo(now);
+        float dt = dtMicros / 1000000.0f;
+
+        checkDrift();
+        planner.update(dt);
+        float lead = scheduler.leadPosition(planner.getPosition(), planner.getVelocity(), planner.getTarget(), dt);
+        int leadSteps = dial.wrap((int)lroundf(lead));
+        int steps = dial.shortestPath(currentPosition, leadSteps);
+        if (steps != 0) {
+            generator.moveBy(steps);
+            currentPosition = leadSteps;
+        }
+        int32_t pending = generator.getTarget() - generator.getPosition();
+        float stepUnderway = pending > 0 ? timer.getPeriodFraction() : pending < 0 ? -timer.getPeriodFraction() : 0.0f;
+        float backlog = pending - stepUnderway + (lead - lroundf(lead));
+        timer.setInterval(scheduler.interval(planner.getVelocity(), backlog, dt));
+        if (planner.isSettled()) {
+            planner.shift(dial.wrap((int)lroundf(planner.getPosition())) - planner.getPosition());
+        }
+    }
+
+    // moveToMPH(): the short way round to a wheel position, then until settled
+    void moveTo(int fullSteps) {
+        int from = (int)lroundf(planner.getPosition());
+        planner.setTarget((float)(from + dial.shortestPath(dial.wrap(from), fullSteps * stepSize)));
+        while (!(planner.isSettled() && !generator.isMoving())) {
+            update();
+        }
+        update();  // The loop pass that takes a crossing made on the last steps
+    }
+
+    int rotorPosition() const { return dial.wrap(generator.getPosition() + rotorError); }
+    int wheelPosition() const { return dial.wrap(generator.getPosition() + generatorOffset); }
+    int residualError() const { return dial.shortestPath(rotorPosition(), wheelPosition()); }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Lose steps on a move that stays clear of the marker, then cross it
+static void checkCorrectedOnCrossing(int microsteps, bool clockwise, int skippedFullSteps) {
+    Needle needle(microsteps);
+    int start = clockwise ? 0 : 2000;
+    int lossy = clockwise ? 600 : 1400;
+    int across = clockwise ? 1400 : 600;
+
+    needle.moveTo(start);
+    needle.skipsLeft = skippedFullSteps * microsteps;
+    needle.moveTo(lossy);
+    TEST_ASSERT_EQUAL_INT(0, needle.skipsLeft);
+    TEST_ASSERT_EQUAL_INT(0, (int)needle.driftCorrections);
+    TEST_ASSERT_EQUAL_INT((clockwise ? 1 : -1) * skippedFullSteps * microsteps, needle.residualError());
+
+    needle.moveTo(across);
+    TEST_ASSERT_EQUAL_INT(1, (int)needle.driftCorrections);
+    TEST_ASSERT_EQUAL_INT((clockwise ? 1 : -1) * skippedFullSteps * microsteps, needle.lastDriftSteps);
+    TEST_ASSERT_EQUAL_INT(0, needle.residualError());
+    TEST_ASSERT_EQUAL_INT(across * microsteps, needle.rotorPosition());   // And the needle still gets there
+}
+
+void test_skipped_steps_are_corrected_on_the_next_crossing(void) {
+    const int MODES[] = {1, 2, 8};
+    for (int i = 0; i < 3; i++) {
+        checkCorrectedOnCrossing(MODES[i], true, 6);
+        checkCorrectedOnCrossing(MODES[i], false, 6);
+        checkCorrectedOnCrossing(MODES[i], true, MARKER_WIDTH / 2);
+    }
+}
+
+void test_drift_inside_the_deadband_is_left_alone(void) {
+    Needle needle(1);
+    needle.skipsLeft = MarkerCrossingDetector::DRIFT_DEADBAND;
+    needle.moveTo(600);
+    needle.moveTo(1400);
+    TEST_ASSERT_EQUAL_INT(0, (int)needle.driftCorrections);
+    TEST_ASSERT_EQUAL_INT(MarkerCrossingDetector::DRIFT_DEADBAND, needle.residualError());
+}
+
+void test_repeated_skips_never_outlast_a_crossing(void) {
+    Needle needle(2);
+    srand(11);
+    int worstResidual = 0;
+    int skipped = 0;
+    const int ROUNDS = 200;
+    for (int round = 0; round < ROUNDS; round++) {
+        // A lossy move on one side of the marker, then across it, either way
+        // and always the short way round
+        bool clockwise = rand() % 2 == 0;
+        int before = 50 + rand() % 450;
+        int after = 50 + rand() % 450;
+        int lossy = clockwise ? MARKER_START - before : MARKER_START + MARKER_WIDTH + before;
+        needle.moveTo(clockwise ? lossy - 400 : lossy + 400);
+        needle.skipsLeft = rand() % (12 * needle.stepSize);
+        skipped += needle.skipsLeft;
+        needle.moveTo(lossy);
+        needle.moveTo(clockwise ? MARKER_START + MARKER_WIDTH + after : MARKER_START - after);
+
+        int residual = abs(needle.residualError());
+        worstResidual = residual > worstResidual ? residual : worstResidual;
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%d rounds, %d steps skipped, %u corrections, worst residual after a crossing %d steps",
+             ROUNDS, skipped, (unsigned)needle.driftCorrections, worstResidual);
+    TEST_MESSAGE(message);
+
+    // Whatever was lost before a crossing, at most the deadband is left after it
+    TEST_ASSERT_LESS_OR_EQUAL(MarkerCrossingDetector::DRIFT_DEADBAND * needle.stepSize, worstResidual);
+    TEST_ASSERT_GREATER_THAN(ROUNDS / 2, (int)needle.driftCorrections);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_skipped_steps_are_corrected_on_the_next_crossing);
+    RUN_TEST(test_drift_inside_the_deadband_is_left_alone);
+    RUN_TEST(test_repeated_skips_never_outlast_a_crossing);
+    return UNITY_END();
+}
@@ -0,0 +1,169 @@
+// Shift-detection latency and misclassification of the timed and HMM gear
+// classifiers on the same labeled synthetic drive
+#include <unity.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <stdio.h>
+#include "TimedGearClassifier.h"
+#include "HmmGearClassifier.h"
+#include "VehicleParameters.h"
+
+static const uint32_t STEP_MS = 10;   // RPMHandler runs at the 100 Hz loop rate
+static const int SHIFTS = 300;
+static const uint32_t CLUTCH_SLIP_MS = 150;
+
+struct ClassifierScore {
+    std::vector<uint32_t> latencies;  // Clutch release to the new gear being shown
+    uint32_t missed;                  // Gear never shown before the next shift
+    uint32_t samples;
+    uint32_t wrong;                   // Showing a gear that is neither the engaged one nor the previous one
+
+    ClassifierScore() : missed(0), samples(0), wrong(0) {}
+
+    uint32_t percentile(float fraction) {
+        std::sort(latencies.begin(), latencies.end());
+        return latencies.empty() ? 0 : latencies[(size_t)(fraction * (latencies.size() - 1))];
+    }
+};
+
+// Labeled drive on the four-speed overdrive box, whose 4th/overdrive and
+// 3rd/4th ratios are the closest pairs: engaged stretches with the shaft
+// accelerating or slowing, separated by clutch-in shifts during which the
+// engine falls short of the next gear's revs, then slips up to them over
+// CLUTCH_SLIP_MS after release. Engine and shaft readings carry noise.
+template <typename Classifier>
+static ClassifierScore scoreDrive(Classifier& classifier, const VehicleParameters& parameters, unsigned seed) {
+    std::mt19937 random(seed);
+    std::normal_distribution<float> engineNoise(0.0f, 0.01f);
+    std::normal_distribution<float> shaftNoise(0.0f, 0.015f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float* ratios = parameters.transmissionRatios;
+
+    ClassifierScore score;
+    uint32_t now = 0;
+    float shaft = 600.0f;
+    int gear = GEAR_1;
+    int previousGear = NEUTRAL;
+    float engine = shaft * ratios[gear];
+
+    for (int shift = 0; shift < SHIFTS; shift++) {
+        // Engaged: shown latency is measured from the clutch release
+        uint32_t engagedMs = 1500 + (uint32_t)(unit(random) * 2500.0f);
+        float acceleration = (unit(random) - 0.4f) * 600.0f;
+        bool shown = false;
+        float slipFrom = engine;
+        for (uint32_t t = 0; t < engagedMs; t += STEP_MS, now += STEP_MS) {
+            shaft = std::min(std::max(shaft + acceleration * STEP_MS * 0.001f, 300.0f), 4500.0f);
+            engine = shaft * ratios[gear];
+            if (t < CLUTCH_SLIP_MS) {
+                engine = slipFrom + (engine - slipFrom) * (float)t / (float)CLUTCH_SLIP_MS;
+            }
+            Gear reported = classifier.update(engine * (1.0f + engineNoise(random)),
+                                              shaft * (1.0f + shaftNoise(random)), now);
+            if (reported == gear && !shown) {
+                shown = true;
+                score.latencies.push_back(t);
+            }
+            score.samples++;
+            if (reported != NEUTRAL && reported != gear && reported != previousGear) {
+                score.wrong++;
+            }
+        }
+        if (!shown) {
+            score.missed++;
+        }
+
+        // Next gear one up or down, mostly up at low shaft speed
+        int next = gear + ((unit(random) < (shaft < 1500.0f ? 0.8f : 0.35f)) ? 1 : -1);
+        if (next < GEAR_1 || ratios[next] <= 0.0f || next >= GEAR_COUNT) {
+            next = gear == GEAR_1 ? GEAR_2 : gear - 1;
+        }
+
+        // Clutch in: shaft coasts, engine heads for 85% of the new gear's revs
+        uint32_t clutchMs = 250 + (uint32_t)(unit(random) * 350.0f);
+        float engineFrom = engine;
+        for (uint32_t t = 0; t < clutchMs; t += STEP_MS, now += STEP_MS) {
+            shaft *= 0.9995f;
+            float blend = (float)t / (float)clutchMs;
+            engine = engineFrom + (0.85f * shaft * ratios[next] - engineFrom) * blend;
+            Gear reported = classifier.update(engine * (1.0f + engineNoise(random)),
+                                              shaft * (1.0f + shaftNoise(random)), now);
+            score.samples++;
+            if (reported != NEUTRAL && reported != gear && reported != next) {
+                score.wrong++;
+            }
+        }
+        previousGear = gear;
+        gear = next;
+    }
+    return score;
+}
+
+static void report(const char* name, ClassifierScore& score) {
+    char message[160];
+    snprintf(message, sizeof(message), "%s: shift latency median %lu ms, p95 %lu ms, missed %lu/%d, misclassified %.3f%%",
+             name, (unsigned long)score.percentile(0.5f), (unsigned long)score.percentile(0.95f),
+             (unsigned long)score.missed, SHIFTS, 100.0f * score.wrong / score.samples);
+    TEST_MESSAGE(message);
+}
+
+static VehicleParameters parameters;
+static VehicleFactors factors;
+
+void setUp(void) {
+    parameters = defaultVehicleParameters<Mgb4SpeedOverdriveProfile>();
+    deriveVehicleFactors(parameters, factors);
+}
+
+void tearDown(void) {}
+
+void test_timed_classifier_waits_out_the_stability_timeout(void) {
+    TimedGearClassifier timed(&factors);
+    timed.setStabilityTimeout(parameters.gearStabilityTimeoutMs);
+    ClassifierScore score = scoreDrive(timed, parameters, 1);
+    report("timed", score);
+
+    TEST_ASSERT_GREATER_OR_EQUAL(parameters.gearStabilityTimeoutMs, score.percentile(0.5f));
+    TEST_ASSERT_LESS_THAN(SHIFTS / 50 + 1, score.missed);
+}
+
+void test_hmm_classifier_confirms_faster_without_more_errors(void) {
+    TimedGearClassifier timed(&factors);
+    timed.setStabilityTimeout(parameters.gearStabilityTimeoutMs);
+    HmmGearClassifier hmm(parameters.transmissionRatios);
+    ClassifierScore timedScore = scoreDrive(timed, parameters, 2);
+    ClassifierScore hmmScore = scoreDrive(hmm, parameters, 2);
+    report("HMM", hmmScore);
+
+    TEST_ASSERT_LESS_THAN(timedScore.percentile(0.5f) / 2, hmmScore.percentile(0.5f));
+    TEST_ASSERT_LESS_THAN(parameters.gearStabilityTimeoutMs, hmmScore.percentile(0.95f));
+    TEST_ASSERT_LESS_THAN(SHIFTS / 50 + 1, hmmScore.missed);
+    TEST_ASSERT_LESS_OR_EQUAL(timedScore.wrong + hmmScore.samples / 1000, hmmScore.wrong);
+}
+
+void test_timed_classifier_drops_to_neutral_without_a_valid_gear(void) {
+    TimedGearClassifier timed(&factors);
+    timed.setStabilityTimeout(750);
+    uint32_t now = 0;
+    for (; now <= 1000; now += STEP_MS) {
+        timed.update(1000.0f * parameters.transmissionRatios[GEAR_2], 1000.0f, now);
+    }
+    TEST_ASSERT_EQUAL_INT(GEAR_2, timed.getConfirmedGear());
+
+    // Clutch held in: ratio matches nothing
+    uint32_t clutchStart = now;
+    while (timed.update(3000.0f, 1000.0f, now) != NEUTRAL) {
+        now += STEP_MS;
+        TEST_ASSERT_LESS_THAN(2000, now - clutchStart);
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(750, now - clutchStart);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_timed_classifier_waits_out_the_stability_timeout);
+    RUN_TEST(test_hmm_classifier_confirms_faster_without_more_errors);
+    RUN_TEST(test_timed_classifier_drops_to_neutral_without_a_valid_gear);
+    return UNITY_END();
+}
@@ -0,0 +1,86 @@
+// Ratio learning on a synthetic drive whose gearbox differs from the nominal table
+#include <unity.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include "GearRatioLearner.h"
+
+// Four-speed overdrive table with each gear a few percent off
+static const float NOMINAL[GEAR_COUNT] = {3.095f, 0.0f, 3.44f, 2.167f, 1.382f, 1.0f, 0.802f};
+static const float ACTUAL[GEAR_COUNT] = {3.095f, 0.0f, 3.44f * 1.04f, 2.167f * 0.97f, 1.382f * 1.03f,
+                                         1.0f * 0.98f, 0.802f * 1.05f};
+
+// Steady driving in each forward gear with 1% sensor noise, then a clutch-in
+// sweep where engine and shaft speeds are unrelated
+static int drive(GearRatioLearner& learner, const float* ratios, int laps) {
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    int published = 0;
+    for (int lap = 0; lap < laps; lap++) {
+        for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+            for (int k = 0; k < 300; k++) {
+                float shaftRPM = 1000.0f + 3.0f * k;
+                published += learner.observe(shaftRPM * ratios[gear] * (1.0f + noise(rng)),
+                                             shaftRPM * (1.0f + noise(rng)));
+            }
+            for (int k = 0; k < 30; k++) {
+                learner.observe(1500.0f + 50.0f * k, 600.0f);
+            }
+        }
+    }
+    return published;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_learned_ratios_converge_to_the_actual_gearbox(void) {
+    GearRatioLearner learner;
+    learner.reset(NOMINAL);
+    int published = drive(learner, ACTUAL, 20);
+
+    for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+        float error = learner.getLearnedRatio(static_cast<Gear>(gear)) / ACTUAL[gear] - 1.0f;
+        char message[96];
+        snprintf(message, sizeof(message), "gear %d: nominal %.3f actual %.3f learned %.3f (%+.2f%%)", gear,
+                 NOMINAL[gear], ACTUAL[gear], learner.getLearnedRatio(static_cast<Gear>(gear)), error * 100.0f);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.0f, error);
+    }
+    TEST_ASSERT_GREATER_THAN(0, published);
+
+    // Nothing was observed in reverse, and neutral is not a ratio
+    TEST_ASSERT_EQUAL_FLOAT(NOMINAL[REVERSE], learner.getLearnedRatio(REVERSE));
+    TEST_ASSERT_EQUAL_UINT32(0, learner.getSampleCount(REVERSE));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, learner.getLearnedRatio(NEUTRAL));
+}
+
+void test_nominal_gearbox_stays_put(void) {
+    GearRatioLearner learner;
+    learner.reset(NOMINAL);
+    drive(learner, NOMINAL, 20);
+
+    for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.003f, 0.0f, learner.getDeviation(static_cast<Gear>(gear)));
+    }
+}
+
+void test_idle_and_crawl_samples_are_ignored(void) {
+    GearRatioLearner learner;
+    learner.reset(NOMINAL);
+    for (int k = 0; k < 1000; k++) {
+        learner.observe(500.0f, 500.0f / NOMINAL[GEAR_4]);    // Engine below the learning floor
+        learner.observe(800.0f, 800.0f / NOMINAL[GEAR_1]);    // Shaft too slow to resolve
+    }
+    for (int gear = REVERSE; gear < GEAR_COUNT; gear++) {
+        TEST_ASSERT_EQUAL_UINT32(0, learner.getSampleCount(static_cast<Gear>(gear)));
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_learned_ratios_converge_to_the_actual_gearbox);
+    RUN_TEST(test_nominal_gearbox_stays_put);
+    RUN_TEST(test_idle_and_crawl_samples_are_ignored);
+    return UNITY_END();
+}
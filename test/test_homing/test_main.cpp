@@ -0,0 +1,266 @@
+// Homing against a simulated endstop: HomingSequencer driven the way
+// SpeedometerWheel::updateHoming() drives it, with the step interrupt's
+// EndstopEdgeWatch on a SimulatedStepTimer and a jittery loop
+#include <unity.h>
+#include <stdio.h>
+#include "DialGeometry.h"
+#include "EndstopEdgeWatch.h"
+#include "HomingSequencer.h"
+#include "SimulatedStepTimer.h"
+#include "StepGenerator.h"
+
+// Counts steps, drives nothing
+struct CountingDrive {
+    typedef int Phase;
+    static const int MICROSTEPS = 1;
+    static const int PHASE_COUNT = 4;
+    static void buildPhases(const int[4], Phase* phases) {
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            phases[i] = i;
+        }
+    }
+    static void begin(const int[4]) {}
+    static void apply(const Phase&) {}
+};
+
+static const uint32_t STEP_INTERVAL_US = 1953;   // Default 15 RPM in full steps
+static const int MARKER_WIDTH = 40;              // Full steps
+
+struct Wheel {
+    DialGeometry dial;
+    StepGenerator<CountingDrive> generator;
+    SimulatedStepTimer timer;
+    EndstopEdgeWatch edgeWatch;
+    HomingSequencer homing;
+    int32_t moveStart;
+    uint32_t now;
+    uint32_t loops;
+
+    // The marker, in wrapped drive steps; the generator starts at dial position 0
+    int markerStart;
+    int markerWidth;
+    int stuckFrom;       // Sensor reads triggered from here on (-1 = works)
+
+    Wheel(int microsteps, int markerStartFullSteps)
+        : dial(microsteps),
+          generator(0, 1, 2, 3),
+          homing(dial),
+          moveStart(0),
+          now(0),
+          loops(0),
+          markerStart(markerStartFullSteps * microsteps),
+          markerWidth(MARKER_WIDTH * microsteps),
+          stuckFrom(-1) {
+        // A full step at the motor's rate whatever the drive mode
+        timer.begin(onTick, this, STEP_INTERVAL_US / microsteps);
+    }
+
+    bool endstopAt(int32_t position) const {
+        if (stuckFrom >= 0 && position >= stuckFrom) {
+            return true;
+        }
+        return markerWidth > 0 && dial.wrap(position - markerStart) < markerWidth;
+    }
+
+    static bool onTick(void* context) {
+        Wheel* wheel = static_cast<Wheel*>(context);
+        int32_t position = wheel->generator.getPosition();
+        wheel->edgeWatch.sample(position, wheel->endstopAt(position));
+        wheel->generator.tick();
+        return false;
+    }
+
+    // SpeedometerWheel::updateHoming() with the step timer running
+    void update() {
+        now += 8000 + (loops++ * 7919) % 5000;
+        timer.advanceTo(now);
+
+        bool moveDone = !generator.isMoving() && edgeWatch.hasSampled(generator.getTarget());
+        EndstopEdge edge;
+        while (edgeWatch.take(edge)) {
+            int32_t end = moveStart + homing.edge(edge.position - moveStart, edge.triggered);
+            if (end != generator.getTarget()) {
+                generator.moveTo(end);
+            }
+        }
+        if (!moveDone || generator.isMoving()) {
+            return;
+        }
+
+        int steps = homing.advance(endstopAt(generator.getPosition()));
+        if (steps != 0) {
+            edgeWatch.clear();
+            moveStart = generator.getTarget();
+            generator.moveBy(steps);
+        }
+    }
+
+    // Simulated time until the search ends
+    uint32_t run() {
+        while (homing.isActive() && now < 60000000) {
+            update();
+        }
+        return now;
+    }
+
+    int rotorPosition() const { return dial.wrap(generator.getPosition()); }
+};
+
+static void checkFound(const Wheel& wheel) {
+    TEST_ASSERT_EQUAL_INT(HOMING_COMPLETE, wheel.homing.getStatus());
+    TEST_ASSERT_EQUAL_INT(wheel.markerStart, wheel.homing.getMarkerStart());
+    TEST_ASSERT_EQUAL_INT(wheel.markerWidth, wheel.homing.getMarkerWidth());
+    TEST_ASSERT_EQUAL_INT(wheel.homing.getMarkerCenter(), wheel.rotorPosition());
+    TEST_ASSERT_EQUAL_INT(wheel.homing.getPosition(), wheel.rotorPosition());
+    TEST_ASSERT_FALSE(wheel.generator.isMoving());
+}
+
+// Time for a number of full steps at the search rate
+static float fullStepSeconds(int fullSteps) {
+    return fullSteps * STEP_INTERVAL_US / 1000000.0f;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_marker_ahead_is_found_on_the_exact_step(void) {
+    const int MODES[] = {1, 2, 8};
+    for (int i = 0; i < 3; i++) {
+        Wheel wheel(MODES[i], 700);
+        wheel.homing.start(0);
+        uint32_t micros = wheel.run();
+        checkFound(wheel);
+
+        // One sweep across the marker, then back to its centre
+        TEST_ASSERT_EQUAL_INT(2, wheel.homing.getTotalMoves());
+        TEST_ASSERT_LESS_THAN(fullStepSeconds(700 + MARKER_WIDTH + MARKER_WIDTH / 2) + 0.1f, micros / 1e6f);
+    }
+}
+
+void test_start_on_the_marker_goes_round_to_its_start(void) {
+    Wheel wheel(1, STEPS_PER_REVOLUTION - 10);
+    wheel.homing.start(0);
+    wheel.run();
+    checkFound(wheel);
+}
+
+void test_missing_marker_fails_after_both_sweeps(void) {
+    Wheel wheel(1, 0);
+    wheel.markerWidth = 0;
+    wheel.homing.start(0);
+    uint32_t micros = wheel.run();
+
+    char message[96];
+    snprintf(message, sizeof(message), "no marker: failed after %.2f s", micros / 1e6f);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_INT(HOMING_FAILED_NO_MARKER, wheel.homing.getStatus());
+    TEST_ASSERT_TRUE(wheel.homing.isFailed());
+    TEST_ASSERT_EQUAL_INT(2, wheel.homing.getTotalMoves());
+    TEST_ASSERT_EQUAL_INT(0, wheel.rotorPosition());   // 1.5 revolutions out and back
+    TEST_ASSERT_LESS_THAN(fullStepSeconds(3 * STEPS_PER_REVOLUTION) + 0.1f, micros / 1e6f);
+}
+
+void test_stuck_sensor_fails_without_a_marker_end(void) {
+    Wheel wheel(1, 300);
+    wheel.stuckFrom = 310;
+    wheel.homing.start(0);
+    wheel.run();
+    TEST_ASSERT_EQUAL_INT(HOMING_FAILED_NO_MARKER_END, wheel.homing.getStatus());
+    TEST_ASSERT_EQUAL_INT(300, wheel.homing.getMarkerStart());
+}
+
+void test_warm_boot_verify_from_either_side(void) {
+    // Saved marker a little clockwise, then a little counterclockwise of the needle
+    const int STARTS[] = {200, STEPS_PER_REVOLUTION - 200};
+    for (int i = 0; i < 2; i++) {
+        Wheel wheel(8, STARTS[i]);
+        wheel.homing.startVerify(0, wheel.markerStart, wheel.markerWidth);
+        uint32_t micros = wheel.run();
+        checkFound(wheel);
+
+        char message[96];
+        snprintf(message, sizeof(message), "verify %s: %.3f s",
+                 i == 0 ? "clockwise" : "counterclockwise", micros / 1e6f);
+        TEST_MESSAGE(message);
+    }
+}
+
+void test_warm_boot_verify_from_the_park_position(void) {
+    // SpeedometerWheel::park() leaves the needle where a counterclockwise pass starts
+    const int MODES[] = {1, 2, 8};
+    for (int i = 0; i < 3; i++) {
+        DialGeometry dial(MODES[i]);
+        HomingSequencer locate(dial);
+        int markerStart = dial.wrap(-locate.verifyStartPosition(0, MARKER_WIDTH * MODES[i], false));
+
+        Wheel wheel(MODES[i], markerStart / MODES[i]);
+        TEST_ASSERT_EQUAL_INT(0, wheel.homing.verifyStartPosition(wheel.markerStart, wheel.markerWidth, false));
+        wheel.homing.startVerify(0, wheel.markerStart, wheel.markerWidth);
+        uint32_t micros = wheel.run();
+        checkFound(wheel);
+        TEST_ASSERT_EQUAL_INT(2, wheel.homing.getTotalMoves());  // No approach: the pass, then the centre
+
+        char message[96];
+        snprintf(message, sizeof(message), "verify from park, %dx: %.3f s", MODES[i], micros / 1e6f);
+        TEST_MESSAGE(message);
+
+        // Needle usable within 300 ms of reset
+        TEST_ASSERT_LESS_THAN(0.3f, micros / 1e6f);
+    }
+}
+
+void test_warm_boot_verify_rejects_a_moved_marker(void) {
+    Wheel wheel(1, 500);
+    wheel.homing.startVerify(0, 500 + 2 * HOME_VERIFY_TOLERANCE_STEPS, wheel.markerWidth);
+    wheel.run();
+    TEST_ASSERT_EQUAL_INT(HOMING_FAILED_VERIFY, wheel.homing.getStatus());
+
+    // Right place, but half as wide: a different marker or a failing sensor
+    Wheel narrow(1, 500);
+    narrow.homing.startVerify(0, 500, 2 * MARKER_WIDTH);
+    narrow.run();
+    TEST_ASSERT_EQUAL_INT(HOMING_FAILED_VERIFY, narrow.homing.getStatus());
+}
+
+void test_worst_case_homing_time(void) {
+    uint32_t worst = 0;
+    int worstStart = 0;
+    double total = 0.0;
+    int runs = 0;
+    for (int start = 0; start < STEPS_PER_REVOLUTION; start += 8) {
+        Wheel wheel(1, start);
+        wheel.homing.start(0);
+        uint32_t micros = wheel.run();
+        checkFound(wheel);
+        if (micros > worst) {
+            worst = micros;
+            worstStart = start;
+        }
+        total += micros;
+        runs++;
+    }
+
+    // Marker just behind the needle: a whole revolution, the marker, half of it back
+    float bound = fullStepSeconds(STEPS_PER_REVOLUTION + MARKER_WIDTH + MARKER_WIDTH / 2);
+    char message[128];
+    snprintf(message, sizeof(message), "worst %.2f s (marker start %d full steps ahead), mean %.2f s, stepping alone %.2f s",
+             worst / 1e6f, worstStart, total / runs / 1e6, bound);
+    TEST_MESSAGE(message);
+
+    // Only loop latency on top of the steps: noticing an edge and the end of a move
+    TEST_ASSERT_LESS_THAN(bound + 0.1f, worst / 1e6f);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_marker_ahead_is_found_on_the_exact_step);
+    RUN_TEST(test_start_on_the_marker_goes_round_to_its_start);
+    RUN_TEST(test_missing_marker_fails_after_both_sweeps);
+    RUN_TEST(test_stuck_sensor_fails_without_a_marker_end);
+    RUN_TEST(test_warm_boot_verify_from_either_side);
+    RUN_TEST(test_warm_boot_verify_from_the_park_position);
+    RUN_TEST(test_warm_boot_verify_rejects_a_moved_marker);
+    RUN_TEST(test_worst_case_homing_time);
+    return UNITY_END();
+}
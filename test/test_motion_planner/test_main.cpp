@@ -0,0 +1,135 @@
+// MotionPlanner continuity under rapid retargeting, move time against the
+// trapezoid, and tracking lag behind a steadily rising speed
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "MotionPlanner.h"
+
+// SpeedometerWheel's defaults in full-step mode: 20 MPH/s and 40 MPH/s^2 at 2048/90 steps per MPH
+static const float STEPS_PER_MPH = 2048.0f / 90.0f;
+static const float MAX_VELOCITY = 20.0f * STEPS_PER_MPH;
+static const float MAX_ACCELERATION = 40.0f * STEPS_PER_MPH;
+static const float LOOP_SECONDS = 0.01f;
+
+// Seconds to settle on a move of distance steps from rest
+static float settleTime(float distance) {
+    MotionPlanner planner(MAX_VELOCITY, MAX_ACCELERATION);
+    planner.setTarget(distance);
+    float t = 0.0f;
+    float furthest = 0.0f;
+    while (!planner.isSettled() && t < 60.0f) {
+        planner.update(LOOP_SECONDS);
+        furthest = planner.getPosition() > furthest ? planner.getPosition() : furthest;
+        t += LOOP_SECONDS;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(distance + 0.001f, furthest);  // Never past the target
+    return t;
+}
+
+// Trapezoid, or triangle when the move is too short to reach top speed
+static float idealTime(float distance) {
+    if (distance >= MAX_VELOCITY * MAX_VELOCITY / MAX_ACCELERATION) {
+        return distance / MAX_VELOCITY + MAX_VELOCITY / MAX_ACCELERATION;
+    }
+    return 2.0f * sqrtf(distance / MAX_ACCELERATION);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_rapid_retargeting_is_continuous(void) {
+    MotionPlanner planner(MAX_VELOCITY, MAX_ACCELERATION);
+    srand(7);
+    float worstDeltaV = 0.0f;
+    float worstDeltaX = 0.0f;
+    int reversals = 0;
+    for (int i = 0; i < 20000; i++) {
+        // A new target every one to three loops, anywhere on the dial
+        if (rand() % 3 == 0) {
+            planner.setTarget((float)(rand() % 2048));
+        }
+        float position = planner.getPosition();
+        float velocity = planner.getVelocity();
+        planner.update(LOOP_SECONDS);
+
+        float deltaV = fabsf(planner.getVelocity() - velocity);
+        float deltaX = fabsf(planner.getPosition() - position);
+        worstDeltaV = deltaV > worstDeltaV ? deltaV : worstDeltaV;
+        worstDeltaX = deltaX > worstDeltaX ? deltaX : worstDeltaX;
+        reversals += planner.getVelocity() * velocity < 0.0f;
+        TEST_ASSERT_LESS_OR_EQUAL(MAX_VELOCITY * 1.0001f, fabsf(planner.getVelocity()));
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "worst per-update change: %.2f steps/s (limit %.2f), %.2f steps (limit %.2f), %d reversals",
+             worstDeltaV, MAX_ACCELERATION * LOOP_SECONDS, worstDeltaX, MAX_VELOCITY * LOOP_SECONDS, reversals);
+    TEST_MESSAGE(message);
+
+    // Velocity never jumps, whatever the targets do; position moves at most vmax * dt
+    TEST_ASSERT_LESS_OR_EQUAL(MAX_ACCELERATION * LOOP_SECONDS * 1.001f, worstDeltaV);
+    TEST_ASSERT_LESS_OR_EQUAL(MAX_VELOCITY * LOOP_SECONDS * 1.001f, worstDeltaX);
+    TEST_ASSERT_GREATER_THAN(0, reversals);
+}
+
+void test_move_time_scales_with_distance(void) {
+    const float distances[] = {1.0f, 10.0f, 100.0f, 227.0f, 500.0f, 1024.0f, 2047.0f};
+    for (size_t i = 0; i < sizeof(distances) / sizeof(distances[0]); i++) {
+        float t = settleTime(distances[i]);
+        char message[96];
+        snprintf(message, sizeof(message), "%6.0f steps: %.2f s (trapezoid %.2f s)", distances[i], t, idealTime(distances[i]));
+        TEST_MESSAGE(message);
+
+        // Within a couple of loop periods of the ideal profile
+        TEST_ASSERT_FLOAT_WITHIN(2.5f * LOOP_SECONDS, idealTime(distances[i]), t);
+    }
+}
+
+void test_rising_speed_tracks_without_stopping(void) {
+    // 0 to 60 MPH in 10 s, with a new speed from the RPM handler every 100 ms
+    const float RAMP_MPH_PER_SECOND = 6.0f;
+    const float RETARGET_SECONDS = 0.1f;
+    const float rampRate = RAMP_MPH_PER_SECOND * STEPS_PER_MPH;
+
+    MotionPlanner planner(MAX_VELOCITY, MAX_ACCELERATION);
+    float t = 0.0f;
+    float nextRetarget = 0.0f;
+    float worstLag = 0.0f;
+    float slowest = MAX_VELOCITY;
+    while (t < 10.0f) {
+        if (t >= nextRetarget - 1e-4f) {
+            planner.setTarget(rampRate * t);
+            nextRetarget += RETARGET_SECONDS;
+        }
+        planner.update(LOOP_SECONDS);
+        t += LOOP_SECONDS;
+
+        // Past the start-up transient: compare with the continuous ramp
+        if (t > 1.0f) {
+            float lag = rampRate * t - planner.getPosition();
+            worstLag = lag > worstLag ? lag : worstLag;
+            slowest = planner.getVelocity() < slowest ? planner.getVelocity() : slowest;
+        }
+    }
+
+    // Lag the planner needs to brake onto each target, plus the staircase of
+    // 100 ms targets behind the ramp
+    float brakingLag = rampRate * rampRate / (2.0f * MAX_ACCELERATION);
+    float expected = brakingLag + rampRate * RETARGET_SECONDS;
+    char message[128];
+    snprintf(message, sizeof(message), "ramp %.0f steps/s: worst lag %.1f steps (%.0f ms, %.2f MPH), slowest %.0f steps/s",
+             rampRate, worstLag, worstLag / rampRate * 1000.0f, worstLag / STEPS_PER_MPH, slowest);
+    TEST_MESSAGE(message);
+
+    // The needle never stops between targets, and stays within one update of the ramp
+    TEST_ASSERT_GREATER_THAN(0.5f * rampRate, slowest);
+    TEST_ASSERT_LESS_OR_EQUAL(expected + 1.0f, worstLag);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rapid_retargeting_is_continuous);
+    RUN_TEST(test_move_time_scales_with_distance);
+    RUN_TEST(test_rising_speed_tracks_without_stopping);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+// Warm boot decisions from the RTC and flash copies of the needle state, and
+// flash wear from repeated saves
+#include <unity.h>
+#include "NeedleStateStore.h"
+#include "ParameterStorage.h"
+
+typedef MemoryParameterStorage<64> Storage;
+
+static const int32_t STEPS = 2048;
+
+static NeedleState makeState(int32_t position, bool moving) {
+    NeedleState state;
+    memset(&state, 0, sizeof(state));
+    state.stepsPerRevolution = STEPS;
+    state.homeStartPosition = 1200;
+    state.homeMarkerWidth = 40;
+    state.position = position;
+    state.coilPhase = (uint16_t)(position & 3);
+    state.moving = moving ? 1 : 0;
+    return state;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_nothing_saved_means_full_homing(void) {
+    Storage rtc, flash;
+    NeedleStateStore store(rtc, flash);
+    NeedleState state;
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_NONE, store.load(STEPS, state));
+}
+
+void test_rtc_at_rest_is_trusted_and_mid_move_verified(void) {
+    Storage rtc, flash;
+    NeedleState state;
+    {
+        NeedleStateStore store(rtc, flash);
+        store.saveRtc(makeState(300, false));
+    }
+    NeedleStateStore resting(rtc, flash);
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_TRUST, resting.load(STEPS, state));
+    TEST_ASSERT_EQUAL_INT32(300, state.position);
+    TEST_ASSERT_EQUAL_INT32(1200, state.homeStartPosition);
+
+    // Reset while stepping: steps may have been lost
+    resting.saveRtc(makeState(310, true));
+    NeedleStateStore moving(rtc, flash);
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_VERIFY, moving.load(STEPS, state));
+    TEST_ASSERT_EQUAL_INT32(310, state.position);
+}
+
+void test_rtc_wins_over_flash(void) {
+    Storage rtc, flash;
+    NeedleStateStore store(rtc, flash);
+    store.saveFlash(makeState(1300, false));
+    store.saveRtc(makeState(700, false));
+
+    NeedleState state;
+    NeedleStateStore boot(rtc, flash);
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_TRUST, boot.load(STEPS, state));
+    TEST_ASSERT_EQUAL_INT32(700, state.position);
+}
+
+void test_flash_alone_is_always_verified(void) {
+    // Power-off loses RTC memory; the rotor could have been turned since
+    Storage rtc, flash;
+    NeedleStateStore store(rtc, flash);
+    store.saveFlash(makeState(1300, false));
+    rtc.erase();
+
+    NeedleState state;
+    NeedleStateStore boot(rtc, flash);
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_VERIFY, boot.load(STEPS, state));
+    TEST_ASSERT_EQUAL_INT32(1300, state.position);
+}
+
+void test_invalid_records_fall_back(void) {
+    Storage rtc, flash;
+    NeedleStateStore store(rtc, flash);
+    store.saveFlash(makeState(1300, false));
+    NeedleState state;
+
+    // Corrupt RTC copy: flash instead
+    store.saveRtc(makeState(700, false));
+    rtc.corruptByte(12);
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_VERIFY, NeedleStateStore(rtc, flash).load(STEPS, state));
+    TEST_ASSERT_EQUAL_INT32(1300, state.position);
+
+    // Homing started: the RTC copy no longer counts
+    store.saveRtc(makeState(700, false));
+    store.invalidateRtc();
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_VERIFY, NeedleStateStore(rtc, flash).load(STEPS, state));
+
+    // Another drive mode: both copies are in the wrong units
+    store.saveRtc(makeState(700, false));
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_NONE, NeedleStateStore(rtc, flash).load(2 * STEPS, state));
+
+    // Corrupt flash copy, nothing in RTC
+    store.invalidateRtc();
+    flash.corruptByte(20);
+    TEST_ASSERT_EQUAL_INT(WARM_BOOT_NONE, NeedleStateStore(rtc, flash).load(STEPS, state));
+}
+
+void test_unchanged_flash_record_is_not_rewritten(void) {
+    Storage rtc, flash;
+    NeedleStateStore store(rtc, flash);
+    NeedleState state;
+    store.load(STEPS, state);
+
+    // Every stop parks at the same place: one write, however many stops
+    for (int i = 0; i < 100; i++) {
+        store.saveFlash(makeState(1257, false));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, store.getFlashWrites());
+    TEST_ASSERT_EQUAL_UINT32(1, flash.getWriteCount());
+
+    // Still unchanged after a reboot reads it back
+    NeedleStateStore boot(rtc, flash);
+    boot.load(STEPS, state);
+    TEST_ASSERT_FALSE(boot.saveFlash(makeState(1257, false)));
+    TEST_ASSERT_TRUE(boot.saveFlash(makeState(1258, false)));
+    TEST_ASSERT_EQUAL_UINT32(2, flash.getWriteCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_nothing_saved_means_full_homing);
+    RUN_TEST(test_rtc_at_rest_is_trusted_and_mid_move_verified);
+    RUN_TEST(test_rtc_wins_over_flash);
+    RUN_TEST(test_flash_alone_is_always_verified);
+    RUN_TEST(test_invalid_records_fall_back);
+    RUN_TEST(test_unchanged_flash_record_is_not_rewritten);
+    return UNITY_END();
+}
@@ -0,0 +1,190 @@
+// Odometer distance, journal write rate and power-cut recovery on a RAM flash
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "JournalFlash.h"
+#include "OdometerJournal.h"
+#include "Odometer.h"
+
+typedef MemoryJournalFlash<4096, 16> Flash;
+
+static const float MPH_PER_SHAFT_RPM = 0.01747f;   // 3-speed profile, about 3434 shaft RPM at 60 MPH
+static const unsigned long LOOP_MS = 10;
+
+// Constant speed for a while, one pulse per revolution, fed at the loop rate
+struct Drive {
+    Odometer& odometer;
+    unsigned long pulses;
+    unsigned long now;
+    double revolutions;
+    double carry;
+
+    explicit Drive(Odometer& o) : odometer(o), pulses(0), now(0), revolutions(0.0), carry(0.0) {
+        odometer.update(pulses, 1, now);
+    }
+
+    void run(float mph, unsigned long durationMs) {
+        double revsPerLoop = mph / MPH_PER_SHAFT_RPM / 60.0 * LOOP_MS / 1000.0;
+        for (unsigned long end = now + durationMs; now < end;) {
+            now += LOOP_MS;
+            carry += revsPerLoop;
+            unsigned long whole = (unsigned long)carry;
+            carry -= whole;
+            pulses += whole;
+            revolutions += whole;
+            odometer.update(pulses, 1, now);
+        }
+    }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_hour_at_60_mph_is_accurate_and_rate_bounded(void) {
+    Flash flash;
+    Odometer odometer(flash);
+    TEST_ASSERT_TRUE(odometer.begin());
+    odometer.setMilesPerRevolution(MPH_PER_SHAFT_RPM / 60.0f);
+
+    Drive drive(odometer);
+    drive.run(60.0f, 3600000);
+    drive.run(0.0f, 15000);
+
+    double expected = drive.revolutions * MPH_PER_SHAFT_RPM / 60.0;
+    char message[96];
+    snprintf(message, sizeof(message), "1 h at 60 MPH: %.3f mi (expected %.3f), %lu journal writes",
+             odometer.getOdometerMiles(), expected, (unsigned long)odometer.getCommitCount());
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, expected, odometer.getOdometerMiles());
+    TEST_ASSERT_LESS_OR_EQUAL(3600000 / Odometer::MIN_COMMIT_INTERVAL_MS + 2, odometer.getCommitCount());
+    TEST_ASSERT_EQUAL_UINT32(0, odometer.getUncommittedMilliMiles());
+
+    Odometer rebooted(flash);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32(odometer.getOdometerMilliMiles(), rebooted.getOdometerMilliMiles());
+}
+
+void test_flush_commits_inside_the_rate_bound(void) {
+    Flash flash;
+    Odometer odometer(flash);
+    odometer.begin();
+    odometer.setMilesPerRevolution(MPH_PER_SHAFT_RPM / 60.0f);
+
+    // A commit has just happened, then a short hop ends with the power cut
+    Drive drive(odometer);
+    drive.run(60.0f, 7000);
+    uint32_t commits = odometer.getCommitCount();
+    TEST_ASSERT_EQUAL_UINT32(1, commits);
+    drive.run(60.0f, 2000);
+    TEST_ASSERT_GREATER_THAN(0, odometer.getUncommittedMilliMiles());
+    TEST_ASSERT_EQUAL_UINT32(commits, odometer.getCommitCount());
+
+    TEST_ASSERT_TRUE(odometer.flush(drive.now));
+    TEST_ASSERT_EQUAL_UINT32(0, odometer.getUncommittedMilliMiles());
+
+    Odometer rebooted(flash);
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_UINT32(odometer.getOdometerMilliMiles(), rebooted.getOdometerMilliMiles());
+    TEST_ASSERT_EQUAL_UINT32(odometer.getTripMilliMiles(), rebooted.getTripMilliMiles());
+}
+
+void test_distance_follows_a_new_miles_per_revolution(void) {
+    Flash flash;
+    Odometer odometer(flash);
+    odometer.begin();
+    odometer.setMilesPerRevolution(0.001f);
+
+    unsigned long pulses = 0;
+    odometer.update(pulses, 1, 0);
+    odometer.update(pulses += 1000, 1, 10);
+    TEST_ASSERT_EQUAL_UINT32(1000, odometer.getOdometerMilliMiles());
+
+    // Larger tires: each revolution now covers twice the distance
+    odometer.setMilesPerRevolution(0.002f);
+    odometer.update(pulses += 1000, 1, 20);
+    TEST_ASSERT_EQUAL_UINT32(3000, odometer.getOdometerMilliMiles());
+}
+
+void test_power_cut_recovers_the_last_or_in_flight_record(void) {
+    srand(1);
+    int bad = 0;
+    for (int trial = 0; trial < 2000; trial++) {
+        Flash flash;
+        OdometerJournal journal(flash);
+        journal.recover();
+
+        // Fill to a random point, half the trials right at a sector boundary
+        uint32_t committed = 0;
+        int records = (trial % 2) ? rand() % 9000 : 256 * (1 + rand() % 30) - rand() % 3;
+        for (int i = 0; i < records; i++) {
+            committed += 3;
+            journal.append(committed, 0);
+        }
+
+        // Power fails part way through the next few writes
+        uint32_t inFlight = committed;
+        flash.cutPowerAfter(rand() % 40);
+        for (int i = 0; i < 3; i++) {
+            inFlight = committed + 3;
+            if (!journal.append(inFlight, 0)) {
+                break;
+            }
+            committed = inFlight;
+        }
+        flash.restorePower();
+
+        OdometerJournal recovered(flash);
+        recovered.recover();
+        OdometerRecord record;
+        uint32_t value = recovered.getLatest(record) ? record.odometerMilliMiles : 0;
+        if (value != committed && value != inFlight) {
+            bad++;
+            continue;
+        }
+
+        // The journal must keep working after the torn write
+        for (int i = 0; i < 500; i++) {
+            recovered.append(++value, 0);
+        }
+        OdometerJournal again(flash);
+        again.recover();
+        if (!again.getLatest(record) || record.odometerMilliMiles != value) {
+            bad++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(0, bad);
+}
+
+void test_wear_is_spread_across_sectors(void) {
+    Flash flash;
+    OdometerJournal journal(flash);
+    journal.recover();
+    for (uint32_t value = 1; value <= 20000; value++) {
+        TEST_ASSERT_TRUE(journal.append(value * 7, value));
+    }
+
+    uint32_t lowest = flash.getEraseCount(0);
+    uint32_t highest = lowest;
+    for (int sector = 1; sector < 16; sector++) {
+        lowest = flash.getEraseCount(sector) < lowest ? flash.getEraseCount(sector) : lowest;
+        highest = flash.getEraseCount(sector) > highest ? flash.getEraseCount(sector) : highest;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(lowest + 1, highest);
+
+    OdometerJournal recovered(flash);
+    recovered.recover();
+    OdometerRecord record;
+    TEST_ASSERT_TRUE(recovered.getLatest(record));
+    TEST_ASSERT_EQUAL_UINT32(20000 * 7, record.odometerMilliMiles);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_hour_at_60_mph_is_accurate_and_rate_bounded);
+    RUN_TEST(test_flush_commits_inside_the_rate_bound);
+    RUN_TEST(test_distance_follows_a_new_miles_per_revolution);
+    RUN_TEST(test_power_cut_recovers_the_last_or_in_flight_record);
+    RUN_TEST(test_wear_is_spread_across_sectors);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+// Vehicle parameter block on the RAM-backed storage: defaults when nothing is
+// stored, rejection of corrupt, stale and out-of-range blobs, save/load round
+// trips, and what load() costs at boot
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "ParameterBlock.h"
+
+typedef MemoryParameterStorage<256> Storage;
+
+static VehicleParameters profileDefaults() {
+    return defaultVehicleParameters<Mgb4SpeedOverdriveProfile>();
+}
+
+// Parameters a user might have tuned
+static VehicleParameters tuned() {
+    VehicleParameters parameters = profileDefaults();
+    parameters.differentialRatio = 3.909f;
+    parameters.tireDiameterInches = 24.6f;
+    parameters.transmissionRatios[1] = 3.44f;
+    parameters.driveshaftPulsesPerRev = 4;
+    parameters.speedHysteresisMph = 0.5f;
+    parameters.dialCalibrationSteps[3] += 7;
+    parameters.stepperMaxStepsPerSec = 612.0f;
+    parameters.stepperMaxStepsPerSec2 = 2100.0f;
+    return parameters;
+}
+
+// Same values, ignoring the header and CRC the block fills in
+static void assertSameValues(const VehicleParameters& expected, const VehicleParameters& actual) {
+    size_t start = offsetof(VehicleParameters, differentialRatio);
+    size_t end = offsetof(VehicleParameters, crc);
+    TEST_ASSERT_EQUAL_MEMORY((const uint8_t*)&expected + start, (const uint8_t*)&actual + start, end - start);
+}
+
+// A blob as save() would write it, with the header and CRC recomputed
+static void writeBlob(Storage& storage, VehicleParameters parameters) {
+    parameters.crc = computeParameterCrc(parameters);
+    storage.write(&parameters, sizeof(parameters));
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_nothing_stored_means_defaults(void) {
+    Storage storage;
+    ParameterBlock block(storage, profileDefaults());
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_DEFAULTED, block.load());
+    assertSameValues(profileDefaults(), block.get());
+    TEST_ASSERT_TRUE(isValidVehicleParameters(block.get()));
+    TEST_ASSERT_EQUAL_UINT32(0, storage.getWriteCount());   // Defaults are not written back unasked
+}
+
+void test_save_then_load_round_trips(void) {
+    Storage storage;
+    {
+        ParameterBlock block(storage, profileDefaults());
+        block.load();
+        TEST_ASSERT_TRUE(block.save(tuned()));
+        assertSameValues(tuned(), block.get());
+    }
+
+    ParameterBlock boot(storage, profileDefaults());
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_LOADED, boot.load());
+    assertSameValues(tuned(), boot.get());
+    TEST_ASSERT_EQUAL_UINT32(PARAMETER_MAGIC, boot.get().magic);
+    TEST_ASSERT_EQUAL_UINT16(PARAMETER_VERSION, boot.get().version);
+    TEST_ASSERT_EQUAL_UINT32(computeParameterCrc(boot.get()), boot.get().crc);
+}
+
+void test_bad_crc_is_invalid(void) {
+    Storage storage;
+    ParameterBlock block(storage, profileDefaults());
+    block.save(tuned());
+
+    storage.corruptByte(offsetof(VehicleParameters, tireDiameterInches));
+    ParameterBlock boot(storage, profileDefaults());
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_INVALID, boot.load());
+    assertSameValues(profileDefaults(), boot.get());
+}
+
+void test_other_version_or_magic_is_invalid(void) {
+    Storage storage;
+    VehicleParameters stale = tuned();
+    stale.version = PARAMETER_VERSION - 1;
+    writeBlob(storage, stale);
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_INVALID, ParameterBlock(storage, profileDefaults()).load());
+
+    VehicleParameters foreign = tuned();
+    foreign.magic = 0x12345678;
+    writeBlob(storage, foreign);
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_INVALID, ParameterBlock(storage, profileDefaults()).load());
+
+    // A blob from a layout of another size can't even be read
+    uint8_t shorter[sizeof(VehicleParameters) - 8];
+    memcpy(shorter, &foreign, sizeof(shorter));
+    storage.write(shorter, sizeof(shorter));
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_DEFAULTED, ParameterBlock(storage, profileDefaults()).load());
+}
+
+void test_out_of_range_values_are_refused(void) {
+    Storage storage;
+    ParameterBlock block(storage, profileDefaults());
+    block.save(tuned());
+
+    // Stored with a good CRC, but meaningless
+    VehicleParameters zeroTire = tuned();
+    zeroTire.tireDiameterInches = 0.0f;
+    writeBlob(storage, zeroTire);
+    ParameterBlock boot(storage, profileDefaults());
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_INVALID, boot.load());
+    assertSameValues(profileDefaults(), boot.get());
+
+    // Offered to save(): refused, nothing written, the current values kept
+    block.save(tuned());
+    uint32_t writes = storage.getWriteCount();
+    VehicleParameters tooManyTeeth = tuned();
+    tooManyTeeth.driveshaftPulsesPerRev = ToothCorrection::MAX_TEETH + 1;
+    TEST_ASSERT_FALSE(block.save(tooManyTeeth));
+    TEST_ASSERT_EQUAL_UINT32(writes, storage.getWriteCount());
+    assertSameValues(tuned(), block.get());
+}
+
+void test_restore_defaults_is_persisted(void) {
+    Storage storage;
+    ParameterBlock block(storage, profileDefaults());
+    block.save(tuned());
+    TEST_ASSERT_TRUE(block.restoreDefaults());
+    assertSameValues(profileDefaults(), block.get());
+
+    ParameterBlock boot(storage, profileDefaults());
+    TEST_ASSERT_EQUAL_INT(PARAMETERS_LOADED, boot.load());
+    assertSameValues(profileDefaults(), boot.get());
+}
+
+void test_load_cost(void) {
+    Storage storage;
+    ParameterBlock block(storage, profileDefaults());
+    block.save(tuned());
+
+    const int LOADS = 100000;
+    int loaded = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOADS; i++) {
+        loaded += block.load() == PARAMETERS_LOADED ? 1 : 0;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LOADS;
+    TEST_ASSERT_EQUAL_INT(LOADS, loaded);
+
+    char message[128];
+    snprintf(message, sizeof(message), "load(): %.0f ns for a %u byte block (host): a copy and a CRC",
+             ns, (unsigned)sizeof(VehicleParameters));
+    TEST_MESSAGE(message);
+
+    // A CRC over a block this small: even at the ESP32's 240 MHz, well under a millisecond
+    TEST_ASSERT_LESS_THAN(20000.0, ns);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_nothing_stored_means_defaults);
+    RUN_TEST(test_save_then_load_round_trips);
+    RUN_TEST(test_bad_crc_is_invalid);
+    RUN_TEST(test_other_version_or_magic_is_invalid);
+    RUN_TEST(test_out_of_range_values_are_refused);
+    RUN_TEST(test_restore_defaults_is_persisted);
+    RUN_TEST(test_load_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,148 @@
+// The backend interface on the host: a PulseMonitor on the simulated backend,
+// fed timestamped edges as the GPIO ISR and MCPWM capture backends queue them,
+// and hardware-style counts as PCNT reports them
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "PulseMonitor.h"
+
+template <int PulsesPerRev>
+struct SimulatedConfig {
+    static const PulseBackendType BACKEND = PULSE_BACKEND_SIMULATED;
+    static const int PIN_B = -1;
+    static const int PULSES_PER_REV = PulsesPerRev;
+    static const size_t QUEUE_SIZE = 32;
+    static const uint32_t MIN_EDGE_SPACING_US = 50;
+    static const char* name() { return "SimulatedMonitor"; }
+};
+
+typedef PulseMonitor<18, SimulatedConfig<1> > EdgeMonitor;
+typedef PulseMonitor<19, SimulatedConfig<4> > CountMonitor;
+typedef EdgeMonitor::Backend EdgeBackend;
+typedef CountMonitor::Backend CountBackend;
+
+static const uint32_t LOOP_PERIOD_US = 10000;
+
+// Shaft speed at a time: 1170 RPM for 3 s, then 2950 RPM: neither a whole
+// number of pulses per loop pass
+static float rpmAt(double micros) {
+    return micros < 3000000.0 ? 1170.0f : 2950.0f;
+}
+
+// Checked at the end of each steady stretch
+static bool settledAt(uint32_t micros) {
+    return micros == 3000000 || micros == 6000000;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_queued_edges_drive_the_rpm(void) {
+    EdgeMonitor monitor;
+    EdgeBackend::setTime(0);
+    monitor.reset();
+
+    double nextPulse = 1000.0;
+    float worst = 0.0f;
+    for (uint32_t now = LOOP_PERIOD_US; now <= 6000000; now += LOOP_PERIOD_US) {
+        while (nextPulse <= (double)now) {
+            TEST_ASSERT_TRUE(EdgeBackend::injectPulse((uint32_t)nextPulse));
+            nextPulse += 60000000.0 / rpmAt(nextPulse);
+        }
+        EdgeBackend::setTime(now);
+        monitor.update();
+        if (settledAt(now)) {
+            worst = fmaxf(worst, fabsf(monitor.getRPM() / rpmAt(now - 1) - 1.0f));
+        }
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "edges: worst error %.2f%% when settled, %.1f RPM at the end", 100.0f * worst,
+             monitor.getFilteredRPM());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(0.001f, worst);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 2950.0f, monitor.getFilteredRPM());
+}
+
+void test_hardware_counts_drive_the_rpm(void) {
+    // A four-tooth wheel read as a count each loop pass, the way PCNT is
+    CountMonitor monitor;
+    CountBackend::setTime(0);
+    monitor.reset();
+
+    double nextPulse = 1000.0;
+    float worst = 0.0f;
+    for (uint32_t now = LOOP_PERIOD_US; now <= 6000000; now += LOOP_PERIOD_US) {
+        int32_t counted = 0;
+        while (nextPulse <= (double)now) {
+            counted++;
+            nextPulse += 60000000.0 / (rpmAt(nextPulse) * 4.0f);
+        }
+        CountBackend::injectCount(counted);
+        CountBackend::setTime(now);
+        monitor.update();
+        if (settledAt(now)) {
+            worst = fmaxf(worst, fabsf(monitor.getRPM() / rpmAt(now - 1) - 1.0f));
+        }
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "counts: worst error %.2f%% when settled, %.1f RPM at the end", 100.0f * worst,
+             monitor.getRPM());
+    TEST_MESSAGE(message);
+
+    // Each window's period is a whole number of pulses over the time since the
+    // last non-empty one, and only four windows are averaged
+    TEST_ASSERT_LESS_THAN(0.05f, worst);
+    TEST_ASSERT_FLOAT_WITHIN(2950.0f * 0.05f, 2950.0f, monitor.getRPM());
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.getOverflowCount());
+}
+
+void test_disabled_backend_drops_pulses(void) {
+    EdgeMonitor monitor;
+    EdgeBackend::setTime(0);
+    monitor.reset();
+    monitor.setEnabled(false);
+    TEST_ASSERT_FALSE(monitor.isEnabled());
+    TEST_ASSERT_FALSE(EdgeBackend::injectPulse(1000));
+    EdgeBackend::setTime(LOOP_PERIOD_US);
+    monitor.update();
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.getPulseCount());
+
+    // Edges queued but not yet drained are dropped by reset()
+    monitor.setEnabled(true);
+    TEST_ASSERT_TRUE(EdgeBackend::injectPulse(12000));
+    TEST_ASSERT_TRUE(EdgeBackend::injectPulse(14000));
+    monitor.reset();
+    EdgeBackend::setTime(2 * LOOP_PERIOD_US);
+    monitor.update();
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.getPulseCount());
+}
+
+void test_a_full_queue_counts_overflows(void) {
+    EdgeMonitor monitor;
+    EdgeBackend::setTime(0);
+    monitor.reset();
+    uint32_t before = monitor.getOverflowCount();
+
+    // A stalled loop: more edges than the queue holds before the next drain
+    int accepted = 0;
+    for (int i = 0; i < 50; i++) {
+        accepted += EdgeBackend::injectPulse(1000 + i * 1000) ? 1 : 0;
+    }
+    EdgeBackend::setTime(60000);
+    monitor.update();
+
+    TEST_ASSERT_EQUAL_INT((int)SimulatedConfig<1>::QUEUE_SIZE, accepted);
+    TEST_ASSERT_EQUAL_UINT32(50 - accepted, monitor.getOverflowCount() - before);
+    TEST_ASSERT_EQUAL_UINT32(accepted, monitor.getPulseCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_queued_edges_drive_the_rpm);
+    RUN_TEST(test_hardware_counts_drive_the_rpm);
+    RUN_TEST(test_disabled_backend_drops_pulses);
+    RUN_TEST(test_a_full_queue_counts_overflows);
+    return UNITY_END();
+}
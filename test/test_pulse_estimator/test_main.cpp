@@ -0,0 +1,120 @@
+// Period vs counting RPM estimation on synthetic pulse trains
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "PulseEstimator.h"
+
+static const uint32_t LOOP_PERIOD_US = 10000;   // main loop at 100 Hz
+
+// One pulse per revolution at a piecewise-constant speed, fed to the estimator
+// the way the loop drains its queue: every pulse up to "now", then update(now)
+struct PulseTrain {
+    PulseEstimator estimator;
+    uint32_t now;
+    double nextPulse;
+
+    explicit PulseTrain(RPMEstimationMode mode) : now(0), nextPulse(1000.0) {
+        estimator.setEstimationMode(mode);
+        estimator.reset(0);
+    }
+
+    void run(float rpm, uint32_t durationMicros) {
+        uint32_t end = now + durationMicros;
+        while (now < end) {
+            now += LOOP_PERIOD_US;
+            while (nextPulse <= (double)now) {
+                PulseEvent event = { (uint32_t)nextPulse, 1 };
+                estimator.recordPulse(event);
+                nextPulse += 60000000.0 / rpm;
+            }
+            estimator.update(now);
+        }
+    }
+
+    // Loop time until the estimate settles within tolerance of the new speed
+    uint32_t latencyTo(float rpm, float tolerance, uint32_t limitMicros) {
+        uint32_t start = now;
+        while (now - start < limitMicros) {
+            run(rpm, LOOP_PERIOD_US);
+            if (fabsf(estimator.getRPM() - rpm) <= tolerance * rpm) {
+                return now - start;
+            }
+        }
+        return limitMicros;
+    }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_period_mode_follows_a_step_within_a_few_pulses(void) {
+    PulseTrain period(RPM_MODE_PULSE_PERIOD);
+    PulseTrain counting(RPM_MODE_PULSE_COUNT);
+    period.run(1500.0f, 3000000);
+    counting.run(1500.0f, 3000000);
+
+    uint32_t periodLatency = period.latencyTo(2400.0f, 0.02f, 5000000);
+    uint32_t countingLatency = counting.latencyTo(2400.0f, 0.02f, 5000000);
+
+    char message[96];
+    snprintf(message, sizeof(message), "1500->2400 RPM step: period %lu ms, counting %lu ms",
+             (unsigned long)(periodLatency / 1000), (unsigned long)(countingLatency / 1000));
+    TEST_MESSAGE(message);
+
+    // The outlier filter holds back the first faster periods until they are the
+    // window median, then four are averaged: about eight 25 ms pulses
+    TEST_ASSERT_LESS_OR_EQUAL(250000, periodLatency);
+    TEST_ASSERT_GREATER_OR_EQUAL(1000000, countingLatency);
+}
+
+void test_period_mode_resolves_speeds_between_count_steps(void) {
+    // At one pulse per rev a one second count window quantizes to 60 RPM
+    float worstPeriodError = 0.0f;
+    float worstCountError = 0.0f;
+    for (float rpm = 1000.0f; rpm < 1120.0f; rpm += 7.0f) {
+        PulseTrain period(RPM_MODE_PULSE_PERIOD);
+        PulseTrain counting(RPM_MODE_PULSE_COUNT);
+        period.run(rpm, 3000000);
+        counting.run(rpm, 3000000);
+        worstPeriodError = fmaxf(worstPeriodError, fabsf(period.estimator.getRPM() - rpm));
+        worstCountError = fmaxf(worstCountError, fabsf(counting.estimator.getRPM() - rpm));
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "worst error 1000-1120 RPM: period %.2f RPM, counting %.1f RPM",
+             worstPeriodError, worstCountError);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_LESS_THAN(1.0f, worstPeriodError);
+    TEST_ASSERT_GREATER_THAN(20.0f, worstCountError);
+}
+
+void test_period_mode_falls_back_to_counting_at_crawl(void) {
+    PulseTrain period(RPM_MODE_PULSE_PERIOD);
+    period.run(20.0f, 8000000);
+    TEST_ASSERT_EQUAL_FLOAT(period.estimator.getCountedRPM(), period.estimator.getRPM());
+    TEST_ASSERT_TRUE(period.estimator.isReceivingSignal());
+}
+
+void test_overdue_pulse_bounds_the_estimate(void) {
+    PulseTrain period(RPM_MODE_PULSE_PERIOD);
+    period.run(3000.0f, 2000000);
+
+    // Shaft stops: the estimate must fall with elapsed time, not hold 3000 RPM
+    period.nextPulse = 1e12;
+    period.run(3000.0f, 200000);
+    TEST_ASSERT_LESS_OR_EQUAL(300.0f, period.estimator.getRPM());
+
+    period.run(3000.0f, 3000000);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, period.estimator.getRPM());
+    TEST_ASSERT_FALSE(period.estimator.isReceivingSignal());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_period_mode_follows_a_step_within_a_few_pulses);
+    RUN_TEST(test_period_mode_resolves_speeds_between_count_steps);
+    RUN_TEST(test_period_mode_falls_back_to_counting_at_crawl);
+    RUN_TEST(test_overdue_pulse_bounds_the_estimate);
+    return UNITY_END();
+}
@@ -0,0 +1,187 @@
+// False-reject rate, glitch rejection, per-pulse cost and speed-step recovery
+// of the adaptive pulse filter on synthetic noisy traces
+#include <unity.h>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include "PulseFilter.h"
+#include "PulseEstimator.h"
+
+struct TraceResult {
+    uint32_t realEdges;
+    uint32_t falseRejects;    // Real edges rejected
+    uint32_t falseOutliers;   // Real edges accepted without a period
+    uint32_t glitches;
+    uint32_t glitchesPassed;  // Glitches not rejected
+};
+
+// Shaft slowly swinging between 1000 and 4000 RPM at one pulse per rev, with
+// Gaussian period jitter and a glitch (contact bounce, ignition noise) in the
+// first half of the period on a fraction of the edges
+static TraceResult runTrace(PulseFilter& filter, float jitter, float glitchRate, unsigned seed) {
+    std::mt19937 random(seed);
+    std::normal_distribution<float> noise(0.0f, jitter);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    TraceResult result = { 0, 0, 0, 0, 0 };
+
+    double now = 0.0;
+    filter.accept(0);
+    for (int i = 0; i < 50000; i++) {
+        float rpm = 2500.0f + 1500.0f * sinf((float)i * 0.0005f);
+        float period = 60000000.0f / rpm * (1.0f + noise(random));
+
+        if (unit(random) < glitchRate) {
+            result.glitches++;
+            uint32_t glitch = (uint32_t)(now + period * (0.05f + 0.4f * unit(random)));
+            if (filter.accept(glitch) != PULSE_REJECTED) {
+                result.glitchesPassed++;
+            }
+        }
+
+        now += period;
+        result.realEdges++;
+        PulseFilterResult verdict = filter.accept((uint32_t)now);
+        if (verdict == PULSE_REJECTED) {
+            result.falseRejects++;
+        } else if (verdict == PULSE_ACCEPTED_NO_PERIOD) {
+            result.falseOutliers++;
+        }
+    }
+    return result;
+}
+
+static void report(const char* name, const TraceResult& r) {
+    char message[160];
+    snprintf(message, sizeof(message), "%s: false reject %.3f%%, outlier %.3f%%, glitches passed %lu/%lu",
+             name, 100.0f * r.falseRejects / r.realEdges, 100.0f * r.falseOutliers / r.realEdges,
+             (unsigned long)r.glitchesPassed, (unsigned long)r.glitches);
+    TEST_MESSAGE(message);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_clean_jitter_is_never_rejected(void) {
+    PulseFilter filter;
+    TraceResult r = runTrace(filter, 0.01f, 0.0f, 1);
+    report("1% jitter", r);
+    TEST_ASSERT_EQUAL_UINT32(0, r.falseRejects);
+    TEST_ASSERT_LESS_THAN(r.realEdges / 1000, r.falseOutliers);
+}
+
+void test_glitches_are_rejected_without_losing_real_edges(void) {
+    PulseFilter filter;
+    TraceResult r = runTrace(filter, 0.02f, 0.05f, 2);
+    report("2% jitter, 5% glitches", r);
+    TEST_ASSERT_LESS_THAN(r.glitches / 1000 + 2, r.glitchesPassed);
+    TEST_ASSERT_LESS_THAN(r.realEdges / 1000, r.falseRejects);
+    TEST_ASSERT_LESS_THAN(r.realEdges / 100, r.falseOutliers);
+}
+
+void test_heavy_jitter_false_reject_rate(void) {
+    PulseFilter filter;
+    TraceResult r = runTrace(filter, 0.05f, 0.05f, 3);
+    report("5% jitter, 5% glitches", r);
+    TEST_ASSERT_LESS_THAN(r.realEdges / 200, r.falseRejects);
+    TEST_ASSERT_LESS_THAN(r.glitches / 100 + 1, r.glitchesPassed);
+}
+
+void test_fixed_lockout_drops_fast_shaft(void) {
+    // The old 10 ms lockout cannot see anything above 6000 pulses/min: at
+    // 7500 it drops every other edge and reads half speed
+    PulseFilter fixed;
+    PulseFilter adaptive;
+    fixed.setMode(PULSE_FILTER_FIXED_LOCKOUT);
+    uint32_t fixedRejects = 0;
+    uint32_t adaptiveRejects = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        fixedRejects += fixed.accept(i * 8000) == PULSE_REJECTED;
+        adaptiveRejects += adaptive.accept(i * 8000) == PULSE_REJECTED;
+    }
+    TEST_ASSERT_EQUAL_UINT32(16000, fixed.getLastPeriod());
+    TEST_ASSERT_GREATER_OR_EQUAL(49, fixedRejects);
+    TEST_ASSERT_EQUAL_UINT32(8000, adaptive.getLastPeriod());
+    TEST_ASSERT_EQUAL_UINT32(0, adaptiveRejects);
+}
+
+void test_per_pulse_cost(void) {
+    PulseFilter filter;
+    std::mt19937 random(4);
+    std::normal_distribution<float> noise(0.0f, 0.02f);
+    static uint32_t stamps[200000];
+    double now = 0.0;
+    for (int i = 0; i < 200000; i++) {
+        now += 20000.0f * (1.0f + noise(random));
+        stamps[i] = (uint32_t)now;
+    }
+
+    uint32_t accepted = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 200000; i++) {
+        accepted += filter.accept(stamps[i]) == PULSE_ACCEPTED;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 200000.0;
+
+    char message[64];
+    snprintf(message, sizeof(message), "adaptive filter: %.1f ns per pulse (host)", ns);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(190000, accepted);
+    TEST_ASSERT_LESS_THAN(2000.0, ns);
+}
+
+void test_run_of_fast_edges_reseeds_the_window(void) {
+    // Speed triples between two edges: every new edge lands inside the lockout
+    PulseFilter filter;
+    uint32_t now = 0;
+    for (int i = 0; i < 20; i++) {
+        now += 30000;
+        filter.accept(now);
+    }
+    int firstPeriod = -1;
+    for (int i = 0; i < 20; i++) {
+        now += 10000;
+        if (filter.accept(now) == PULSE_ACCEPTED && firstPeriod < 0) {
+            firstPeriod = i;
+        }
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(0, firstPeriod);
+    TEST_ASSERT_LESS_OR_EQUAL(6, firstPeriod);
+    TEST_ASSERT_EQUAL_UINT32(10000, filter.getLastPeriod());
+    TEST_ASSERT_EQUAL_UINT32(10000, filter.getExpectedPeriod());
+}
+
+void test_estimator_forgets_old_speed_after_timeout(void) {
+    // A single stray edge before a long stop must not leave a 4 s period in the
+    // window that locks out the real pulses when the shaft starts again
+    PulseEstimator estimator;
+    estimator.reset(0);
+    PulseEvent stray = { 1000, 1 };
+    estimator.recordPulse(stray);
+    uint32_t now = 0;
+    for (; now < 4000000; now += 10000) {
+        estimator.update(now);
+    }
+    uint32_t pulse = now;
+    for (; now < 4500000; now += 10000) {
+        while (pulse <= now) {
+            PulseEvent event = { pulse, 1 };
+            estimator.recordPulse(event);
+            pulse += 20000;
+        }
+        estimator.update(now);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(30.0f, 3000.0f, estimator.getRPM());
+    TEST_ASSERT_EQUAL_UINT32(0, estimator.getFilter().getRejectedCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_jitter_is_never_rejected);
+    RUN_TEST(test_glitches_are_rejected_without_losing_real_edges);
+    RUN_TEST(test_heavy_jitter_false_reject_rate);
+    RUN_TEST(test_fixed_lockout_drops_fast_shaft);
+    RUN_TEST(test_per_pulse_cost);
+    RUN_TEST(test_run_of_fast_edges_reseeds_the_window);
+    RUN_TEST(test_estimator_forgets_old_speed_after_timeout);
+    return UNITY_END();
+}
@@ -0,0 +1,157 @@
+// Several PulseMonitor instantiations at once, each on its own thread with its
+// own synthetic pulse stream through the simulated backend: every monitor must
+// report only its own RPM and pulse count
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include "PulseMonitor.h"
+
+template <int PulsesPerRev>
+struct SimulatedConfig {
+    static const PulseBackendType BACKEND = PULSE_BACKEND_SIMULATED;
+    static const int PIN_B = -1;
+    static const int PULSES_PER_REV = PulsesPerRev;
+    static const size_t QUEUE_SIZE = 64;
+    static const uint32_t MIN_EDGE_SPACING_US = 50;
+    static const char* name() { return "SimulatedMonitor"; }
+};
+
+// Two on the same config told apart only by pin, one with two pulses per rev
+typedef PulseMonitor<18, SimulatedConfig<1> > DriveshaftMonitor;
+typedef PulseMonitor<19, SimulatedConfig<1> > WheelMonitor;
+typedef PulseMonitor<4, SimulatedConfig<2> > TachMonitor;
+
+// Collects what begin() and printStatus() write
+struct StringLog {
+    std::string text;
+    template <typename T> void print(T value) { text += std::to_string(value); }
+    void print(const char* value) { text += value; }
+    void print(float value, int) { text += std::to_string(value); }
+    template <typename T> void println(T value) { print(value); text += "\n"; }
+    void println(float value, int digits) { print(value, digits); text += "\n"; }
+    void println() { text += "\n"; }
+};
+
+struct StreamResult {
+    float rpm;
+    float filteredRPM;
+    unsigned long pulses;       // Counted by the monitor
+    unsigned long injected;     // Put into its backend
+};
+
+static const uint32_t LOOP_PERIOD_US = 10000;
+
+// The loop and ISR for one monitor: pulses due by now into the backend, then
+// update(), for a few seconds at a steady speed with a little period jitter
+template <typename Monitor>
+static void runStream(Monitor& monitor, float rpm, unsigned seed, StreamResult& result) {
+    typedef typename Monitor::Backend Backend;
+    Backend::setTime(0);
+    monitor.reset();
+
+    double period = 60000000.0 / rpm / monitor.getPulsesPerRevolution();
+    double nextPulse = 1000.0;
+    unsigned long injected = 0;
+    for (uint32_t now = LOOP_PERIOD_US; now <= 4000000; now += LOOP_PERIOD_US) {
+        while (nextPulse <= (double)now) {
+            Backend::injectPulse((uint32_t)nextPulse);
+            injected++;
+            seed = seed * 1103515245u + 12345u;
+            nextPulse += period * (1.0 + 0.002 * ((double)(seed >> 16 & 0x7fff) / 16384.0 - 1.0));
+        }
+        Backend::setTime(now);
+        monitor.update();
+    }
+
+    result.rpm = monitor.getRPM();
+    result.filteredRPM = monitor.getFilteredRPM();
+    result.pulses = monitor.getPulseCount();
+    result.injected = injected;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_instances_on_separate_threads_report_their_own_rpm(void) {
+    DriveshaftMonitor driveshaft;
+    WheelMonitor wheel;
+    TachMonitor tach;
+    StringLog log;
+    driveshaft.begin(log);
+    wheel.begin(log);
+    tach.begin(log);
+
+    const float RPM[3] = {1234.0f, 2750.0f, 3600.0f};
+    StreamResult results[3];
+    for (int round = 0; round < 5; round++) {
+        std::thread first(runStream<DriveshaftMonitor>, std::ref(driveshaft), RPM[0], 1u + round, std::ref(results[0]));
+        std::thread second(runStream<WheelMonitor>, std::ref(wheel), RPM[1], 2u + round, std::ref(results[1]));
+        std::thread third(runStream<TachMonitor>, std::ref(tach), RPM[2], 3u + round, std::ref(results[2]));
+        first.join();
+        second.join();
+        third.join();
+
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_EQUAL_UINT32(results[i].injected, results[i].pulses);
+            TEST_ASSERT_FLOAT_WITHIN(RPM[i] * 0.005f, RPM[i], results[i].rpm);
+            TEST_ASSERT_FLOAT_WITHIN(RPM[i] * 0.005f, RPM[i], results[i].filteredRPM);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, driveshaft.getOverflowCount());
+    TEST_ASSERT_EQUAL_UINT32(0, wheel.getOverflowCount());
+    TEST_ASSERT_EQUAL_UINT32(0, tach.getOverflowCount());
+
+    char message[160];
+    snprintf(message, sizeof(message), "%.1f / %.1f / %.1f RPM from %lu / %lu / %lu pulses", results[0].rpm,
+             results[1].rpm, results[2].rpm, results[0].pulses, results[1].pulses, results[2].pulses);
+    TEST_MESSAGE(message);
+}
+
+void test_a_silent_instance_stays_at_zero(void) {
+    // Only the driveshaft stream runs; the wheel must neither see its pulses nor its clock
+    DriveshaftMonitor driveshaft;
+    WheelMonitor wheel;
+    WheelMonitor::Backend::setTime(0);
+    wheel.reset();
+
+    StreamResult result;
+    std::thread stream(runStream<DriveshaftMonitor>, std::ref(driveshaft), 1800.0f, 7u, std::ref(result));
+    for (int i = 0; i < 100; i++) {
+        WheelMonitor::Backend::setTime(i * LOOP_PERIOD_US);
+        wheel.update();
+    }
+    stream.join();
+
+    TEST_ASSERT_FLOAT_WITHIN(1800.0f * 0.005f, 1800.0f, result.rpm);
+    TEST_ASSERT_EQUAL_UINT32(0, wheel.getPulseCount());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, wheel.getRPM());
+    TEST_ASSERT_FALSE(wheel.isReceivingSignal());
+}
+
+void test_status_goes_to_the_given_stream(void) {
+    TachMonitor tach;
+    StringLog log;
+    tach.begin(log);
+    TEST_ASSERT_TRUE(log.text.find("SimulatedMonitor: Initialized on GPIO 4 (2 pulses/rev, simulated)") !=
+                     std::string::npos);
+
+    StringLog status;
+    tach.printStatus(status);
+    TEST_ASSERT_TRUE(status.text.find("=== SimulatedMonitor Status ===") != std::string::npos);
+    TEST_ASSERT_TRUE(status.text.find("Backend: simulated") != std::string::npos);
+
+    TEST_ASSERT_FALSE(tach.setPulsesPerRevolution(0));
+    TEST_ASSERT_EQUAL_INT(2, tach.getPulsesPerRevolution());
+    TEST_ASSERT_TRUE(tach.setPulsesPerRevolution(3));
+    TEST_ASSERT_EQUAL_INT(3, tach.getPulsesPerRevolution());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_instances_on_separate_threads_report_their_own_rpm);
+    RUN_TEST(test_a_silent_instance_stays_at_zero);
+    RUN_TEST(test_status_goes_to_the_given_stream);
+    return UNITY_END();
+}
@@ -0,0 +1,146 @@
+// Ordering, overflow accounting and a two-thread stress test of the ISR queue
+#include <unity.h>
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include "PulseRingBuffer.h"
+
+static const uint32_t STRESS_PUSHES = 4000000;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_pops_in_push_order(void) {
+    PulseRingBuffer<uint32_t, 8> queue;
+    uint32_t value = 0;
+    for (uint32_t round = 0; round < 5; round++) {
+        for (uint32_t i = 0; i < 6; i++) {
+            TEST_ASSERT_TRUE(queue.push(round * 10 + i));
+        }
+        for (uint32_t i = 0; i < 6; i++) {
+            TEST_ASSERT_TRUE(queue.pop(value));
+            TEST_ASSERT_EQUAL_UINT32(round * 10 + i, value);
+        }
+        TEST_ASSERT_FALSE(queue.pop(value));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, queue.getOverflowCount());
+}
+
+void test_full_queue_counts_and_drops_newest(void) {
+    PulseRingBuffer<uint32_t, 4> queue;
+    for (uint32_t i = 0; i < 7; i++) {
+        queue.push(i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, queue.getOverflowCount());
+    TEST_ASSERT_EQUAL(4, queue.size());
+
+    uint32_t out[8];
+    size_t count = queue.popBatch(out, 8);
+    TEST_ASSERT_EQUAL(4, count);
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, out[i]);
+    }
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+void test_pop_batch_respects_limit_and_clear_empties(void) {
+    PulseRingBuffer<uint32_t, 16> queue;
+    for (uint32_t i = 0; i < 10; i++) {
+        queue.push(i);
+    }
+    uint32_t out[3];
+    TEST_ASSERT_EQUAL(3, queue.popBatch(out, 3));
+    TEST_ASSERT_EQUAL_UINT32(2, out[2]);
+    TEST_ASSERT_EQUAL(7, queue.size());
+    queue.clear();
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_FALSE(queue.pop(out[0]));
+}
+
+// Producer thread stands in for the ISR: it never waits, so a slow consumer
+// shows up as overflow. Every value must arrive at most once, in order, and
+// delivered + dropped must account for every push.
+void test_concurrent_lossy_producer_loses_nothing_silently(void) {
+    static PulseRingBuffer<uint32_t, 128> queue;
+    std::atomic<bool> done(false);
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < STRESS_PUSHES; i++) {
+            queue.push(i);
+            if ((i & 255) == 0) {
+                std::this_thread::yield();  // Lets the consumer run on a single-core host
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint32_t delivered = 0;
+    uint32_t outOfOrder = 0;
+    int64_t last = -1;
+    uint32_t batch[32];
+    for (;;) {
+        bool finished = done.load(std::memory_order_acquire);
+        size_t count = queue.popBatch(batch, 32);
+        for (size_t i = 0; i < count; i++) {
+            if ((int64_t)batch[i] <= last) {
+                outOfOrder++;
+            }
+            last = batch[i];
+        }
+        delivered += count;
+        if (finished && count == 0) {
+            break;
+        }
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    char message[80];
+    snprintf(message, sizeof(message), "%lu delivered, %lu dropped on overflow",
+             (unsigned long)delivered, (unsigned long)queue.getOverflowCount());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_PUSHES, delivered + queue.getOverflowCount());
+}
+
+// With a producer that retries on full, the consumer must see exactly 0..N-1
+void test_concurrent_lossless_producer_delivers_every_value(void) {
+    static PulseRingBuffer<uint32_t, 64> queue;
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < STRESS_PUSHES; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t mismatches = 0;
+    uint32_t value;
+    while (expected < STRESS_PUSHES) {
+        if (queue.pop(value)) {
+            if (value != expected) {
+                mismatches++;
+            }
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_pops_in_push_order);
+    RUN_TEST(test_full_queue_counts_and_drops_newest);
+    RUN_TEST(test_pop_batch_respects_limit_and_clear_empties);
+    RUN_TEST(test_concurrent_lossy_producer_loses_nothing_silently);
+    RUN_TEST(test_concurrent_lossless_producer_delivers_every_value);
+    return UNITY_END();
+}
@@ -0,0 +1,95 @@
+// Pulse emission, reversal latency, bounce and illegal transitions of the quadrature decoder
+#include <unity.h>
+#include "QuadratureDecoder.h"
+
+// Forward rotation walks this Gray code sequence, reverse walks it backwards
+static const uint8_t SEQUENCE[4] = { 0, 1, 3, 2 };
+
+struct Shaft {
+    QuadratureDecoder decoder;
+    int phase;
+    int pulses;
+
+    Shaft() : phase(0), pulses(0) { decoder.reset(false, false); }
+
+    // Move one quarter cycle; returns the decoder output
+    int8_t step(int direction) {
+        phase = (phase + direction + 4) % 4;
+        int8_t pulse = decoder.update((SEQUENCE[phase] & 2) != 0, (SEQUENCE[phase] & 1) != 0);
+        pulses += pulse;
+        return pulse;
+    }
+
+    // Quarter cycles until a pulse in this direction comes out
+    int quartersToPulse(int direction) {
+        for (int quarters = 1; quarters <= 16; quarters++) {
+            if (step(direction) == direction) {
+                return quarters;
+            }
+        }
+        return -1;
+    }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_one_pulse_per_cycle_each_way(void) {
+    Shaft shaft;
+    for (int i = 0; i < 40; i++) {
+        shaft.step(1);
+    }
+    TEST_ASSERT_EQUAL_INT(10, shaft.pulses);
+    TEST_ASSERT_EQUAL_INT(1, shaft.decoder.getDirection());
+    for (int i = 0; i < 80; i++) {
+        shaft.step(-1);
+    }
+    TEST_ASSERT_EQUAL_INT(-10, shaft.pulses);
+    TEST_ASSERT_EQUAL_INT(-1, shaft.decoder.getDirection());
+    TEST_ASSERT_EQUAL_INT32(-10, shaft.decoder.getPosition());
+}
+
+void test_reversal_reported_within_four_quarters(void) {
+    // Whatever progress was made forward, the first reverse pulse needs exactly four quarters
+    for (int progress = 0; progress < 4; progress++) {
+        Shaft shaft;
+        for (int i = 0; i < 8 + progress; i++) {
+            shaft.step(1);
+        }
+        TEST_ASSERT_EQUAL_INT(4, shaft.quartersToPulse(-1));
+        TEST_ASSERT_EQUAL_INT(4, shaft.quartersToPulse(1));
+    }
+}
+
+void test_single_channel_bounce_never_emits(void) {
+    for (int progress = 0; progress < 4; progress++) {
+        Shaft shaft;
+        for (int i = 0; i < 4 + progress; i++) {
+            shaft.step(1);
+        }
+        int before = shaft.pulses;
+        for (int i = 0; i < 50; i++) {
+            TEST_ASSERT_EQUAL_INT(0, shaft.step(-1));
+            TEST_ASSERT_EQUAL_INT(0, shaft.step(1));
+        }
+        TEST_ASSERT_EQUAL_INT(before, shaft.pulses);
+        TEST_ASSERT_EQUAL_UINT32(0, shaft.decoder.getIllegalCount());
+    }
+}
+
+void test_illegal_transition_is_counted_and_ignored(void) {
+    QuadratureDecoder decoder;
+    decoder.reset(false, false);
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(true, true));  // 00 -> 11 skips a state
+    TEST_ASSERT_EQUAL_UINT32(1, decoder.getIllegalCount());
+    TEST_ASSERT_EQUAL_INT32(0, decoder.getPosition());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_one_pulse_per_cycle_each_way);
+    RUN_TEST(test_reversal_reported_within_four_quarters);
+    RUN_TEST(test_single_channel_bounce_never_emits);
+    RUN_TEST(test_illegal_transition_is_counted_and_ignored);
+    return UNITY_END();
+}
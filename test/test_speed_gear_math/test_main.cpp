@@ -0,0 +1,293 @@
+// Error bounds and per-sample cost of the speed, gear-window and easing math
+// the loop runs on every driveshaft reading, in float and in the Q16.16 fixed
+// point USE_FIXED_POINT_MATH selects. The classifier itself is tested in
+// whichever format this build uses (pio test -e native_fixed_point for Q16).
+#include <unity.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "FixedPoint.h"
+#include "TimedGearClassifier.h"
+#include "VehicleParameters.h"
+
+static const float MAX_SHAFT_RPM = 6000.0f;
+
+template <typename Profile>
+static VehicleFactors factorsFor() {
+    VehicleFactors factors;
+    deriveVehicleFactors(defaultVehicleParameters<Profile>(), factors);
+    return factors;
+}
+
+// Road speed computed in double straight from the profile
+template <typename Profile>
+static double referenceMph(double shaftRPM) {
+    return shaftRPM / Profile::DIFFERENTIAL_RATIO * 3.14159265358979 * Profile::TIRE_DIAMETER_INCHES * 60.0 / 63360.0;
+}
+
+// RPMHandler::calculateSpeedFromDriveshaftRPM() in each format
+static float floatMph(const VehicleFactors& factors, float shaftRPM) {
+    return shaftRPM * factors.mphPerDriveshaftRPM;
+}
+
+static float fixedMph(const VehicleFactors& factors, float shaftRPM) {
+    return Q16::toFloat(Q16::mul(Q16::fromFloat(shaftRPM), factors.mphPerDriveshaftRPMFixed));
+}
+
+template <typename Profile>
+static void checkSpeedError() {
+    VehicleFactors factors = factorsFor<Profile>();
+    double worstFloat = 0.0;
+    double worstFixed = 0.0;
+    for (float shaftRPM = 0.5f; shaftRPM <= MAX_SHAFT_RPM; shaftRPM += 0.5f) {
+        double reference = referenceMph<Profile>(shaftRPM);
+        worstFloat = fmax(worstFloat, fabs(floatMph(factors, shaftRPM) - reference));
+        worstFixed = fmax(worstFixed, fabs(fixedMph(factors, shaftRPM) - reference));
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%s: worst speed error to %.0f shaft RPM %.2e MPH float, %.2e MPH Q16.16",
+             Profile::NAME, MAX_SHAFT_RPM, worstFloat, worstFixed);
+    TEST_MESSAGE(message);
+
+    // Float is far below the 0.1 MPH the display shows and any hysteresis band.
+    // Q16.16 holds the factor to about 1 part in 1200, so its error grows with
+    // speed, but stays under half a display step at the top of the range.
+    TEST_ASSERT_LESS_THAN(1e-3, worstFloat);
+    TEST_ASSERT_LESS_THAN(0.05, worstFixed);
+}
+
+// Gear windows tested in double on the engine/shaft ratio itself
+static Gear referenceGear(const VehicleFactors& factors, double engineRPM, double shaftRPM) {
+    if (engineRPM < 100.0) {
+        return NEUTRAL;  // Engine stopped or idling
+    }
+    double ratio = engineRPM / shaftRPM;
+    for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+        if (factors.enginePerDriveshaft[gear] > 0.0f &&
+            ratio >= factors.enginePerDriveshaftMin[gear] && ratio <= factors.enginePerDriveshaftMax[gear]) {
+            return static_cast<Gear>(gear);
+        }
+    }
+    return NEUTRAL;
+}
+
+// Within rounding of a window bound: float rounding, plus half a Q16 step on
+// the bound itself when the windows are compared in fixed point
+static bool nearWindowEdge(const VehicleFactors& factors, double ratio) {
+    double tolerance = ratio * 1e-5 + (USE_FIXED_POINT_MATH ? 1.0 / Q16::ONE : 0.0);
+    for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+        if (fabs(ratio - factors.enginePerDriveshaftMin[gear]) <= tolerance ||
+            fabs(ratio - factors.enginePerDriveshaftMax[gear]) <= tolerance) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Profile>
+static void checkGearAgreement() {
+    VehicleFactors factors = factorsFor<Profile>();
+    TimedGearClassifier classifier(&factors);
+    uint32_t samples = 0;
+    uint32_t disagreements = 0;
+    for (float shaftRPM = 50.0f; shaftRPM <= MAX_SHAFT_RPM; shaftRPM += 37.0f) {
+        for (float ratio = 0.5f; ratio <= 5.0f; ratio += 0.0007f) {
+            float engineRPM = shaftRPM * ratio;
+            samples++;
+            if (classifier.detect(engineRPM, shaftRPM) != referenceGear(factors, engineRPM, shaftRPM) &&
+                !nearWindowEdge(factors, (double)engineRPM / shaftRPM)) {
+                disagreements++;
+            }
+        }
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%s (%s): %lu of %lu samples disagree away from a window edge",
+             Profile::NAME, USE_FIXED_POINT_MATH ? "Q16.16" : "float", (unsigned long)disagreements,
+             (unsigned long)samples);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, disagreements);
+}
+
+// GearIndicator::easeInOutCubic(), the float reference for Q16::easeInOutCubic()
+static double referenceEase(double t) {
+    if (t < 0.5) {
+        return 4.0 * t * t * t;
+    }
+    double f = 2.0 * t - 2.0;
+    return 1.0 + f * f * f / 2.0;
+}
+
+// One driveshaft reading in each format: the speed, and the first forward gear
+// whose window holds the sample, as RPMHandler and TimedGearClassifier do it
+static int floatSample(const VehicleFactors& factors, float engineRPM, float shaftRPM, float& mph) {
+    mph = shaftRPM * factors.mphPerDriveshaftRPM;
+    for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+        if (factors.enginePerDriveshaft[gear] > 0.0f &&
+            engineRPM >= shaftRPM * factors.enginePerDriveshaftMin[gear] &&
+            engineRPM <= shaftRPM * factors.enginePerDriveshaftMax[gear]) {
+            return gear;
+        }
+    }
+    return NEUTRAL;
+}
+
+static int fixedSample(const VehicleFactors& factors, float engineRPM, float shaftRPM, float& mph) {
+    Q16::fixed engine = Q16::fromFloat(engineRPM);
+    Q16::fixed shaft = Q16::fromFloat(shaftRPM);
+    mph = Q16::toFloat(Q16::mul(shaft, factors.mphPerDriveshaftRPMFixed));
+    for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+        if (factors.enginePerDriveshaft[gear] > 0.0f &&
+            engine >= Q16::mulWide(shaft, factors.enginePerDriveshaftMinFixed[gear]) &&
+            engine <= Q16::mulWide(shaft, factors.enginePerDriveshaftMaxFixed[gear])) {
+            return gear;
+        }
+    }
+    return NEUTRAL;
+}
+
+// Time-stamp counter where the host has one, for a per-call figure in cycles
+static uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct SampleCost {
+    double ns;
+    double cycles;      // 0 where the host has no cycle counter
+};
+
+// Per-call cost of one format over a sweep across every window
+template <int (*Sample)(const VehicleFactors&, float, float, float&)>
+static SampleCost measure(const VehicleFactors& factors, int samples) {
+    volatile float sink = 0.0f;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t startCycles = cycleCount();
+    for (int i = 0; i < samples; i++) {
+        float shaftRPM = 200.0f + (float)(i % 4000);
+        float engineRPM = shaftRPM * (0.8f + (float)(i % 311) * 0.01f);
+        float mph;
+        int gear = Sample(factors, engineRPM, shaftRPM, mph);
+        sink = sink + mph + (float)gear;
+    }
+    SampleCost cost;
+    cost.cycles = (double)(cycleCount() - startCycles) / samples;
+    cost.ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+    return cost;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_speed_error_bound(void) {
+    checkSpeedError<Mgb3SpeedProfile>();
+    checkSpeedError<Mgb4SpeedOverdriveProfile>();
+}
+
+void test_gear_windows_match_the_exact_ratio(void) {
+    checkGearAgreement<Mgb3SpeedProfile>();
+    checkGearAgreement<Mgb4SpeedOverdriveProfile>();
+}
+
+void test_fixed_point_gear_windows_match_float(void) {
+    // The same window tests in both formats: they may only differ within a Q16
+    // step of a bound
+    VehicleFactors factors = factorsFor<Mgb4SpeedOverdriveProfile>();
+    uint32_t samples = 0;
+    uint32_t disagreements = 0;
+    for (float shaftRPM = 50.0f; shaftRPM <= MAX_SHAFT_RPM; shaftRPM += 37.0f) {
+        for (float ratio = 0.5f; ratio <= 5.0f; ratio += 0.0007f) {
+            float engineRPM = shaftRPM * ratio;
+            float mph;
+            samples++;
+            if (floatSample(factors, engineRPM, shaftRPM, mph) != fixedSample(factors, engineRPM, shaftRPM, mph)) {
+                double exact = (double)engineRPM / shaftRPM;
+                bool nearBound = false;
+                for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+                    nearBound = nearBound || fabs(exact - factors.enginePerDriveshaftMin[gear]) <= 1.0 / Q16::ONE ||
+                                fabs(exact - factors.enginePerDriveshaftMax[gear]) <= 1.0 / Q16::ONE;
+                }
+                disagreements += nearBound ? 0 : 1;
+            }
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(1000000, samples);
+    TEST_ASSERT_EQUAL_UINT32(0, disagreements);
+}
+
+void test_fixed_point_easing_error_bound(void) {
+    // Every millisecond of the gear needle's transition
+    const uint32_t TRANSITION_MS = 400;
+    double worst = 0.0;
+    for (uint32_t elapsed = 0; elapsed <= TRANSITION_MS; elapsed++) {
+        double eased = Q16::toFloat(Q16::easeInOutCubic(Q16::fromRatio(elapsed, TRANSITION_MS)));
+        worst = fmax(worst, fabs(eased - referenceEase((double)elapsed / TRANSITION_MS)));
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "Q16.16 easing: worst error %.2e of the sweep", worst);
+    TEST_MESSAGE(message);
+
+    // The truncating multiplies cost a handful of Q16 steps: on a 180 degree
+    // servo sweep, hundredths of a degree
+    TEST_ASSERT_LESS_THAN(16.0 / Q16::ONE, worst);
+    TEST_ASSERT_EQUAL_INT32(Q16::ONE, Q16::fromRatio(TRANSITION_MS, TRANSITION_MS));
+    TEST_ASSERT_EQUAL_INT32(Q16::ONE, Q16::fromRatio(TRANSITION_MS + 5, TRANSITION_MS));
+}
+
+void test_per_call_cost_of_each_format(void) {
+    VehicleFactors factors = factorsFor<Mgb4SpeedOverdriveProfile>();
+    const int SAMPLES = 1000000;
+    SampleCost floatCost = measure<floatSample>(factors, SAMPLES);
+    SampleCost fixedCost = measure<fixedSample>(factors, SAMPLES);
+
+    char message[128];
+    snprintf(message, sizeof(message), "speed + gear windows per call (host): float %.1f ns / %.0f cycles, "
+             "Q16.16 %.1f ns / %.0f cycles", floatCost.ns, floatCost.cycles, fixedCost.ns, fixedCost.cycles);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_LESS_THAN(2000.0, floatCost.ns);
+    TEST_ASSERT_LESS_THAN(2000.0, fixedCost.ns);
+}
+
+void test_per_sample_cost(void) {
+    VehicleFactors factors = factorsFor<Mgb4SpeedOverdriveProfile>();
+    TimedGearClassifier classifier(&factors);
+    const int SAMPLES = 1000000;
+
+    // Speed plus gear for a sweep across every window, the work of one RPMHandler::update()
+    volatile float sink = 0.0f;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < SAMPLES; i++) {
+        float shaftRPM = 200.0f + (float)(i % 4000);
+        float engineRPM = shaftRPM * (0.8f + (float)(i % 311) * 0.01f);
+        sink = sink + (USE_FIXED_POINT_MATH ? fixedMph : floatMph)(factors, shaftRPM) + (float)classifier.update(engineRPM, shaftRPM, i);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / SAMPLES;
+
+    char message[96];
+    snprintf(message, sizeof(message), "speed + timed gear (%s): %.1f ns per sample (host)",
+             USE_FIXED_POINT_MATH ? "Q16.16" : "float", ns);
+    TEST_MESSAGE(message);
+
+    // At the 100 Hz loop rate this is noise even at a hundred times the host cost
+    TEST_ASSERT_LESS_THAN(2000.0, ns);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_speed_error_bound);
+    RUN_TEST(test_gear_windows_match_the_exact_ratio);
+    RUN_TEST(test_fixed_point_gear_windows_match_float);
+    RUN_TEST(test_fixed_point_easing_error_bound);
+    RUN_TEST(test_per_call_cost_of_each_format);
+    RUN_TEST(test_per_sample_cost);
+    return UNITY_END();
+}
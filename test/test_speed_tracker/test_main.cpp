@@ -0,0 +1,131 @@
+// Cost per update, and lag/overshoot of the speed tracker on step and ramp traces
+#include <unity.h>
+#include <chrono>
+#include <random>
+#include <math.h>
+#include <stdio.h>
+#include "SpeedTracker.h"
+
+static const float MEASUREMENT_NOISE_RPM = 15.0f;
+
+// Per-pulse measurements of a shaft following rpmAt(t), four pulses per rev
+struct Trace {
+    std::mt19937 random;
+    std::normal_distribution<float> noise;
+    double seconds;
+    float trueRPM;
+
+    explicit Trace(unsigned seed) : random(seed), noise(0.0f, MEASUREMENT_NOISE_RPM), seconds(0.0), trueRPM(0.0f) {}
+
+    template <typename Profile>
+    void next(SpeedTracker& tracker, Profile rpmAt) {
+        trueRPM = rpmAt(seconds);
+        seconds += 60.0 / (trueRPM * 4.0);
+        tracker.update(trueRPM + noise(random), (uint32_t)(seconds * 1e6));
+    }
+};
+
+struct StepProfile {
+    float operator()(double t) const { return t < 2.0 ? 1500.0f : 2000.0f; }
+};
+
+struct RampProfile {
+    float operator()(double t) const { return t < 1.0 ? 1000.0f : 1000.0f + 500.0f * (float)(t - 1.0); }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_step_rise_time_and_overshoot(void) {
+    SpeedTracker tracker;
+    Trace trace(1);
+    StepProfile profile;
+    double riseAt = -1.0;
+    float peak = 0.0f;
+    float settledError = 0.0f;
+    int settledSamples = 0;
+    while (trace.seconds < 5.0) {
+        trace.next(tracker, profile);
+        if (trace.seconds < 2.0) {
+            continue;
+        }
+        float rpm = tracker.getRPM();
+        if (riseAt < 0.0 && rpm >= 1950.0f) {
+            riseAt = trace.seconds - 2.0;
+        }
+        peak = fmaxf(peak, rpm);
+        if (trace.seconds > 3.0) {
+            settledError += (rpm - 2000.0f) * (rpm - 2000.0f);
+            settledSamples++;
+        }
+    }
+    float settledNoise = sqrtf(settledError / settledSamples);
+
+    char message[128];
+    snprintf(message, sizeof(message), "1500->2000 RPM step: 90%% rise %.0f ms, overshoot %.0f RPM, settled noise %.1f RPM",
+             riseAt * 1000.0, peak - 2000.0f, settledNoise);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_GREATER_THAN(0.0, riseAt);
+    TEST_ASSERT_LESS_THAN(0.15, riseAt);
+    TEST_ASSERT_LESS_THAN(150.0f, peak - 2000.0f);
+    TEST_ASSERT_LESS_THAN(MEASUREMENT_NOISE_RPM, settledNoise);
+}
+
+void test_ramp_lag_and_acceleration(void) {
+    SpeedTracker tracker;
+    Trace trace(2);
+    RampProfile profile;
+    float lagSum = 0.0f;
+    float accelSum = 0.0f;
+    int samples = 0;
+    while (trace.seconds < 4.0) {
+        trace.next(tracker, profile);
+        if (trace.seconds > 2.0) {
+            lagSum += trace.trueRPM - tracker.getRPM();
+            accelSum += tracker.getAcceleration();
+            samples++;
+        }
+    }
+    float lag = lagSum / samples;
+    float acceleration = accelSum / samples;
+
+    char message[128];
+    snprintf(message, sizeof(message), "500 RPM/s ramp: mean lag %.1f RPM (%.1f ms), acceleration %.0f RPM/s",
+             lag, lag / 500.0f * 1000.0f, acceleration);
+    TEST_MESSAGE(message);
+
+    // The acceleration state lets it follow a ramp without a standing error
+    TEST_ASSERT_FLOAT_WITHIN(10.0f, 0.0f, lag);
+    TEST_ASSERT_FLOAT_WITHIN(50.0f, 500.0f, acceleration);
+}
+
+void test_cost_per_update(void) {
+    SpeedTracker tracker;
+    static float measurements[100000];
+    std::mt19937 random(3);
+    std::normal_distribution<float> noise(0.0f, MEASUREMENT_NOISE_RPM);
+    for (int i = 0; i < 100000; i++) {
+        measurements[i] = 2000.0f + noise(random);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100000; i++) {
+        tracker.update(measurements[i], (uint32_t)i * 7500u);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 100000.0;
+
+    char message[64];
+    snprintf(message, sizeof(message), "%.1f ns per update (host)", ns);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(MEASUREMENT_NOISE_RPM * 1.5f, 2000.0f, tracker.getRPM());
+    TEST_ASSERT_LESS_THAN(1000.0, ns);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_step_rise_time_and_overshoot);
+    RUN_TEST(test_ramp_lag_and_acceleration);
+    RUN_TEST(test_cost_per_update);
+    return UNITY_END();
+}
@@ -0,0 +1,275 @@
+// Step timing against the motion profile: planner -> StepScheduler ->
+// StepGenerator -> SimulatedStepTimer, updated at a jittery loop rate
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "MotionPlanner.h"
+#include "SimulatedStepTimer.h"
+#include "StepGenerator.h"
+#include "StepScheduler.h"
+
+// Counts steps, drives nothing
+struct CountingDrive {
+    typedef int Phase;
+    static const int MICROSTEPS = 1;
+    static const int PHASE_COUNT = 4;
+    static void buildPhases(const int[4], Phase* phases) {
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            phases[i] = i;
+        }
+    }
+    static void begin(const int[4]) {}
+    static void apply(const Phase&) {}
+};
+
+static const float MAX_VELOCITY = 300.0f;        // Needle limit, steps/s
+static const float MAX_ACCELERATION = 600.0f;    // steps/s^2
+static const uint32_t MIN_INTERVAL_US = 1953;    // Motor's top rate, 512 steps/s
+
+struct PlannerSample {
+    uint32_t micros;
+    float position;
+    float velocity;
+};
+
+// SpeedometerWheel::updateMotion() on the host. Unpaced is the old scheme:
+// the target jumps to the planner position and the timer runs at the top rate.
+struct Rig {
+    StepGenerator<CountingDrive> generator;
+    SimulatedStepTimer timer;
+    MotionPlanner planner;
+    StepScheduler scheduler;
+    bool paced;
+    uint32_t now;
+    uint32_t loops;
+    std::vector<uint32_t> stepMicros;
+    std::vector<int32_t> stepPositions;
+    std::vector<PlannerSample> samples;
+
+    explicit Rig(bool pacedSteps)
+        : generator(0, 1, 2, 3),
+          planner(MAX_VELOCITY, MAX_ACCELERATION),
+          scheduler(MIN_INTERVAL_US),
+          paced(pacedSteps),
+          now(0),
+          loops(0) {
+        timer.begin(onTick, this, MIN_INTERVAL_US);
+        record();
+    }
+
+    static bool onTick(void* context) {
+        Rig* rig = static_cast<Rig*>(context);
+        if (rig->generator.tick()) {
+            rig->stepMicros.push_back(rig->timer.getLastTickMicros());
+            rig->stepPositions.push_back(rig->generator.getPosition());
+        }
+        return false;
+    }
+
+    void record() {
+        PlannerSample sample = { now, planner.getPosition(), planner.getVelocity() };
+        samples.push_back(sample);
+    }
+
+    // One loop pass, 8-13 ms after the last
+    void update() {
+        uint32_t dtMicros = 8000 + (loops++ * 7919) % 5000;
+        now += dtMicros;
+        timer.advanceTo(now);
+
+        float dt = dtMicros / 1000000.0f;
+        planner.update(dt);
+        record();
+        if (paced) {
+            float lead = scheduler.leadPosition(planner.getPosition(), planner.getVelocity(), planner.getTarget(), dt);
+            generator.moveTo((int32_t)lroundf(lead));
+            int32_t pending = generator.getTarget() - generator.getPosition();
+            float stepUnderway = pending > 0 ? timer.getPeriodFraction() : pending < 0 ? -timer.getPeriodFraction() : 0.0f;
+            timer.setInterval(scheduler.interval(planner.getVelocity(), lead - generator.getPosition() - stepUnderway, dt));
+        } else {
+            generator.moveTo((int32_t)lroundf(planner.getPosition()));
+        }
+    }
+
+    // Until the planner settles and the generator has caught up, or give up
+    uint32_t runUntilSettled(uint32_t limitMicros) {
+        uint32_t start = now;
+        while (now - start < limitMicros && !(planner.isSettled() && !generator.isMoving())) {
+            update();
+        }
+        return now - start;
+    }
+
+    uint32_t shortestGap() const {
+        uint32_t gap = UINT32_MAX;
+        for (size_t i = 1; i < stepMicros.size(); i++) {
+            gap = stepMicros[i] - stepMicros[i - 1] < gap ? stepMicros[i] - stepMicros[i - 1] : gap;
+        }
+        return gap;
+    }
+
+    // Worst relative deviation of step gaps from 1/v while the planner cruises
+    float worstCruiseGapError() const {
+        float worst = 0.0f;
+        for (size_t i = 1; i < stepMicros.size(); i++) {
+            if (!cruisingAt(stepMicros[i - 1]) || !cruisingAt(stepMicros[i])) {
+                continue;
+            }
+            float expected = 1000000.0f / MAX_VELOCITY;
+            float error = fabsf((stepMicros[i] - stepMicros[i - 1]) / expected - 1.0f);
+            worst = error > worst ? error : worst;
+        }
+        return worst;
+    }
+
+    // Both planner samples around this time at full speed
+    bool cruisingAt(uint32_t micros) const {
+        for (size_t i = 1; i < samples.size(); i++) {
+            if (samples[i].micros >= micros) {
+                return fabsf(samples[i - 1].velocity) == MAX_VELOCITY && fabsf(samples[i].velocity) == MAX_VELOCITY;
+            }
+        }
+        return false;
+    }
+
+    // Planner position at a time between two updates
+    float plannerPositionAt(uint32_t micros) const {
+        for (size_t i = 1; i < samples.size(); i++) {
+            if (samples[i].micros >= micros) {
+                const PlannerSample& a = samples[i - 1];
+                const PlannerSample& b = samples[i];
+                return a.position + (b.position - a.position) * (micros - a.micros) / (float)(b.micros - a.micros);
+            }
+        }
+        return samples.back().position;
+    }
+
+    // Worst distance between each step and where the profile was when it was taken
+    float worstStepPositionError() const {
+        float worst = 0.0f;
+        for (size_t i = 0; i < stepMicros.size(); i++) {
+            float error = fabsf(stepPositions[i] - plannerPositionAt(stepMicros[i]));
+            worst = error > worst ? error : worst;
+        }
+        return worst;
+    }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_interval_follows_velocity(void) {
+    StepScheduler scheduler(MIN_INTERVAL_US);
+
+    // Backlog equal to the lead (two 10 ms updates at 200 steps/s): exactly 1/v
+    TEST_ASSERT_UINT32_WITHIN(1, 5000, scheduler.interval(200.0f, 4.0f, 0.01f));
+    TEST_ASSERT_UINT32_WITHIN(1, 5000, scheduler.interval(-200.0f, -4.0f, 0.01f));
+
+    // Behind: faster, but never above the motor's rate; ahead: slower
+    TEST_ASSERT_LESS_THAN(5000, scheduler.interval(200.0f, 6.0f, 0.01f));
+    TEST_ASSERT_GREATER_THAN(5000, scheduler.interval(200.0f, 3.0f, 0.01f));
+    TEST_ASSERT_EQUAL_UINT32(MIN_INTERVAL_US, scheduler.interval(200.0f, 100, 0.01f));
+
+    // Stopped with a step left: within the catch-up time; nothing left: slowest tick
+    TEST_ASSERT_LESS_OR_EQUAL(20000, scheduler.interval(0.0f, 1, 0.01f));
+    TEST_ASSERT_EQUAL_UINT32(StepScheduler::MAX_INTERVAL_US, scheduler.interval(0.0f, 0, 0.01f));
+}
+
+void test_lead_stops_at_the_target(void) {
+    StepScheduler scheduler(MIN_INTERVAL_US);
+    TEST_ASSERT_EQUAL_FLOAT(106.0f, scheduler.leadPosition(100.0f, 300.0f, 500.0f, 0.01f));
+    TEST_ASSERT_EQUAL_FLOAT(101.0f, scheduler.leadPosition(100.0f, 300.0f, 101.0f, 0.01f));
+    TEST_ASSERT_EQUAL_FLOAT(94.0f, scheduler.leadPosition(100.0f, -300.0f, 0.0f, 0.01f));
+
+    // Retargeted behind while still moving forward: keep leading forward
+    TEST_ASSERT_EQUAL_FLOAT(106.0f, scheduler.leadPosition(100.0f, 300.0f, 50.0f, 0.01f));
+}
+
+void test_steps_follow_the_profile(void) {
+    Rig paced(true);
+    Rig burst(false);
+    paced.planner.setTarget(2000.0f);
+    burst.planner.setTarget(2000.0f);
+    uint32_t pacedTime = paced.runUntilSettled(20000000);
+    burst.runUntilSettled(20000000);
+
+    char message[128];
+    snprintf(message, sizeof(message),
+             "cruise gap error %.0f%% (burst %.0f%%), step vs profile %.2f steps (burst %.2f steps)",
+             paced.worstCruiseGapError() * 100.0f, burst.worstCruiseGapError() * 100.0f,
+             paced.worstStepPositionError(), burst.worstStepPositionError());
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_INT32(2000, paced.generator.getPosition());
+    TEST_ASSERT_EQUAL_UINT32(2000, paced.stepMicros.size());
+    TEST_ASSERT_GREATER_OR_EQUAL(MIN_INTERVAL_US, paced.shortestGap());
+
+    // Cruise steps are evenly spaced at 1/v; the old scheme alternates top-rate bursts and idle gaps
+    TEST_ASSERT_LESS_THAN(0.15f, paced.worstCruiseGapError());
+    TEST_ASSERT_GREATER_THAN(0.3f, burst.worstCruiseGapError());
+
+    // Each step is taken within a step of where the profile is at that moment;
+    // bursts run a whole update's worth of steps behind it
+    TEST_ASSERT_LESS_THAN(1.0f, paced.worstStepPositionError());
+    TEST_ASSERT_GREATER_THAN(2.0f, burst.worstStepPositionError());
+
+    // Finishes no later than the planner's own move plus the catch-up time
+    float profileMicros = (2000.0f / MAX_VELOCITY + MAX_VELOCITY / MAX_ACCELERATION) * 1000000.0f;
+    TEST_ASSERT_LESS_THAN(profileMicros + 50000.0f, (float)pacedTime);
+}
+
+void test_reversal_never_steps_past_the_planner(void) {
+    Rig paced(true);
+    paced.planner.setTarget(2000.0f);
+    for (int i = 0; i < 300; i++) {
+        paced.update();
+    }
+    paced.planner.setTarget(0.0f);
+
+    float plannerMax = 0.0f;
+    int32_t generatorMax = 0;
+    while (!(paced.planner.isSettled() && !paced.generator.isMoving())) {
+        paced.update();
+        plannerMax = paced.planner.getPosition() > plannerMax ? paced.planner.getPosition() : plannerMax;
+        generatorMax = paced.generator.getPosition() > generatorMax ? paced.generator.getPosition() : generatorMax;
+    }
+
+    TEST_ASSERT_LESS_OR_EQUAL(plannerMax + 1.0f, (float)generatorMax);
+    TEST_ASSERT_EQUAL_INT32(0, paced.generator.getPosition());
+    TEST_ASSERT_GREATER_OR_EQUAL(MIN_INTERVAL_US, paced.shortestGap());
+}
+
+void test_interval_change_applies_to_the_current_period(void) {
+    Rig rig(true);
+    rig.timer.setInterval(20000);
+    rig.generator.moveTo(1000);
+    rig.timer.advanceTo(15000);
+    TEST_ASSERT_EQUAL_UINT32(0, rig.stepMicros.size());
+
+    // The period has already outlasted the new interval: tick straight away,
+    // then run at the new interval
+    rig.timer.setInterval(MIN_INTERVAL_US);
+    rig.timer.advanceTo(15000 + HardwareStepTimer::REARM_MARGIN_US + MIN_INTERVAL_US);
+    TEST_ASSERT_EQUAL_UINT32(2, rig.stepMicros.size());
+    TEST_ASSERT_EQUAL_UINT32(15000 + HardwareStepTimer::REARM_MARGIN_US, rig.stepMicros[0]);
+    TEST_ASSERT_EQUAL_UINT32(MIN_INTERVAL_US, rig.stepMicros[1] - rig.stepMicros[0]);
+
+    // Still inside the new interval: the period just ends sooner
+    rig.timer.setInterval(20000);
+    rig.timer.advanceTo(rig.stepMicros[1] + 1000);
+    rig.timer.setInterval(5000);
+    rig.timer.advanceTo(rig.stepMicros[1] + 5000);
+    TEST_ASSERT_EQUAL_UINT32(3, rig.stepMicros.size());
+    TEST_ASSERT_EQUAL_UINT32(5000, rig.stepMicros[2] - rig.stepMicros[1]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_interval_follows_velocity);
+    RUN_TEST(test_lead_stops_at_the_target);
+    RUN_TEST(test_steps_follow_the_profile);
+    RUN_TEST(test_reversal_never_steps_past_the_planner);
+    RUN_TEST(test_interval_change_applies_to_the_current_period);
+    return UNITY_END();
+}
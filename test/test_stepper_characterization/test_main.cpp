@@ -0,0 +1,361 @@
+// Stepper characterization: the simulated motor on its own, the limit search
+// against a pass/fail oracle, and the whole trial loop of
+// SpeedometerWheel::updateCharacterization() on a simulated motor, with the
+// steps paced by the planner and the marker crossings read off the rotor
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "DialGeometry.h"
+#include "MarkerCrossingDetector.h"
+#include "MotionPlanner.h"
+#include "SimulatedStepTimer.h"
+#include "SimulatedStepperMotor.h"
+#include "StepGenerator.h"
+#include "StepScheduler.h"
+#include "StepperCharacterizer.h"
+
+// Counts steps, drives nothing
+struct CountingDrive {
+    typedef int Phase;
+    static const int MICROSTEPS = 1;
+    static const int PHASE_COUNT = 4;
+    static void buildPhases(const int[4], Phase* phases) {
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            phases[i] = i;
+        }
+    }
+    static void begin(const int[4]) {}
+    static void apply(const Phase&) {}
+};
+
+static const int MARKER_START = 1000;    // Full steps
+static const int MARKER_WIDTH = 40;
+static const int CHARACTERIZATION_SWEEPS = 3;
+
+static CharacterizationRange searchRange() {
+    CharacterizationRange range;
+    range.minimum.stepsPerSecond = STEPPER_CHARACTERIZE_MIN_RATE;
+    range.minimum.stepsPerSecond2 = STEPPER_CHARACTERIZE_MIN_ACCEL;
+    range.maximum.stepsPerSecond = STEPPER_CHARACTERIZE_MAX_RATE;
+    range.maximum.stepsPerSecond2 = STEPPER_CHARACTERIZE_MAX_ACCEL;
+    range.rampSteps = STEPS_PER_REVOLUTION / 4;
+    return range;
+}
+
+// SpeedometerWheel with a motor that has limits of its own
+struct Bench {
+    DialGeometry dial;
+    StepGenerator<CountingDrive> generator;
+    SimulatedStepTimer timer;
+    MarkerCrossingDetector markerWatch;
+    MotionPlanner planner;
+    StepScheduler scheduler;
+    SimulatedStepperMotor motor;
+    StepperCharacterizer characterizer;
+    int currentPosition;
+    int32_t generatorOffset;
+    uint32_t driftCorrections;
+    int trialMove;
+    uint32_t trialCrossings;
+    uint32_t trialDriftCorrections;
+    int32_t trialLostSteps;
+    uint32_t rehomes;
+    uint32_t now;
+    uint32_t loops;
+
+    // What the rotor saw on the last fast sweeps, against what the trial asked for
+    float worstAccelerationShortfall;
+    float worstAccelerationOvershoot;
+
+    Bench(float motorRate, float motorAcceleration)
+        : dial(1),
+          generator(0, 1, 2, 3),
+          markerWatch(dial),
+          planner(1.0f, 1.0f),
+          scheduler(1),
+          motor(motorRate, motorAcceleration),
+          currentPosition(0),
+          generatorOffset(0),
+          driftCorrections(0),
+          trialMove(0),
+          trialCrossings(0),
+          trialDriftCorrections(0),
+          trialLostSteps(0),
+          rehomes(0),
+          now(0),
+          loops(0),
+          worstAccelerationShortfall(1.0f),
+          worstAccelerationOvershoot(1.0f) {
+        timer.begin(onTick, this, 1953);
+    }
+
+    bool endstopAt(int32_t rotor) const { return dial.wrap(rotor - MARKER_START) < MARKER_WIDTH; }
+
+    static bool onTick(void* context) {
+        Bench* bench = static_cast<Bench*>(context);
+        int32_t position = bench->generator.getPosition();
+        bench->markerWatch.sample(position, bench->endstopAt(bench->motor.getRotorPosition()));
+        if (bench->generator.tick()) {
+            bench->motor.step(bench->timer.getLastTickMicros(), bench->generator.getPosition() - position);
+        }
+        return false;
+    }
+
+    // SpeedometerWheel::applyStepperLimits(limits, false)
+    void applyLimits(const StepperLimits& limits) {
+        uint32_t interval = (uint32_t)lroundf(1000000.0f / limits.stepsPerSecond);
+        scheduler.setMinInterval(interval);
+        timer.setInterval(interval);
+        planner.setLimits(1000000.0f / interval, limits.stepsPerSecond2);
+    }
+
+    bool isInTransition() const { return !planner.isSettled() || generator.isMoving(); }
+
+    // SpeedometerWheel::checkDrift()
+    void checkDrift() {
+        MarkerCrossing crossing;
+        int drift;
+        if (!markerWatch.takeCrossing(crossing) ||
+            !markerWatch.measureDrift(crossing, generatorOffset, MARKER_START, MARKER_WIDTH, drift)) {
+            return;
+        }
+        float target = planner.getTarget();
+        planner.shift((float)-drift);
+        planner.setTarget(target);
+        currentPosition = dial.wrap(currentPosition - drift);
+        generatorOffset -= drift;
+        driftCorrections++;
+    }
+
+    // SpeedometerWheel::updateMotion()
+    void updateMotion(float dt) {
+        planner.update(dt);
+        float lead = scheduler.leadPosition(planner.getPosition(), planner.getVelocity(), planner.getTarget(), dt);
+        int leadSteps = dial.wrap((int)lroundf(lead));
+        int steps = dial.shortestPath(currentPosition, leadSteps);
+        if (steps != 0) {
+            generator.moveBy(steps);
+            currentPosition = leadSteps;
+        }
+        int32_t pending = generator.getTarget() - generator.getPosition();
+        float stepUnderway = pending > 0 ? timer.getPeriodFraction() : pending < 0 ? -timer.getPeriodFraction() : 0.0f;
+        float backlog = pending - stepUnderway + (lead - lroundf(lead));
+        timer.setInterval(scheduler.interval(planner.getVelocity(), backlog, dt));
+        if (planner.isSettled()) {
+            planner.shift(dial.wrap((int)lroundf(planner.getPosition())) - planner.getPosition());
+        }
+    }
+
+    // A full marker search, done instantly: the frame moves onto the rotor
+    void rehome() {
+        generatorOffset = motor.getRotorPosition() - motor.getCommandedPosition();
+        currentPosition = dial.wrap(generator.getPosition() + generatorOffset);
+        planner.reset((float)currentPosition);
+        rehomes++;
+    }
+
+    // SpeedometerWheel::startCharacterizationTrial()
+    void startTrial() {
+        StepperLimits trial;
+        if (!characterizer.getTrial(trial)) {
+            return;
+        }
+        int anchor = dial.wrap(MARKER_START + MARKER_WIDTH / 2 + dial.getStepsPerRevolution() / 2);
+        int from = (int)lroundf(planner.getPosition());
+        applyLimits(characterizer.getRange().minimum);
+        planner.setTarget((float)(from + dial.shortestPath(dial.wrap(from), anchor)));
+        trialMove = 0;
+    }
+
+    // SpeedometerWheel::updateCharacterization()
+    void updateCharacterization() {
+        if (isInTransition()) {
+            return;
+        }
+        StepperLimits trial;
+        characterizer.getTrial(trial);
+        if (trialMove == 0) {
+            trialCrossings = markerWatch.getCrossingCount();
+            trialDriftCorrections = driftCorrections;
+            trialLostSteps = motor.getLostSteps();
+            motor.resetPeaks();
+        }
+        if (trialMove == CHARACTERIZATION_SWEEPS) {
+            recordAcceleration(trial);
+        }
+        if (trialMove <= CHARACTERIZATION_SWEEPS) {
+            applyLimits(trialMove < CHARACTERIZATION_SWEEPS ? trial : characterizer.getRange().minimum);
+            planner.setTarget(planner.getPosition() + dial.getStepsPerRevolution());
+            trialMove++;
+            return;
+        }
+
+        uint32_t crossings = markerWatch.getCrossingCount() - trialCrossings;
+        bool crossed = crossings >= (uint32_t)CHARACTERIZATION_SWEEPS + 1;
+        characterizer.report(crossed && driftCorrections == trialDriftCorrections);
+        if (!crossed) {
+            rehome();
+        }
+        startTrial();
+    }
+
+    // Only sweeps the rotor followed throughout say what acceleration reached it
+    void recordAcceleration(const StepperLimits& trial) {
+        if (motor.getLostSteps() != trialLostSteps) {
+            return;
+        }
+        if (motor.getPeakRate() < trial.stepsPerSecond * 0.95f) {
+            return;  // Slipped before reaching the rate
+        }
+        float ratio = motor.getPeakAcceleration() / trial.stepsPerSecond2;
+        worstAccelerationShortfall = ratio < worstAccelerationShortfall ? ratio : worstAccelerationShortfall;
+        worstAccelerationOvershoot = ratio > worstAccelerationOvershoot ? ratio : worstAccelerationOvershoot;
+    }
+
+    void update() {
+        uint32_t dtMicros = 8000 + (loops++ * 7919) % 5000;
+        now += dtMicros;
+        timer.advanceTo(now);
+        checkDrift();
+        updateMotion(dtMicros / 1000000.0f);
+        if (characterizer.isActive()) {
+            updateCharacterization();
+        }
+    }
+
+    // Simulated seconds for the whole search
+    float run() {
+        characterizer.start(searchRange());
+        startTrial();
+        while (characterizer.isActive() && now < 3600000000UL) {
+            update();
+        }
+        return now / 1e6f;
+    }
+};
+
+// Steps at a constant gap, from rest
+static void runSteps(SimulatedStepperMotor& motor, uint32_t& micros, int steps, uint32_t gap) {
+    for (int i = 0; i < steps; i++) {
+        motor.step(micros, 1);
+        micros += gap;
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_motor_follows_within_its_limits(void) {
+    SimulatedStepperMotor motor(1000.0f, 4000.0f);
+    uint32_t micros = 0;
+
+    // A ramp at half the acceleration limit up to 900 steps/s, then cruise
+    float rate = 100.0f;
+    while (rate < 900.0f) {
+        motor.step(micros, 1);
+        micros += (uint32_t)lroundf(1000000.0f / rate);
+        rate += 2000.0f / rate;
+    }
+    runSteps(motor, micros, 500, 1111);
+    TEST_ASSERT_EQUAL_UINT32(0, motor.getSlips());
+    TEST_ASSERT_EQUAL_INT32(0, motor.getLostSteps());
+    TEST_ASSERT_FLOAT_WITHIN(100.0f, 2000.0f, motor.getPeakAcceleration());
+}
+
+void test_motor_slips_above_its_rate_and_on_a_burst_from_rest(void) {
+    // Too fast, however gently it got there: whole electrical cycles lost
+    SimulatedStepperMotor fast(500.0f, 100000.0f);
+    uint32_t micros = 0;
+    runSteps(fast, micros, 200, 1700);
+    runSteps(fast, micros, 10, 2500);   // Back in step: a whole cycle behind, or several
+    TEST_ASSERT_GREATER_THAN(0, (int)fast.getSlips());
+    TEST_ASSERT_EQUAL_INT32(0, fast.getLostSteps() % 4);
+    TEST_ASSERT_GREATER_THAN(0, fast.getLostSteps());
+
+    // Below the rate, but all at once from standstill: the old burst stepping
+    SimulatedStepperMotor burst(1000.0f, 4000.0f);
+    micros = 0;
+    runSteps(burst, micros, 200, 1953);
+    TEST_ASSERT_GREATER_THAN(0, (int)burst.getSlips());
+    TEST_ASSERT_EQUAL_INT32(0, burst.getLostSteps() % 4);
+
+    // Starting straight off at the start rate is fine
+    SimulatedStepperMotor slow(1000.0f, 4000.0f, 100.0f);
+    micros = 0;
+    runSteps(slow, micros, 200, 10000);
+    TEST_ASSERT_EQUAL_UINT32(0, slow.getSlips());
+}
+
+void test_search_brackets_the_limits(void) {
+    // Pass/fail straight from the limits: where the search ends and how long it takes
+    const float MOTORS[][2] = {{400.0f, 1500.0f}, {900.0f, 4000.0f}, {1300.0f, 9000.0f}, {3000.0f, 50000.0f}};
+    CharacterizationRange range = searchRange();
+    for (int i = 0; i < 4; i++) {
+        StepperCharacterizer characterizer;
+        characterizer.start(range);
+        StepperLimits trial;
+        while (characterizer.getTrial(trial)) {
+            characterizer.report(trial.stepsPerSecond <= MOTORS[i][0] && trial.stepsPerSecond2 <= MOTORS[i][1]);
+        }
+        TEST_ASSERT_EQUAL_INT(CHARACTERIZE_COMPLETE, characterizer.getStatus());
+        StepperLimits best = characterizer.getBest();
+        float rateLimit = fminf(MOTORS[i][0], range.maximum.stepsPerSecond);
+        float accelerationLimit = fminf(MOTORS[i][1], range.maximum.stepsPerSecond2);
+        TEST_ASSERT_TRUE(best.stepsPerSecond <= rateLimit && best.stepsPerSecond * StepperCharacterizer::RESOLUTION >= rateLimit);
+        TEST_ASSERT_TRUE(best.stepsPerSecond2 <= accelerationLimit &&
+                         best.stepsPerSecond2 * StepperCharacterizer::RESOLUTION >= accelerationLimit);
+        TEST_ASSERT_EQUAL_FLOAT(best.stepsPerSecond * StepperCharacterizer::SAFETY_MARGIN,
+                                characterizer.getRecommended().stepsPerSecond);
+        TEST_ASSERT_LESS_OR_EQUAL(24, characterizer.getTrialCount());
+    }
+
+    // A motor that can't manage the minimum fails the run
+    StepperCharacterizer weak;
+    weak.start(range);
+    StepperLimits trial;
+    while (weak.getTrial(trial)) {
+        weak.report(trial.stepsPerSecond <= 200.0f);
+    }
+    TEST_ASSERT_EQUAL_INT(CHARACTERIZE_FAILED, weak.getStatus());
+}
+
+void test_search_on_a_simulated_motor(void) {
+    // Rate-limited at a modest ramp, then acceleration-limited at the derated rate
+    const float MOTORS[][2] = {{600.0f, 2500.0f}, {900.0f, 4000.0f}, {1300.0f, 9000.0f}};
+    for (int i = 0; i < 3; i++) {
+        Bench bench(MOTORS[i][0], MOTORS[i][1]);
+        float seconds = bench.run();
+        StepperLimits best = bench.characterizer.getBest();
+
+        char message[192];
+        snprintf(message, sizeof(message),
+                 "motor %.0f steps/s, %.0f steps/s^2: found %.0f, %.0f in %d trials (%.0f s, %u re-homes), "
+                 "rotor saw %.2f-%.2f of the trial acceleration",
+                 MOTORS[i][0], MOTORS[i][1], best.stepsPerSecond, best.stepsPerSecond2, bench.characterizer.getTrialCount(),
+                 seconds, (unsigned)bench.rehomes, bench.worstAccelerationShortfall, bench.worstAccelerationOvershoot);
+        TEST_MESSAGE(message);
+
+        TEST_ASSERT_EQUAL_INT(CHARACTERIZE_COMPLETE, bench.characterizer.getStatus());
+
+        // Never above what the motor can do. The rate comes within a few
+        // percent of it; the acceleration within what the scheduler adds
+        // working off the start-up lag, so the search errs on the safe side
+        TEST_ASSERT_LESS_OR_EQUAL(MOTORS[i][0], best.stepsPerSecond);
+        TEST_ASSERT_GREATER_OR_EQUAL(MOTORS[i][0] / (StepperCharacterizer::RESOLUTION * 1.05f), best.stepsPerSecond);
+        TEST_ASSERT_LESS_OR_EQUAL(MOTORS[i][1], best.stepsPerSecond2);
+        TEST_ASSERT_GREATER_OR_EQUAL(MOTORS[i][1] / (StepperCharacterizer::RESOLUTION * 1.35f), best.stepsPerSecond2);
+
+        // The trial acceleration is what reaches the rotor, not a step from standstill
+        TEST_ASSERT_GREATER_THAN(0.8f, bench.worstAccelerationShortfall);
+        TEST_ASSERT_LESS_THAN(1.35f, bench.worstAccelerationOvershoot);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_motor_follows_within_its_limits);
+    RUN_TEST(test_motor_slips_above_its_rate_and_on_a_burst_from_rest);
+    RUN_TEST(test_search_brackets_the_limits);
+    RUN_TEST(test_search_on_a_simulated_motor);
+    return UNITY_END();
+}
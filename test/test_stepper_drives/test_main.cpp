@@ -0,0 +1,134 @@
+// Phase tables of the full, half and micro-step drives, and the dial's wrap
+// and MPH math in every drive mode
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "DialGeometry.h"
+#include "StepperDrives.h"
+
+// Coils on GPIO 0-3, so a coil pattern is the low set mask itself
+static const int PINS[4] = {0, 1, 2, 3};
+
+static uint8_t pattern(const CoilPhase& phase) {
+    return (uint8_t)phase.setLow;
+}
+
+// Coils a micro-step phase drives at all
+static uint8_t pattern(const PwmPhase& phase) {
+    uint8_t coils = 0;
+    for (int i = 0; i < 4; i++) {
+        coils |= phase.duty[i] > 0 ? 1 << i : 0;
+    }
+    return coils;
+}
+
+template <typename Drive>
+static void checkWrapMath() {
+    DialGeometry dial(Drive::MICROSTEPS);
+    int revolution = dial.getStepsPerRevolution();
+    TEST_ASSERT_EQUAL_INT(STEPS_PER_REVOLUTION * Drive::MICROSTEPS, revolution);
+
+    // Positions across several turns either way
+    srand(Drive::MICROSTEPS);
+    for (int i = 0; i < 20000; i++) {
+        int from = rand() % (8 * revolution) - 4 * revolution;
+        int to = rand() % (8 * revolution) - 4 * revolution;
+        int wrapped = dial.wrap(from);
+        TEST_ASSERT_TRUE(wrapped >= 0 && wrapped < revolution);
+        TEST_ASSERT_EQUAL_INT(0, (from - wrapped) % revolution);
+
+        int path = dial.shortestPath(from, to);
+        TEST_ASSERT_TRUE(path > -revolution / 2 && path <= revolution / 2);
+        TEST_ASSERT_EQUAL_INT(dial.wrap(to), dial.wrap(from + path));
+    }
+
+    // The scale rises through every step short of a full turn, and reads back
+    // within half a step
+    int homeCenter = revolution / 3;
+    float halfStepMph = 0.5f / dial.getStepsPerMph();
+    int first = dial.stepsFromHome(MIN_SPEED_MPH);
+    int previous = first;
+    float worst = 0.0f;
+    for (float mph = MIN_SPEED_MPH; mph <= MAX_SPEED_MPH; mph += halfStepMph * 0.5f) {
+        int steps = dial.stepsFromHome(mph);
+        TEST_ASSERT_TRUE(steps == previous || steps == previous + 1);
+        previous = steps;
+        if (steps == first + revolution - 1) {
+            continue;  // Held one step short of a full turn, so it cannot alias 0 MPH
+        }
+
+        float error = fabsf(dial.mphAtPosition(dial.wrap(homeCenter + steps), homeCenter) - mph);
+        worst = error > worst ? error : worst;
+    }
+    TEST_ASSERT_EQUAL_INT(dial.getZeroOffsetSteps(), first);
+    TEST_ASSERT_EQUAL_INT(first + revolution - 1, dial.stepsFromHome(MAX_SPEED_MPH));
+    TEST_ASSERT_LESS_OR_EQUAL(halfStepMph * 1.01f, worst);
+
+    char message[96];
+    snprintf(message, sizeof(message), "%s: %d steps/rev, worst MPH round trip %.4f (half step %.4f)",
+             Drive::name(), revolution, worst, halfStepMph);
+    TEST_MESSAGE(message);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_half_step_contains_the_full_step_table(void) {
+    FullStepDrive::Phase full[FullStepDrive::PHASE_COUNT];
+    HalfStepDrive::Phase half[HalfStepDrive::PHASE_COUNT];
+    FullStepDrive::buildPhases(PINS, full);
+    HalfStepDrive::buildPhases(PINS, half);
+
+    for (int i = 0; i < FullStepDrive::PHASE_COUNT; i++) {
+        TEST_ASSERT_EQUAL_HEX8(pattern(full[i]), pattern(half[2 * i + 1]));
+    }
+    for (int i = 0; i < HalfStepDrive::PHASE_COUNT; i++) {
+        // Every coil is either set or cleared, and neighbours differ by one coil
+        TEST_ASSERT_EQUAL_HEX32(0xF, half[i].setLow | half[i].clearLow);
+        uint8_t change = pattern(half[i]) ^ pattern(half[(i + 1) % HalfStepDrive::PHASE_COUNT]);
+        TEST_ASSERT_TRUE(change == 1 || change == 2 || change == 4 || change == 8);
+    }
+}
+
+void test_micro_step_table_follows_the_electrical_angle(void) {
+    typedef MicroStepDrive<8> Drive;
+    Drive::Phase micro[Drive::PHASE_COUNT];
+    FullStepDrive::Phase full[FullStepDrive::PHASE_COUNT];
+    Drive::buildPhases(PINS, micro);
+    FullStepDrive::buildPhases(PINS, full);
+    const float maxDuty = (float)((1 << Drive::PWM_BITS) - 1);
+
+    for (int i = 0; i < Drive::PHASE_COUNT; i++) {
+        // One half of each winding at a time, at constant total current
+        TEST_ASSERT_TRUE(micro[i].duty[0] == 0 || micro[i].duty[2] == 0);
+        TEST_ASSERT_TRUE(micro[i].duty[1] == 0 || micro[i].duty[3] == 0);
+        float a = (micro[i].duty[0] + micro[i].duty[2]) / maxDuty;
+        float b = (micro[i].duty[1] + micro[i].duty[3]) / maxDuty;
+        TEST_ASSERT_FLOAT_WITHIN(0.003f, 1.0f, sqrtf(a * a + b * b));
+        TEST_ASSERT_TRUE(micro[i].duty[0] <= maxDuty && micro[i].duty[1] <= maxDuty);
+    }
+
+    // Every Microsteps-th phase lands on the full-step detent, equal current in both coils
+    for (int i = 0; i < FullStepDrive::PHASE_COUNT; i++) {
+        const PwmPhase& detent = micro[i * Drive::MICROSTEPS];
+        TEST_ASSERT_EQUAL_HEX8(pattern(full[i]), pattern(detent));
+        uint16_t on = detent.duty[0] + detent.duty[2];
+        TEST_ASSERT_EQUAL_UINT16(on, detent.duty[1] + detent.duty[3]);
+    }
+}
+
+void test_wrap_math_in_every_mode(void) {
+    checkWrapMath<FullStepDrive>();
+    checkWrapMath<HalfStepDrive>();
+    checkWrapMath<MicroStepDrive<8> >();
+    checkWrapMath<MicroStepDrive<16> >();
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_half_step_contains_the_full_step_table);
+    RUN_TEST(test_micro_step_table_follows_the_electrical_angle);
+    RUN_TEST(test_wrap_math_in_every_mode);
+    return UNITY_END();
+}
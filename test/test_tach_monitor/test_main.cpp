@@ -0,0 +1,120 @@
+// Ignition tach input on synthetic 4-cylinder traces with coil ringing after
+// every spark: TachPulseConfig's lockout, applied where edges are queued,
+// keeps the ringing out of the pulse count and the RPM
+#include <unity.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include "TachMonitor.h"
+
+// The tach config on the simulated backend, lockout and all
+struct HostTachConfig : TachPulseConfig {
+    static const PulseBackendType BACKEND = PULSE_BACKEND_SIMULATED;
+};
+
+// The same without the lockout, to show what it keeps out
+struct UnfilteredTachConfig : TachPulseConfig {
+    static const PulseBackendType BACKEND = PULSE_BACKEND_SIMULATED;
+    static const uint32_t MIN_EDGE_SPACING_US = 0;
+};
+
+typedef PulseMonitor<TACH_SENSOR_PIN, HostTachConfig> HostTach;
+typedef PulseMonitor<TACH_SENSOR_PIN, UnfilteredTachConfig> UnfilteredTach;
+
+static const uint32_t LOOP_PERIOD_US = 10000;
+static const uint32_t RINGING_US = 1500;   // The primary rings on for up to this long after a spark
+
+struct TraceResult {
+    unsigned long sparks;
+    unsigned long ringingEdges;
+    unsigned long counted;      // Pulses the monitor took
+    float rpm;
+    float worstError;           // Relative, over the last second
+};
+
+// Sparks at TACH_CYLINDERS / 2 per crank revolution, each followed by a
+// ring of 3-8 further falling edges within RINGING_US. Runs the loop
+// for the given time at a steady speed.
+template <typename Monitor>
+static TraceResult runTrace(Monitor& monitor, float rpm, uint32_t durationMicros, unsigned seed) {
+    typedef typename Monitor::Backend Backend;
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> ringCount(3, 8);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    TraceResult result = { 0, 0, 0, 0.0f, 0.0f };
+
+    Backend::setTime(0);
+    monitor.reset();
+    double sparkPeriod = 60000000.0 / rpm / TachPulseConfig::PULSES_PER_REV;
+    double nextSpark = 5000.0;
+    for (uint32_t now = LOOP_PERIOD_US; now <= durationMicros; now += LOOP_PERIOD_US) {
+        while (nextSpark <= (double)now) {
+            Backend::injectPulse((uint32_t)nextSpark);
+            result.sparks++;
+
+            double ring = nextSpark;
+            int rings = ringCount(random);
+            for (int i = 0; i < rings; i++) {
+                ring += (double)RINGING_US / rings * (0.2 + 0.8 * unit(random));
+                Backend::injectPulse((uint32_t)ring);
+                result.ringingEdges++;
+            }
+            nextSpark += sparkPeriod * (1.0 + 0.004 * (unit(random) - 0.5));
+        }
+        Backend::setTime(now);
+        monitor.update();
+        if (now + 1000000 > durationMicros) {
+            result.worstError = fmaxf(result.worstError, fabsf(monitor.getRPM() / rpm - 1.0f));
+        }
+    }
+    result.counted = monitor.getPulseCount();
+    result.rpm = monitor.getRPM();
+    return result;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_lockout_outlasts_the_ringing_but_not_a_redline_spark(void) {
+    // Half a spark period at TACH_MAX_RPM: longer than the ringing, with 2x headroom
+    double redlineSparkPeriod = 60000000.0 / TACH_MAX_RPM / TachPulseConfig::PULSES_PER_REV;
+    TEST_ASSERT_GREATER_THAN(RINGING_US, TachPulseConfig::MIN_EDGE_SPACING_US);
+    TEST_ASSERT_LESS_OR_EQUAL((uint32_t)(redlineSparkPeriod / 2.0), TachPulseConfig::MIN_EDGE_SPACING_US);
+}
+
+void test_ringing_is_locked_out_across_the_rev_range(void) {
+    const float SPEEDS[] = {650.0f, 1500.0f, 3200.0f, 5000.0f, (float)TACH_MAX_RPM};
+    for (int i = 0; i < 5; i++) {
+        HostTach tach;
+        TraceResult result = runTrace(tach, SPEEDS[i], 4000000, 10 + i);
+
+        char message[128];
+        snprintf(message, sizeof(message), "%.0f RPM: %lu sparks, %lu ringing edges, %lu counted, %.1f RPM (worst %.2f%%)",
+                 SPEEDS[i], result.sparks, result.ringingEdges, result.counted, result.rpm, 100.0f * result.worstError);
+        TEST_MESSAGE(message);
+
+        TEST_ASSERT_EQUAL_UINT32(result.sparks, result.counted);
+        TEST_ASSERT_LESS_THAN(0.01f, result.worstError);
+        TEST_ASSERT_EQUAL_UINT32(0, tach.getOverflowCount());
+    }
+}
+
+void test_without_the_lockout_the_ringing_gets_through(void) {
+    UnfilteredTach tach;
+    TraceResult result = runTrace(tach, 3200.0f, 4000000, 20);
+
+    char message[128];
+    snprintf(message, sizeof(message), "no lockout at 3200 RPM: %lu sparks, %lu counted, %.1f RPM", result.sparks,
+             result.counted, result.rpm);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_GREATER_THAN(result.sparks + result.sparks / 10, result.counted);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_lockout_outlasts_the_ringing_but_not_a_redline_spark);
+    RUN_TEST(test_ringing_is_locked_out_across_the_rev_range);
+    RUN_TEST(test_without_the_lockout_the_ringing_gets_through);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+// Tooth spacing learning on a target wheel with known irregular spacing:
+// convergence of the learned factors, flattened per-tooth periods, missed
+// edges and a speed ramp
+#include <unity.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include "ToothCorrection.h"
+
+// Share of a revolution each tooth's gap spans, as machined
+static const int TEETH = 4;
+static const float SPACING[TEETH] = {0.22f, 0.28f, 0.24f, 0.26f};
+
+// Raw gap ending at this tooth for a shaft turning at rpm, with relative jitter
+static uint32_t toothPeriod(int tooth, float rpm, float jitter) {
+    return (uint32_t)(60000000.0f / rpm * SPACING[tooth] * (1.0f + jitter));
+}
+
+// Largest relative spread of a set of per-tooth periods around their mean
+static float ripple(const float periods[], int count) {
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum += periods[i];
+    }
+    float mean = sum / count;
+    float worst = 0.0f;
+    for (int i = 0; i < count; i++) {
+        worst = fmaxf(worst, fabsf(periods[i] / mean - 1.0f));
+    }
+    return worst;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_learned_factors_converge_to_the_spacing(void) {
+    ToothCorrection correction;
+    correction.setToothCount(TEETH);
+    std::mt19937 random(1);
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+
+    int revolutions = 0;
+    while (!correction.isLearned()) {
+        for (int tooth = 0; tooth < TEETH; tooth++) {
+            correction.correct(toothPeriod(tooth, 1500.0f, noise(random)));
+        }
+        revolutions++;
+    }
+    for (int i = 0; i < 200; i++) {
+        for (int tooth = 0; tooth < TEETH; tooth++) {
+            correction.correct(toothPeriod(tooth, 1500.0f, noise(random)));
+        }
+    }
+
+    float sum = 0.0f;
+    float worst = 0.0f;
+    for (int tooth = 0; tooth < TEETH; tooth++) {
+        float expected = SPACING[tooth] * TEETH;
+        worst = fmaxf(worst, fabsf(correction.getCorrection(tooth) - expected));
+        sum += correction.getCorrection(tooth);
+    }
+    char message[128];
+    snprintf(message, sizeof(message), "learned after %d revolutions, worst factor error %.4f", revolutions, worst);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_LESS_OR_EQUAL(25, revolutions);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.0f, worst);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, (float)TEETH, sum);   // Average speed unchanged
+}
+
+void test_corrected_periods_flatten(void) {
+    ToothCorrection correction;
+    correction.setToothCount(TEETH);
+    std::mt19937 random(2);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+
+    float raw[TEETH];
+    float corrected[TEETH];
+    float worstRaw = 0.0f;
+    float worstCorrected = 0.0f;
+    for (int revolution = 0; revolution < 300; revolution++) {
+        for (int tooth = 0; tooth < TEETH; tooth++) {
+            uint32_t period = toothPeriod(tooth, 2200.0f, noise(random));
+            raw[tooth] = (float)period;
+            corrected[tooth] = correction.correct(period);
+        }
+        if (revolution >= 100) {
+            worstRaw = fmaxf(worstRaw, ripple(raw, TEETH));
+            worstCorrected = fmaxf(worstCorrected, ripple(corrected, TEETH));
+        }
+    }
+    char message[128];
+    snprintf(message, sizeof(message), "per-tooth ripple %.2f%% raw, %.2f%% corrected", 100.0f * worstRaw,
+             100.0f * worstCorrected);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_GREATER_THAN(0.1f, worstRaw);
+    TEST_ASSERT_LESS_THAN(0.01f, worstCorrected);
+}
+
+void test_missed_edges_keep_the_tooth_phase(void) {
+    ToothCorrection correction;
+    correction.setToothCount(TEETH);
+    for (int revolution = 0; revolution < 100; revolution++) {
+        for (int tooth = 0; tooth < TEETH; tooth++) {
+            correction.correct(toothPeriod(tooth, 1800.0f, 0.0f));
+        }
+    }
+
+    // Every fifth revolution the edge at tooth 1 is missed: its gap and the
+    // next arrive as one, which the caller can't use, so both teeth are skipped
+    for (int revolution = 0; revolution < 100; revolution++) {
+        for (int tooth = 0; tooth < TEETH; tooth++) {
+            if (revolution % 5 == 0 && tooth == 1) {
+                correction.skip(2);
+                tooth++;
+                continue;
+            }
+            float corrected = correction.correct(toothPeriod(tooth, 1800.0f, 0.0f));
+            TEST_ASSERT_FLOAT_WITHIN(0.005f * 60000000.0f / 1800.0f / TEETH, 60000000.0f / 1800.0f / TEETH, corrected);
+        }
+    }
+    for (int tooth = 0; tooth < TEETH; tooth++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.002f, SPACING[tooth] * TEETH, correction.getCorrection(tooth));
+    }
+}
+
+void test_a_speed_ramp_barely_biases_the_factors(void) {
+    // 1000 -> 4000 RPM over about 20 s: each revolution's later teeth come a
+    // little early, which must not be learned as spacing
+    ToothCorrection correction;
+    correction.setToothCount(TEETH);
+    float rpm = 1000.0f;
+    while (rpm < 4000.0f) {
+        for (int tooth = 0; tooth < TEETH; tooth++) {
+            uint32_t period = toothPeriod(tooth, rpm, 0.0f);
+            correction.correct(period);
+            rpm += 150.0f * period / 1000000.0f;
+        }
+    }
+    for (int tooth = 0; tooth < TEETH; tooth++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, SPACING[tooth] * TEETH, correction.getCorrection(tooth));
+    }
+}
+
+void test_single_tooth_passes_through(void) {
+    ToothCorrection correction;
+    TEST_ASSERT_EQUAL_INT(1, correction.getToothCount());
+    TEST_ASSERT_EQUAL_FLOAT(12345.0f, correction.correct(12345));
+
+    // Changing the wheel starts learning over
+    correction.setToothCount(TEETH);
+    for (int i = 0; i < 50 * TEETH; i++) {
+        correction.correct(toothPeriod(i % TEETH, 1500.0f, 0.0f));
+    }
+    TEST_ASSERT_TRUE(correction.isLearned());
+    correction.setToothCount(TEETH + 2);
+    TEST_ASSERT_FALSE(correction.isLearned());
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, correction.getCorrection(0));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_learned_factors_converge_to_the_spacing);
+    RUN_TEST(test_corrected_periods_flatten);
+    RUN_TEST(test_missed_edges_keep_the_tooth_phase);
+    RUN_TEST(test_a_speed_ramp_barely_biases_the_factors);
+    RUN_TEST(test_single_tooth_passes_through);
+    return UNITY_END();
+}
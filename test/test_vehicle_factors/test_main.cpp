@@ -0,0 +1,64 @@
+// Factors derived from each shipped vehicle profile against the float formulas
+#include <unity.h>
+#include <math.h>
+#include "VehicleParameters.h"
+
+template <typename Profile>
+static void checkProfile() {
+    VehicleParameters parameters = defaultVehicleParameters<Profile>();
+    parameters.crc = computeParameterCrc(parameters);
+    TEST_ASSERT_TRUE(isValidVehicleParameters(parameters));
+
+    VehicleFactors factors;
+    deriveVehicleFactors(parameters, factors);
+
+    // Road speed straight from the wheel: shaft RPM through the differential, times circumference
+    for (float shaftRPM = 100.0f; shaftRPM <= 5000.0f; shaftRPM += 100.0f) {
+        float wheelRPM = shaftRPM / Profile::DIFFERENTIAL_RATIO;
+        float mph = wheelRPM * 3.14159265f * Profile::TIRE_DIAMETER_INCHES * 60.0f / 63360.0f;
+        TEST_ASSERT_FLOAT_WITHIN(mph * 1e-5f, mph, shaftRPM * factors.mphPerDriveshaftRPM);
+    }
+
+    // Every fitted gear's window holds its own ratio and no neighbour's
+    for (int gear = GEAR_1; gear < GEAR_COUNT; gear++) {
+        float ratio = Profile::TRANSMISSION_RATIOS[gear];
+        if (ratio <= 0.0f) {
+            TEST_ASSERT_EQUAL_FLOAT(0.0f, factors.enginePerDriveshaftMax[gear]);
+            continue;
+        }
+        TEST_ASSERT_EQUAL_FLOAT(ratio, factors.enginePerDriveshaft[gear]);
+        TEST_ASSERT_LESS_THAN(ratio, factors.enginePerDriveshaftMin[gear]);
+        TEST_ASSERT_GREATER_THAN(ratio, factors.enginePerDriveshaftMax[gear]);
+        if (gear + 1 < GEAR_COUNT && Profile::TRANSMISSION_RATIOS[gear + 1] > 0.0f) {
+            TEST_ASSERT_LESS_OR_EQUAL(factors.enginePerDriveshaftMin[gear], factors.enginePerDriveshaftMax[gear + 1]);
+        }
+        TEST_ASSERT_INT32_WITHIN(1, factors.enginePerDriveshaftMin[gear] * 65536.0f, factors.enginePerDriveshaftMinFixed[gear]);
+        TEST_ASSERT_INT32_WITHIN(1, factors.enginePerDriveshaftMax[gear] * 65536.0f, factors.enginePerDriveshaftMaxFixed[gear]);
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_mgb_3_speed_factors(void) {
+    checkProfile<Mgb3SpeedProfile>();
+}
+
+void test_mgb_4_speed_overdrive_factors(void) {
+    checkProfile<Mgb4SpeedOverdriveProfile>();
+}
+
+void test_corrupt_block_is_rejected(void) {
+    VehicleParameters parameters = defaultVehicleParameters<Mgb3SpeedProfile>();
+    parameters.crc = computeParameterCrc(parameters);
+    parameters.tireDiameterInches += 1.0f;
+    TEST_ASSERT_FALSE(isValidVehicleParameters(parameters));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_mgb_3_speed_factors);
+    RUN_TEST(test_mgb_4_speed_overdrive_factors);
+    RUN_TEST(test_corrupt_block_is_rejected);
+    return UNITY_END();
+}